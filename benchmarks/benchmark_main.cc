@@ -0,0 +1,37 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "sirius/utils/log.h"
+
+int main(int argc, char** argv) {
+    // logs would be part of the measures
+    LOG_SET_LEVEL(off);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "sirius/fftw/wrapper.h"
+
+#include "utils.h"
+
+namespace {
+
+template <typename T>
+void BM_FFT(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    auto image = sirius::benchmarks::CreateRandomImage<T>(size);
+
+    for (auto _ : state) {
+        auto image_fft = sirius::fftw::FFT(image);
+        benchmark::DoNotOptimize(image_fft.get());
+    }
+    sirius::benchmarks::SetPixelRate(state, size.CellCount());
+}
+
+template <typename T>
+void BM_IFFT(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    auto image = sirius::benchmarks::CreateRandomImage<T>(size);
+    auto image_fft = sirius::fftw::FFT(image);
+
+    for (auto _ : state) {
+        // IFFT consumes the spectrum
+        state.PauseTiming();
+        auto fft = sirius::benchmarks::CopyFFT<T>(size, image_fft);
+        state.ResumeTiming();
+
+        auto output = sirius::fftw::IFFT(size, std::move(fft));
+        benchmark::DoNotOptimize(output.data.data());
+    }
+    sirius::benchmarks::SetPixelRate(state, size.CellCount());
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_FFT, double)->RangeMultiplier(2)->Range(256, 2048);
+BENCHMARK_TEMPLATE(BM_FFT, float)->RangeMultiplier(2)->Range(256, 2048);
+BENCHMARK_TEMPLATE(BM_IFFT, double)->RangeMultiplier(2)->Range(256, 2048);
+BENCHMARK_TEMPLATE(BM_IFFT, float)->RangeMultiplier(2)->Range(256, 2048);
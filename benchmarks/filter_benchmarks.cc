@@ -0,0 +1,130 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <exception>
+
+#include <benchmark/benchmark.h>
+
+#include "sirius/filter.h"
+#include "sirius/frequency_zoom_factory.h"
+
+#include "sirius/fftw/wrapper.h"
+
+#include "utils.h"
+
+namespace {
+
+constexpr int kFilterSize = 21;
+
+// the gaussian benchmark filter is separable: bool parameter selects the
+// separable spectrum or the full 2D spectrum
+template <typename T, bool IsSeparable>
+void BM_FilterProcess(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    sirius::Filter filter;
+    try {
+        filter = sirius::Filter::Create(
+              sirius::benchmarks::CreateFilterFile({kFilterSize, kFilterSize}),
+              {1, 1}, sirius::PaddingType::kMirrorPadding, false,
+              IsSeparable ? sirius::Filter::kSeparableTolerance : -1);
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+        return;
+    }
+    auto image = sirius::benchmarks::CreateRandomImage<T>(size);
+    auto image_fft = sirius::fftw::FFT(image);
+
+    // first call computes the filter FFT (cached afterwards)
+    image_fft = filter.Process(size, std::move(image_fft));
+
+    for (auto _ : state) {
+        // Process consumes the spectrum
+        state.PauseTiming();
+        auto fft = sirius::benchmarks::CopyFFT<T>(size, image_fft);
+        state.ResumeTiming();
+
+        fft = filter.Process(size, std::move(fft));
+        benchmark::DoNotOptimize(fft.get());
+    }
+    sirius::benchmarks::SetPixelRate(state, size.CellCount());
+}
+
+// zoom x2 of a padded block with the filter applied by the given engine:
+// the direct engine also lets the zero padding zoom use its pruned IFFT
+template <typename T, sirius::FilterEngine engine>
+void BM_FilterEngineZoom(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    int filter_size = state.range(1);
+    sirius::ZoomRatio zoom_ratio(2, 1);
+    sirius::Filter filter;
+    try {
+        filter = sirius::Filter::Create(
+              sirius::benchmarks::CreateFilterFile({filter_size, filter_size}),
+              zoom_ratio, sirius::PaddingType::kMirrorPadding, false,
+              sirius::Filter::kSeparableTolerance, engine);
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+        return;
+    }
+    auto image = sirius::benchmarks::CreateRandomImage<T>(size);
+    auto frequency_zoom = sirius::FrequencyZoomFactory::Create(
+          sirius::ImageDecompositionPolicies::kRegular,
+          sirius::FrequencyZoomStrategies::kZeroPadding);
+
+    for (auto _ : state) {
+        auto zoomed_image = frequency_zoom->Compute(zoom_ratio, image,
+                                                    filter.padding(), filter);
+        benchmark::DoNotOptimize(zoomed_image.data.data());
+    }
+    sirius::benchmarks::SetPixelRate(state, (size * 2).CellCount());
+}
+
+void FilterEngineArguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"size", "filter"})
+          ->ArgsProduct({{128, 256, 512}, {5, 7, 11, 21}});
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_FilterProcess, double, false)
+      ->RangeMultiplier(2)
+      ->Range(256, 2048);
+BENCHMARK_TEMPLATE(BM_FilterProcess, float, false)
+      ->RangeMultiplier(2)
+      ->Range(256, 2048);
+BENCHMARK_TEMPLATE(BM_FilterProcess, double, true)
+      ->RangeMultiplier(2)
+      ->Range(256, 2048);
+BENCHMARK_TEMPLATE(BM_FilterProcess, float, true)
+      ->RangeMultiplier(2)
+      ->Range(256, 2048);
+
+BENCHMARK_TEMPLATE(BM_FilterEngineZoom, double,
+                   sirius::FilterEngine::kSpectral)
+      ->Apply(FilterEngineArguments);
+BENCHMARK_TEMPLATE(BM_FilterEngineZoom, double, sirius::FilterEngine::kDirect)
+      ->Apply(FilterEngineArguments);
+BENCHMARK_TEMPLATE(BM_FilterEngineZoom, double, sirius::FilterEngine::kAuto)
+      ->Apply(FilterEngineArguments);
+BENCHMARK_TEMPLATE(BM_FilterEngineZoom, float, sirius::FilterEngine::kSpectral)
+      ->Apply(FilterEngineArguments);
+BENCHMARK_TEMPLATE(BM_FilterEngineZoom, float, sirius::FilterEngine::kDirect)
+      ->Apply(FilterEngineArguments);
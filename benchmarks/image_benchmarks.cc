@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "sirius/image.h"
+
+#include "sirius/utils/numeric.h"
+
+#include "utils.h"
+
+namespace {
+
+constexpr int kPaddingSize = 50;
+
+template <typename T>
+void BM_CreateMirrorPaddedImage(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    auto image = sirius::benchmarks::CreateRandomImage<T>(size);
+    sirius::Padding padding(kPaddingSize, kPaddingSize, kPaddingSize,
+                            kPaddingSize, sirius::PaddingType::kMirrorPadding);
+
+    for (auto _ : state) {
+        auto padded_image = image.CreateMirrorPaddedImage(padding);
+        benchmark::DoNotOptimize(padded_image.data.data());
+    }
+    sirius::benchmarks::SetPixelRate(
+          state, (size.row + 2 * kPaddingSize) * (size.col + 2 * kPaddingSize));
+}
+
+template <typename T>
+void BM_FFTShift2D(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    auto image = sirius::benchmarks::CreateRandomImage<T>(size);
+    sirius::BasicImage<T> shifted_image(size);
+
+    for (auto _ : state) {
+        sirius::utils::FFTShift2D(image.data.data(), size,
+                                  shifted_image.data.data());
+        benchmark::ClobberMemory();
+    }
+    sirius::benchmarks::SetPixelRate(state, size.CellCount());
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_CreateMirrorPaddedImage, double)
+      ->RangeMultiplier(2)
+      ->Range(256, 2048);
+BENCHMARK_TEMPLATE(BM_CreateMirrorPaddedImage, float)
+      ->RangeMultiplier(2)
+      ->Range(256, 2048);
+BENCHMARK_TEMPLATE(BM_FFTShift2D, double)->RangeMultiplier(2)->Range(256, 2048);
+BENCHMARK_TEMPLATE(BM_FFTShift2D, float)->RangeMultiplier(2)->Range(256, 2048);
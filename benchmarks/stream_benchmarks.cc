@@ -0,0 +1,78 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include "sirius/filter.h"
+#include "sirius/frequency_zoom_factory.h"
+#include "sirius/image_streamer.h"
+
+#include "utils.h"
+
+namespace {
+
+constexpr int kBlockSize = 256;
+constexpr int kZoom = 2;
+
+template <typename T>
+void BM_ImageStreamerStream(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    unsigned int worker_count = state.range(1);
+    std::string output_path = "/vsimem/sirius_benchmark_stream_output.tif";
+    auto frequency_zoom = sirius::FrequencyZoomFactory::Create(
+          sirius::ImageDecompositionPolicies::kPeriodicSmooth,
+          sirius::FrequencyZoomStrategies::kZeroPadding);
+    sirius::Filter no_filter;
+
+    std::string input_path;
+    try {
+        input_path = sirius::benchmarks::CreateImageFile(size);
+        for (auto _ : state) {
+            sirius::ImageStreamer streamer(
+                  input_path, output_path, {kBlockSize, kBlockSize},
+                  {kZoom, 1}, no_filter.Metadata(), worker_count);
+            streamer.Stream<T>(*frequency_zoom, no_filter);
+        }
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+    }
+    sirius::benchmarks::RemoveFile(input_path);
+    sirius::benchmarks::RemoveFile(output_path);
+    sirius::benchmarks::SetPixelRate(state, (size * kZoom).CellCount());
+}
+
+void StreamArguments(benchmark::internal::Benchmark* benchmark) {
+    int max_worker_count = std::max(1u, std::thread::hardware_concurrency());
+    benchmark->ArgNames({"size", "workers"})
+          ->ArgsProduct({{1024, 2048}, {1, max_worker_count}})
+          ->Unit(benchmark::kMillisecond)
+          ->UseRealTime();
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_ImageStreamerStream, double)->Apply(StreamArguments);
+BENCHMARK_TEMPLATE(BM_ImageStreamerStream, float)->Apply(StreamArguments);
@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "utils.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include <cpl_vsi.h>
+
+#include "sirius/fftw/wrapper.h"
+#include "sirius/gdal/wrapper.h"
+
+namespace sirius {
+namespace benchmarks {
+
+template <typename T>
+BasicImage<T> CreateRandomImage(const Size& size) {
+    BasicImage<T> image(size);
+    std::mt19937 generator(size.CellCount());
+    std::uniform_real_distribution<T> distribution(0, 255);
+    for (auto& cell : image.data) {
+        cell = distribution(generator);
+    }
+    return image;
+}
+
+template <typename T>
+fftw::BasicComplexUPtr<T> CopyFFT(const Size& image_size,
+                                  const fftw::BasicComplexUPtr<T>& image_fft) {
+    Size fft_size(image_size.row, image_size.col / 2 + 1);
+    auto copy = fftw::CreateComplex<T>(fft_size);
+    std::memcpy(copy.get(), image_fft.get(),
+                fft_size.CellCount() * sizeof(fftw::BasicComplex<T>));
+    return copy;
+}
+
+std::string CreateFilterFile(const Size& filter_size) {
+    std::string path = "/vsimem/sirius_benchmark_filter_" +
+                       std::to_string(filter_size.row) + "x" +
+                       std::to_string(filter_size.col) + ".tif";
+
+    Image filter(filter_size);
+    double sigma = filter_size.col / 6.0;
+    double sum = 0.0;
+    for (int row = 0; row < filter_size.row; ++row) {
+        for (int col = 0; col < filter_size.col; ++col) {
+            double y = row - filter_size.row / 2;
+            double x = col - filter_size.col / 2;
+            double value = std::exp(-(x * x + y * y) / (2 * sigma * sigma));
+            filter.Set(row, col, value);
+            sum += value;
+        }
+    }
+    for (auto& cell : filter.data) {
+        cell /= sum;
+    }
+
+    gdal::SaveImage(filter, path);
+    return path;
+}
+
+std::string CreateImageFile(const Size& image_size) {
+    std::string path = "/vsimem/sirius_benchmark_image_" +
+                       std::to_string(image_size.row) + "x" +
+                       std::to_string(image_size.col) + ".tif";
+    gdal::SaveImage(CreateRandomImage<float>(image_size), path);
+    return path;
+}
+
+void RemoveFile(const std::string& path) { ::VSIUnlink(path.c_str()); }
+
+void SetPixelRate(benchmark::State& state, int pixel_count) {
+    state.counters["Mpixel/s"] =
+          benchmark::Counter(pixel_count / 1e6,
+                             benchmark::Counter::kIsIterationInvariantRate);
+}
+
+template Image CreateRandomImage<double>(const Size& size);
+template FloatImage CreateRandomImage<float>(const Size& size);
+template fftw::ComplexUPtr CopyFFT<double>(const Size& image_size,
+                                           const fftw::ComplexUPtr& image_fft);
+template fftw::BasicComplexUPtr<float> CopyFFT<float>(
+      const Size& image_size, const fftw::BasicComplexUPtr<float>& image_fft);
+
+}  // namespace benchmarks
+}  // namespace sirius
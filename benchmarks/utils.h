@@ -0,0 +1,89 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIRIUS_BENCHMARKS_UTILS_H_
+#define SIRIUS_BENCHMARKS_UTILS_H_
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "sirius/image.h"
+#include "sirius/types.h"
+
+#include "sirius/fftw/types.h"
+
+namespace sirius {
+namespace benchmarks {
+
+/**
+ * \brief Create an image filled with reproducible pseudo random values
+ * \param size image size
+ * \return image
+ */
+template <typename T>
+BasicImage<T> CreateRandomImage(const Size& size);
+
+/**
+ * \brief Copy the FFT of an image
+ * \param image_size size of the image of the FFT
+ * \param image_fft image FFT computed by FFTW
+ * \return copy of the FFT
+ */
+template <typename T>
+fftw::BasicComplexUPtr<T> CopyFFT(const Size& image_size,
+                                  const fftw::BasicComplexUPtr<T>& image_fft);
+
+/**
+ * \brief Create a normalized gaussian filter in a GDAL in-memory file
+ * \param filter_size filter size (odd)
+ * \return path of the filter file
+ *
+ * \throw SiriusException if the file cannot be created
+ */
+std::string CreateFilterFile(const Size& filter_size);
+
+/**
+ * \brief Create a random image in a GDAL in-memory file
+ * \param image_size image size
+ * \return path of the image file
+ *
+ * \throw SiriusException if the file cannot be created
+ */
+std::string CreateImageFile(const Size& image_size);
+
+/**
+ * \brief Remove a file created by the benchmarks
+ * \param path file path
+ */
+void RemoveFile(const std::string& path);
+
+/**
+ * \brief Publish the Mpixel/s throughput of a benchmark
+ * \param state benchmark state
+ * \param pixel_count pixels produced by one iteration
+ */
+void SetPixelRate(benchmark::State& state, int pixel_count);
+
+}  // namespace benchmarks
+}  // namespace sirius
+
+#endif  // SIRIUS_BENCHMARKS_UTILS_H_
@@ -0,0 +1,253 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "sirius/frequency_zoom_factory.h"
+
+#include "sirius/fftw/wrapper.h"
+
+#include "sirius/zoom/image_decomposition/periodic_smooth_policy.h"
+#include "sirius/zoom/zoom_strategy/periodization_strategy.h"
+#include "sirius/zoom/zoom_strategy/zero_padding_strategy.h"
+
+#include "periodization_reference.h"
+#include "utils.h"
+
+namespace {
+
+template <typename T>
+sirius::fftw::BasicComplexUPtr<T> ZoomFFT(
+      const sirius::zoom::PeriodizationZoomStrategy& strategy, int zoom,
+      const sirius::BasicImage<T>& image,
+      sirius::fftw::BasicComplexUPtr<T> image_fft) {
+    return strategy.PeriodizeFFT(zoom, image, std::move(image_fft));
+}
+
+template <typename T>
+sirius::fftw::BasicComplexUPtr<T> ZoomFFT(
+      const sirius::zoom::ZeroPaddingZoomStrategy& strategy, int zoom,
+      const sirius::BasicImage<T>& image,
+      sirius::fftw::BasicComplexUPtr<T> image_fft) {
+    return strategy.ZeroPadFFT(zoom, image, std::move(image_fft));
+}
+
+template <typename T, typename ZoomStrategy>
+void BM_ZoomFFT(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    int zoom = state.range(1);
+    auto image = sirius::benchmarks::CreateRandomImage<T>(size);
+    auto image_fft = sirius::fftw::FFT(image);
+    ZoomStrategy strategy;
+
+    for (auto _ : state) {
+        // the zoom strategies consume the spectrum
+        state.PauseTiming();
+        auto fft = sirius::benchmarks::CopyFFT<T>(size, image_fft);
+        state.ResumeTiming();
+
+        auto zoomed_fft = ZoomFFT(strategy, zoom, image, std::move(fft));
+        benchmark::DoNotOptimize(zoomed_fft.get());
+    }
+    sirius::benchmarks::SetPixelRate(state, (size * zoom).CellCount());
+}
+
+template <typename T>
+void BM_PeriodizeFFT(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    int zoom = state.range(1);
+    auto image = sirius::benchmarks::CreateRandomImage<T>(size);
+    auto image_fft = sirius::fftw::FFT(image);
+    sirius::zoom::PeriodizationZoomStrategy strategy;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto fft = sirius::benchmarks::CopyFFT<T>(size, image_fft);
+        state.ResumeTiming();
+
+        auto zoomed_fft = strategy.PeriodizeFFT(zoom, image, std::move(fft));
+        benchmark::DoNotOptimize(zoomed_fft.get());
+    }
+    sirius::benchmarks::SetPixelRate(state, (size * zoom).CellCount());
+}
+
+template <typename T>
+void BM_ScatterPeriodizeFFT(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    int zoom = state.range(1);
+    auto image = sirius::benchmarks::CreateRandomImage<T>(size);
+    auto image_fft = sirius::fftw::FFT(image);
+
+    for (auto _ : state) {
+        auto zoomed_fft = sirius::tests::ScatterPeriodizeFFT<T>(
+              zoom, size, image_fft.get());
+        benchmark::DoNotOptimize(zoomed_fft.get());
+    }
+    sirius::benchmarks::SetPixelRate(state, (size * zoom).CellCount());
+}
+
+template <typename T>
+void BM_Interpolate2D(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    int zoom = state.range(1);
+    auto image = sirius::benchmarks::CreateRandomImage<T>(size);
+    sirius::zoom::ImageDecompositionPeriodicSmoothPolicy<
+          sirius::zoom::ZeroPaddingZoomStrategy>
+          policy;
+
+    for (auto _ : state) {
+        auto interpolated_image = policy.Interpolate2D(zoom, image);
+        benchmark::DoNotOptimize(interpolated_image.data.data());
+    }
+    sirius::benchmarks::SetPixelRate(state, (size * zoom).CellCount());
+}
+
+template <typename T, sirius::ImageDecompositionPolicies image_decomposition,
+          sirius::FrequencyZoomStrategies zoom_strategy>
+void BM_FrequencyZoomCompute(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    int zoom = state.range(1);
+    auto image = sirius::benchmarks::CreateRandomImage<T>(size);
+    auto frequency_zoom = sirius::FrequencyZoomFactory::Create(
+          image_decomposition, zoom_strategy);
+    sirius::ZoomRatio zoom_ratio(zoom, 1);
+
+    for (auto _ : state) {
+        auto zoomed_image = frequency_zoom->Compute(zoom_ratio, image, {});
+        benchmark::DoNotOptimize(zoomed_image.data.data());
+    }
+    sirius::benchmarks::SetPixelRate(state, (size * zoom).CellCount());
+}
+
+template <typename T, sirius::FrequencyZoomStrategies zoom_strategy>
+void BM_FrequencyZoomComputeRealZoom(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    sirius::ZoomRatio zoom_ratio(state.range(1), state.range(2));
+    auto image = sirius::benchmarks::CreateRandomImage<T>(size);
+    auto frequency_zoom = sirius::FrequencyZoomFactory::Create(
+          sirius::ImageDecompositionPolicies::kRegular, zoom_strategy);
+
+    int output_pixel_count = 0;
+    for (auto _ : state) {
+        auto zoomed_image = frequency_zoom->Compute(zoom_ratio, image, {});
+        benchmark::DoNotOptimize(zoomed_image.data.data());
+        output_pixel_count = zoomed_image.CellCount();
+    }
+    sirius::benchmarks::SetPixelRate(state, output_pixel_count);
+}
+
+template <typename T>
+void BM_FrequencyZoomComputeBatch(benchmark::State& state) {
+    sirius::Size size(state.range(0), state.range(0));
+    int batch_size = state.range(1);
+    int zoom = 2;
+    std::vector<sirius::BasicImage<T>> images;
+    for (int i = 0; i < batch_size; ++i) {
+        images.push_back(sirius::benchmarks::CreateRandomImage<T>(size));
+    }
+    auto frequency_zoom = sirius::FrequencyZoomFactory::Create(
+          sirius::ImageDecompositionPolicies::kRegular,
+          sirius::FrequencyZoomStrategies::kPeriodization);
+    sirius::ZoomRatio zoom_ratio(zoom, 1);
+
+    for (auto _ : state) {
+        auto zoomed_images = frequency_zoom->Compute(zoom_ratio, images, {});
+        benchmark::DoNotOptimize(zoomed_images.data());
+    }
+    sirius::benchmarks::SetPixelRate(state,
+                                     (size * zoom).CellCount() * batch_size);
+}
+
+void BatchArguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"size", "batch"})
+          ->ArgsProduct({{64, 128}, {1, 4, 16}})
+          ->Unit(benchmark::kMicrosecond);
+}
+
+void ZoomArguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"size", "zoom"})
+          ->ArgsProduct({{256, 512, 1024}, {2, 3}})
+          ->Unit(benchmark::kMillisecond);
+}
+
+void PeriodizationArguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"size", "zoom"})
+          ->ArgsProduct({{256, 512}, benchmark::CreateDenseRange(2, 8, 1)})
+          ->Unit(benchmark::kMillisecond);
+}
+
+void RealZoomArguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"size", "in", "out"})
+          ->ArgsProduct({{256, 512}, {3, 7}, {2, 5}})
+          ->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_ZoomFFT, double, sirius::zoom::PeriodizationZoomStrategy)
+      ->Apply(ZoomArguments);
+BENCHMARK_TEMPLATE(BM_ZoomFFT, float, sirius::zoom::PeriodizationZoomStrategy)
+      ->Apply(ZoomArguments);
+BENCHMARK_TEMPLATE(BM_ZoomFFT, double, sirius::zoom::ZeroPaddingZoomStrategy)
+      ->Apply(ZoomArguments);
+BENCHMARK_TEMPLATE(BM_ZoomFFT, float, sirius::zoom::ZeroPaddingZoomStrategy)
+      ->Apply(ZoomArguments);
+
+BENCHMARK_TEMPLATE(BM_PeriodizeFFT, double)->Apply(PeriodizationArguments);
+BENCHMARK_TEMPLATE(BM_ScatterPeriodizeFFT, double)
+      ->Apply(PeriodizationArguments);
+BENCHMARK_TEMPLATE(BM_PeriodizeFFT, float)->Apply(PeriodizationArguments);
+BENCHMARK_TEMPLATE(BM_ScatterPeriodizeFFT, float)
+      ->Apply(PeriodizationArguments);
+
+BENCHMARK_TEMPLATE(BM_Interpolate2D, double)->Apply(ZoomArguments);
+BENCHMARK_TEMPLATE(BM_Interpolate2D, float)->Apply(ZoomArguments);
+
+#define SIRIUS_BENCHMARK_COMPUTE(type, decomposition, strategy)           \
+    BENCHMARK_TEMPLATE(BM_FrequencyZoomCompute, type,                     \
+                       sirius::ImageDecompositionPolicies::decomposition, \
+                       sirius::FrequencyZoomStrategies::strategy)         \
+          ->Apply(ZoomArguments)
+
+SIRIUS_BENCHMARK_COMPUTE(double, kRegular, kZeroPadding);
+SIRIUS_BENCHMARK_COMPUTE(double, kRegular, kPeriodization);
+SIRIUS_BENCHMARK_COMPUTE(double, kPeriodicSmooth, kZeroPadding);
+SIRIUS_BENCHMARK_COMPUTE(double, kPeriodicSmooth, kPeriodization);
+SIRIUS_BENCHMARK_COMPUTE(float, kRegular, kZeroPadding);
+SIRIUS_BENCHMARK_COMPUTE(float, kRegular, kPeriodization);
+SIRIUS_BENCHMARK_COMPUTE(float, kPeriodicSmooth, kZeroPadding);
+SIRIUS_BENCHMARK_COMPUTE(float, kPeriodicSmooth, kPeriodization);
+
+BENCHMARK_TEMPLATE(BM_FrequencyZoomComputeRealZoom, double,
+                   sirius::FrequencyZoomStrategies::kZeroPadding)
+      ->Apply(RealZoomArguments);
+BENCHMARK_TEMPLATE(BM_FrequencyZoomComputeRealZoom, double,
+                   sirius::FrequencyZoomStrategies::kPeriodization)
+      ->Apply(RealZoomArguments);
+BENCHMARK_TEMPLATE(BM_FrequencyZoomComputeRealZoom, float,
+                   sirius::FrequencyZoomStrategies::kZeroPadding)
+      ->Apply(RealZoomArguments);
+
+BENCHMARK_TEMPLATE(BM_FrequencyZoomComputeBatch, double)
+      ->Apply(BatchArguments);
+BENCHMARK_TEMPLATE(BM_FrequencyZoomComputeBatch, float)->Apply(BatchArguments);
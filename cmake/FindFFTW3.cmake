@@ -25,12 +25,16 @@
 #
 # Find fftw3
 #
-# Find the native FFTW3 headers and libraries (double precision).
+# Find the native FFTW3 headers and libraries (double and single precision).
 #
 # ::
 #
 #   FFTW3_INCLUDE_DIRS - where to find fftw3.h, etc.
 #   FFTW3_LIBRARIES    - List of libraries when using fftw3.
+#   FFTW3_LIBRARY      - fftw3 library (double precision)
+#   FFTW3F_LIBRARY     - fftw3f library (single precision)
+#   FFTW3_THREADS_LIBRARY  - fftw3_threads library (double precision)
+#   FFTW3F_THREADS_LIBRARY - fftw3f_threads library (single precision)
 #   FFTW3_FOUND        - True if fftw3 found.
 
 find_package(PkgConfig)
@@ -39,13 +43,16 @@ pkg_check_modules(PC_FFTW3 fftw3)
 find_path(FFTW3_INCLUDE_DIR fftw3.h HINTS ${PC_FFTW3_INCLUDE_DIRS})
 
 find_library(FFTW3_LIBRARY NAMES fftw3 HINTS ${PC_FFTW3_LIBRARY_DIRS} )
+find_library(FFTW3F_LIBRARY NAMES fftw3f HINTS ${PC_FFTW3_LIBRARY_DIRS} )
+find_library(FFTW3_THREADS_LIBRARY NAMES fftw3_threads HINTS ${PC_FFTW3_LIBRARY_DIRS} )
+find_library(FFTW3F_THREADS_LIBRARY NAMES fftw3f_threads HINTS ${PC_FFTW3_LIBRARY_DIRS} )
 
-set(FFTW3_LIBRARIES ${FFTW3_LIBRARY} )
+set(FFTW3_LIBRARIES ${FFTW3_LIBRARY} ${FFTW3F_LIBRARY} ${FFTW3_THREADS_LIBRARY} ${FFTW3F_THREADS_LIBRARY} )
 set(FFTW3_INCLUDE_DIRS ${FFTW3_INCLUDE_DIR} )
 
 include(FindPackageHandleStandardArgs)
 
-find_package_handle_standard_args(FFTW3 DEFAULT_MSG FFTW3_LIBRARY FFTW3_INCLUDE_DIR )
+find_package_handle_standard_args(FFTW3 DEFAULT_MSG FFTW3_LIBRARY FFTW3F_LIBRARY FFTW3_THREADS_LIBRARY FFTW3F_THREADS_LIBRARY FFTW3_INCLUDE_DIR )
 
-mark_as_advanced(FFTW3_INCLUDE_DIR FFTW3_LIBRARY )
+mark_as_advanced(FFTW3_INCLUDE_DIR FFTW3_LIBRARY FFTW3F_LIBRARY FFTW3_THREADS_LIBRARY FFTW3F_THREADS_LIBRARY )
 
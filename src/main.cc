@@ -19,9 +19,16 @@
  * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <exception>
+#include <fstream>
 #include <future>
 #include <iostream>
+#include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <system_error>
@@ -36,10 +43,14 @@
 #include "sirius/image_streamer.h"
 #include "sirius/sirius.h"
 
+#include "sirius/fftw/fftw.h"
+
 #include "sirius/gdal/wrapper.h"
 
+#include "sirius/utils/buffer_pool.h"
 #include "sirius/utils/log.h"
 #include "sirius/utils/numeric.h"
+#include "sirius/utils/work_stealing_scheduler.h"
 
 struct CliParameters {
     // status
@@ -59,6 +70,7 @@ struct CliParameters {
     int output_resolution = 1;
     bool periodic_smooth_image_decomposition = false;
     bool zpd_zoom_strategy = false;
+    bool single_precision = false;
 
     // filter options
     std::string filter_path;
@@ -70,9 +82,23 @@ struct CliParameters {
     int stream_block_height = 256;
     int stream_block_width = 256;
     bool stream_disable_block_resizing = false;
+    bool stream_auto_block_size = false;
+    int stream_tile_cache_size = 256;
+    unsigned int stream_batch_size = 0;
     bool filter_normalize = false;
+    double filter_separable_tolerance = sirius::Filter::kSeparableTolerance;
+    std::string filter_engine = "spectral";
     unsigned int stream_parallel_workers = std::thread::hardware_concurrency();
 
+    // fftw options
+    std::string fftw_wisdom_path;
+    std::string fftw_planner = "estimate";
+    int fftw_threads = 1;
+    bool prepare_wisdom = false;
+
+    // batch mode options
+    std::string batch_manifest_path;
+
     bool HasStreamMode() const {
         return stream_mode && stream_block_height > 0 && stream_block_width > 0;
     }
@@ -80,17 +106,46 @@ struct CliParameters {
     sirius::Size GetStreamBlockSize() const {
         return {stream_block_height, stream_block_width};
     }
+
+    bool HasBatchMode() const { return !batch_manifest_path.empty(); }
+};
+
+struct BatchJob {
+    std::string input_image_path;
+    std::string output_image_path;
 };
 
 CliParameters GetCliParameters(int argc, const char* argv[]);
+template <typename T>
 void RunRegularMode(const sirius::IFrequencyZoom& frequency_zoom,
                     const sirius::Filter& filter,
                     const sirius::ZoomRatio& zoom_ratio,
                     const CliParameters& params);
+template <typename T>
 void RunStreamMode(const sirius::IFrequencyZoom& frequency_zoom,
                    const sirius::Filter& filter,
                    const sirius::ZoomRatio& zoom_ratio,
-                   const CliParameters& params);
+                   const CliParameters& params, bool is_batch_job = false);
+template <typename T>
+std::size_t RunBatchMode(const sirius::IFrequencyZoom& frequency_zoom,
+                         const sirius::Filter& filter,
+                         const sirius::ZoomRatio& zoom_ratio,
+                         const std::vector<BatchJob>& jobs,
+                         const CliParameters& params);
+template <typename T>
+void RunPrepareWisdomMode(const sirius::IFrequencyZoom& frequency_zoom,
+                          const sirius::Filter& filter,
+                          const sirius::ZoomRatio& zoom_ratio,
+                          const CliParameters& params);
+sirius::Size ComputeStreamBlockSize(const sirius::Filter& filter,
+                                    const sirius::ZoomRatio& zoom_ratio,
+                                    const CliParameters& params);
+bool GetPlanningRigor(const std::string& planner,
+                      sirius::fftw::PlanningRigor& rigor);
+bool GetFilterEngine(const std::string& engine_name,
+                     sirius::FilterEngine& engine);
+bool ReadBatchManifest(const std::string& manifest_path,
+                       std::vector<BatchJob>& jobs);
 
 int main(int argc, const char* argv[]) {
     CliParameters params = GetCliParameters(argc, argv);
@@ -99,18 +154,86 @@ int main(int argc, const char* argv[]) {
         return params.help_requested ? 0 : 1;
     }
 
-    if (params.input_image_path.empty() || params.output_image_path.empty()) {
+    if (params.HasBatchMode() && (!params.input_image_path.empty() ||
+                                  !params.output_image_path.empty())) {
+        std::cerr << "sirius: --batch replaces the input and output arguments"
+                  << std::endl;
+        return 1;
+    }
+
+    if (params.HasBatchMode() && params.prepare_wisdom) {
+        std::cerr << "sirius: --prepare-wisdom cannot be combined with --batch"
+                  << std::endl;
+        return 1;
+    }
+
+    if (!params.prepare_wisdom && !params.HasBatchMode() &&
+        (params.input_image_path.empty() ||
+         params.output_image_path.empty())) {
         std::cerr << params.help_message << std::endl;
         std::cerr << "sirius: input and/or output arguments are missing"
                   << std::endl;
         return 1;
     }
 
+    if (params.prepare_wisdom && params.fftw_wisdom_path.empty()) {
+        std::cerr << "sirius: --prepare-wisdom requires --fftw-wisdom"
+                  << std::endl;
+        return 1;
+    }
+
+    sirius::fftw::PlanningRigor planning_rigor;
+    if (!GetPlanningRigor(params.fftw_planner, planning_rigor)) {
+        std::cerr << "sirius: unknown FFTW planner '" << params.fftw_planner
+                  << "'" << std::endl;
+        return 1;
+    }
+
+    sirius::FilterEngine filter_engine;
+    if (!GetFilterEngine(params.filter_engine, filter_engine)) {
+        std::cerr << "sirius: unknown filter engine '" << params.filter_engine
+                  << "'" << std::endl;
+        return 1;
+    }
+
+    std::vector<BatchJob> batch_jobs;
+    if (params.HasBatchMode() &&
+        !ReadBatchManifest(params.batch_manifest_path, batch_jobs)) {
+        return 1;
+    }
+
     sirius::utils::SetVerbosityLevel(params.verbosity_level);
 
     LOG("sirius", info, "Sirius {} - {}", sirius::kVersion, sirius::kGitCommit);
 
+    std::size_t failed_job_count = 0;
     try {
+        // fftw parameters
+        auto& fftw = sirius::fftw::Fftw::Instance();
+        if (params.prepare_wisdom &&
+            planning_rigor == sirius::fftw::PlanningRigor::kEstimate) {
+            LOG("sirius", info,
+                "estimate planner does not produce wisdom, use measure");
+            planning_rigor = sirius::fftw::PlanningRigor::kMeasure;
+        }
+        LOG("sirius", info, "FFTW planner: {}", params.fftw_planner);
+        fftw.SetPlanningRigor(planning_rigor);
+        if (!params.fftw_wisdom_path.empty()) {
+            fftw.ImportWisdom(params.fftw_wisdom_path);
+        }
+        if (params.HasStreamMode() || params.HasBatchMode()) {
+            // stream and batch workers already run one block or image per
+            // thread
+            if (params.fftw_threads > 1) {
+                LOG("sirius", warn,
+                    "FFTW threads are ignored in stream and batch modes, use "
+                    "--parallel-workers instead");
+            }
+        } else {
+            fftw.SetThreadCount(params.fftw_threads);
+            LOG("sirius", info, "FFTW threads: {}", fftw.thread_count());
+        }
+
         // zoom parameters
         sirius::ZoomRatio zoom_ratio(params.input_resolution,
                                      params.output_resolution);
@@ -158,9 +281,12 @@ int main(int argc, const char* argv[]) {
         sirius::Filter filter;
         if (!params.filter_path.empty()) {
             LOG("sirius", info, "filter path: {}", params.filter_path);
+            LOG("sirius", info, "filter engine: {}", params.filter_engine);
             filter =
                   sirius::Filter::Create(params.filter_path, zoom_ratio,
-                                         padding_type, params.filter_normalize);
+                                         padding_type, params.filter_normalize,
+                                         params.filter_separable_tolerance,
+                                         filter_engine);
         }
 
         if (zoom_strategy == sirius::FrequencyZoomStrategies::kPeriodization &&
@@ -169,48 +295,262 @@ int main(int argc, const char* argv[]) {
                 "providing a filter for this zoom is highly recommended");
         }
 
-        if (!params.HasStreamMode()) {
-            RunRegularMode(*frequency_zoom, filter, zoom_ratio, params);
+        if (params.single_precision) {
+            LOG("sirius", info, "precision: single");
+        } else {
+            LOG("sirius", info, "precision: double");
+        }
+
+        if (params.prepare_wisdom) {
+            if (params.single_precision) {
+                RunPrepareWisdomMode<float>(*frequency_zoom, filter,
+                                            zoom_ratio, params);
+            } else {
+                RunPrepareWisdomMode<double>(*frequency_zoom, filter,
+                                             zoom_ratio, params);
+            }
+        } else if (params.HasBatchMode()) {
+            if (params.single_precision) {
+                failed_job_count = RunBatchMode<float>(
+                      *frequency_zoom, filter, zoom_ratio, batch_jobs, params);
+            } else {
+                failed_job_count = RunBatchMode<double>(
+                      *frequency_zoom, filter, zoom_ratio, batch_jobs, params);
+            }
+        } else if (!params.HasStreamMode()) {
+            if (params.single_precision) {
+                RunRegularMode<float>(*frequency_zoom, filter, zoom_ratio,
+                                      params);
+            } else {
+                RunRegularMode<double>(*frequency_zoom, filter, zoom_ratio,
+                                       params);
+            }
         } else {
-            RunStreamMode(*frequency_zoom, filter, zoom_ratio, params);
+            if (params.single_precision) {
+                RunStreamMode<float>(*frequency_zoom, filter, zoom_ratio,
+                                     params);
+            } else {
+                RunStreamMode<double>(*frequency_zoom, filter, zoom_ratio,
+                                      params);
+            }
+        }
+
+        if (!params.fftw_wisdom_path.empty()) {
+            fftw.ExportWisdom(params.fftw_wisdom_path);
         }
+
+        auto pool_stats = sirius::utils::BufferPool::Instance().GetStats();
+        LOG("sirius", debug, "buffer pool: {} hits, {} misses, {} unpooled",
+            pool_stats.hit_count, pool_stats.miss_count,
+            pool_stats.unpooled_count);
     } catch (const sirius::SiriusException& e) {
         std::cerr << "sirius: exception while computing zoom: " << e.what()
                   << std::endl;
         return 1;
     }
 
-    return 0;
+    return failed_job_count > 0 ? 1 : 0;
 }
 
+template <typename T>
 void RunRegularMode(const sirius::IFrequencyZoom& frequency_zoom,
                     const sirius::Filter& filter,
                     const sirius::ZoomRatio& zoom_ratio,
                     const CliParameters& params) {
     LOG("sirius", info, "regular mode");
-    auto input_image = sirius::gdal::LoadImage(params.input_image_path);
-    LOG("sirius", info, "input image \"{}\", {}x{}", params.input_image_path,
-        input_image.size.row, input_image.size.col);
+    auto input_bands = sirius::gdal::LoadImageBands<T>(params.input_image_path);
+    LOG("sirius", info, "input image \"{}\", {}x{}, {} band(s)",
+        params.input_image_path, input_bands.front().size.row,
+        input_bands.front().size.col, input_bands.size());
 
     auto geo_ref = sirius::gdal::ComputeZoomedGeoReference(
           params.input_image_path, zoom_ratio);
 
-    auto zoomed_image = frequency_zoom.Compute(zoom_ratio, input_image,
-                                               filter.padding(), filter);
+    // bands share the image size: FFT plans and filter spectrum are reused
+    std::vector<sirius::BasicImage<T>> zoomed_bands;
+    for (const auto& input_image : input_bands) {
+        zoomed_bands.push_back(frequency_zoom.Compute(
+              zoom_ratio, input_image, filter.padding(), filter));
+    }
     LOG("sirius", info, "zoomed image \"{}\", {}x{}", params.output_image_path,
-        zoomed_image.size.row, zoomed_image.size.col);
-    sirius::gdal::SaveImage(zoomed_image, params.output_image_path, geo_ref);
+        zoomed_bands.front().size.row, zoomed_bands.front().size.col);
+    sirius::gdal::SaveImageBands(zoomed_bands, params.output_image_path,
+                                 geo_ref);
 }
 
+template <typename T>
 void RunStreamMode(const sirius::IFrequencyZoom& frequency_zoom,
                    const sirius::Filter& filter,
                    const sirius::ZoomRatio& zoom_ratio,
-                   const CliParameters& params) {
+                   const CliParameters& params, bool is_batch_job) {
     LOG("sirius", info, "streaming mode");
     unsigned int max_parallel_workers =
           std::max(std::min(params.stream_parallel_workers,
                             std::thread::hardware_concurrency()),
                    1u);
+    auto stream_block_size = ComputeStreamBlockSize(filter, zoom_ratio, params);
+    std::size_t max_tile_cache_bytes =
+          static_cast<std::size_t>(std::max(params.stream_tile_cache_size, 0)) *
+          1024 * 1024;
+    sirius::ImageStreamer streamer(
+          params.input_image_path, params.output_image_path, stream_block_size,
+          zoom_ratio, filter.Metadata(), max_parallel_workers,
+          max_tile_cache_bytes, params.stream_batch_size, !is_batch_job,
+          !is_batch_job);
+    streamer.Stream<T>(frequency_zoom, filter);
+}
+
+template <typename T>
+std::size_t RunBatchMode(const sirius::IFrequencyZoom& frequency_zoom,
+                         const sirius::Filter& filter,
+                         const sirius::ZoomRatio& zoom_ratio,
+                         const std::vector<BatchJob>& jobs,
+                         const CliParameters& params) {
+    LOG("sirius", info, "batch mode: {} job(s)", jobs.size());
+    if (jobs.empty()) {
+        return 0;
+    }
+
+    // jobs are the unit of parallelism: images are zoomed concurrently
+    unsigned int max_parallel_workers = std::max(
+          std::min(params.stream_parallel_workers,
+                   std::thread::hardware_concurrency()),
+          1u);
+    unsigned int worker_count = std::min(
+          max_parallel_workers, static_cast<unsigned int>(jobs.size()));
+
+    CliParameters job_params = params;
+    bool is_stream_mode = params.HasStreamMode();
+    if (is_stream_mode) {
+        // concurrent streams share the workers and the tile cache memory
+        // budget: a batch with less images than workers streams each image
+        // with several workers
+        job_params.stream_parallel_workers =
+              std::max(max_parallel_workers / worker_count, 1u);
+        LOG("sirius", info, "{} stream worker(s) per job",
+            job_params.stream_parallel_workers);
+        job_params.stream_tile_cache_size =
+              params.stream_tile_cache_size / static_cast<int>(worker_count);
+
+        if (filter.IsLoaded()) {
+            // the filter is shared by concurrent streams which cannot prepare
+            // it: prepare the spectrum of the full blocks once, the spectra of
+            // the border blocks are computed on demand
+            job_params.input_image_path = jobs.front().input_image_path;
+            auto block_size =
+                  ComputeStreamBlockSize(filter, zoom_ratio, job_params);
+            auto padding_size = filter.padding_size();
+            sirius::Size padded_size(block_size.row + 2 * padding_size.row,
+                                     block_size.col + 2 * padding_size.col);
+            padded_size.row += padded_size.row % 2;
+            padded_size.col += padded_size.col % 2;
+            filter.PrepareSpectra<T>(frequency_zoom.FilterSpectrumSizes(
+                  zoom_ratio, {padded_size * zoom_ratio.input_resolution()},
+                  filter));
+        }
+    }
+
+    std::vector<std::size_t> job_indices(jobs.size());
+    std::iota(job_indices.begin(), job_indices.end(), 0);
+    std::atomic<std::size_t> failed_job_count{0};
+
+    auto run_job = [&frequency_zoom, &filter, &zoom_ratio, &jobs, &job_params,
+                    is_stream_mode,
+                    &failed_job_count](unsigned int, std::size_t job_index) {
+        const auto& job = jobs[job_index];
+        CliParameters current_params = job_params;
+        current_params.input_image_path = job.input_image_path;
+        current_params.output_image_path = job.output_image_path;
+
+        auto start = std::chrono::steady_clock::now();
+        try {
+            if (is_stream_mode) {
+                RunStreamMode<T>(frequency_zoom, filter, zoom_ratio,
+                                 current_params, true);
+            } else {
+                RunRegularMode<T>(frequency_zoom, filter, zoom_ratio,
+                                  current_params);
+            }
+        } catch (const std::exception& e) {
+            ++failed_job_count;
+            LOG("sirius", error, "job {}/{} \"{}\" -> \"{}\" failed: {}",
+                job_index + 1, jobs.size(), job.input_image_path,
+                job.output_image_path, e.what());
+            return true;
+        }
+        std::chrono::duration<double, std::milli> elapsed =
+              std::chrono::steady_clock::now() - start;
+        LOG("sirius", info, "job {}/{} \"{}\" -> \"{}\" done in {:.1f} ms",
+            job_index + 1, jobs.size(), job.input_image_path,
+            job.output_image_path, elapsed.count());
+        return true;
+    };
+
+    LOG("sirius", info, "start batch processing of {} job(s) with {} workers",
+        jobs.size(), worker_count);
+    auto start = std::chrono::steady_clock::now();
+    sirius::utils::WorkStealingScheduler<std::size_t> scheduler(worker_count);
+    scheduler.Run(std::move(job_indices), run_job);
+    // buffers are kept warm across the jobs and released once they are done
+    sirius::utils::BufferPool::Instance().Trim();
+    std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+
+    LOG("sirius", info,
+        "end batch processing: {} job(s) done, {} failed in {:.2f} s",
+        jobs.size() - failed_job_count, failed_job_count.load(),
+        elapsed.count());
+    return failed_job_count;
+}
+
+template <typename T>
+void RunPrepareWisdomMode(const sirius::IFrequencyZoom& frequency_zoom,
+                          const sirius::Filter& filter,
+                          const sirius::ZoomRatio& zoom_ratio,
+                          const CliParameters& params) {
+    LOG("sirius", info, "prepare wisdom mode");
+
+    // zero images of the processed sizes are zoomed so that every plan
+    // requested by the zoom (batched, pruned, 1D and chirp-z transforms) is
+    // planned, not only the image FFT and IFFT
+    if (params.input_image_path.empty()) {
+        // without input image, the block grid is unknown: only blocks
+        // surrounded by their margins are zoomed
+        auto stream_block_size =
+              ComputeStreamBlockSize(filter, zoom_ratio, params);
+        auto filter_metadata = filter.Metadata();
+        sirius::BasicImage<T> block(
+              {stream_block_size.row + 2 * filter_metadata.margin_size.row,
+               stream_block_size.col + 2 * filter_metadata.margin_size.col});
+        frequency_zoom.Compute(
+              zoom_ratio, block,
+              sirius::Padding(0, 0, 0, 0, filter_metadata.padding_type),
+              filter);
+        LOG("sirius", info, "stream block {}x{} planned", block.size.row,
+            block.size.col);
+    } else if (params.HasStreamMode()) {
+        // blocks of the input image grid, border blocks and batches included
+        sirius::ImageStreamer::PrepareZoom<T>(
+              params.input_image_path,
+              ComputeStreamBlockSize(filter, zoom_ratio, params), zoom_ratio,
+              filter.Metadata(), params.stream_batch_size, frequency_zoom,
+              filter);
+    } else {
+        // regular mode zooms each band of the whole image
+        auto input_dataset =
+              sirius::gdal::LoadDataset(params.input_image_path);
+        sirius::BasicImage<T> image({input_dataset->GetRasterYSize(),
+                                     input_dataset->GetRasterXSize()});
+        input_dataset.reset();
+        frequency_zoom.Compute(zoom_ratio, image, filter.padding(), filter);
+        LOG("sirius", info, "image {}x{} planned", image.size.row,
+            image.size.col);
+    }
+}
+
+sirius::Size ComputeStreamBlockSize(const sirius::Filter& filter,
+                                    const sirius::ZoomRatio& zoom_ratio,
+                                    const CliParameters& params) {
     auto stream_block_size = params.GetStreamBlockSize();
 
     // improve stream_block_size if requested or required
@@ -226,10 +566,112 @@ void RunStreamMode(const sirius::IFrequencyZoom& frequency_zoom,
         stream_block_size = sirius::utils::GenerateZoomCompliantSize(
               stream_block_size, zoom_ratio);
     }
-    sirius::ImageStreamer streamer(
-          params.input_image_path, params.output_image_path, stream_block_size,
-          zoom_ratio, filter.Metadata(), max_parallel_workers);
-    streamer.Stream(frequency_zoom, filter);
+
+    if (params.stream_auto_block_size) {
+        if (params.input_image_path.empty()) {
+            LOG("sirius", warn,
+                "no input image: stream blocks cannot be aligned on its "
+                "native blocks");
+            return stream_block_size;
+        }
+        auto input_dataset =
+              sirius::gdal::LoadDataset(params.input_image_path);
+        auto tile_size =
+              sirius::gdal::GetNativeBlockSize(input_dataset.get());
+        LOG("sirius", info, "input native block size: {}x{}", tile_size.row,
+            tile_size.col);
+        // keep the block size compliant with the zoom ratio
+        int zoom_step = zoom_ratio.output_resolution() /
+                        sirius::utils::Gcd(zoom_ratio.input_resolution(),
+                                           zoom_ratio.output_resolution());
+        if (zoom_ratio.IsRealZoom()) {
+            tile_size.row *= zoom_step /
+                             sirius::utils::Gcd(tile_size.row, zoom_step);
+            tile_size.col *= zoom_step /
+                             sirius::utils::Gcd(tile_size.col, zoom_step);
+        }
+        auto padding_size = filter.padding_size();
+        sirius::Size max_size(
+              input_dataset->GetRasterYSize() - 2 * padding_size.row,
+              input_dataset->GetRasterXSize() - 2 * padding_size.col);
+        stream_block_size = sirius::utils::GenerateTileAlignedSize(
+              stream_block_size, tile_size, max_size);
+        if (!params.stream_disable_block_resizing) {
+            // tile alignment may give poor FFT sizes (e.g. 256 + 2 * 50)
+            stream_block_size = sirius::utils::GenerateSmoothSize(
+                  stream_block_size, tile_size, max_size, padding_size,
+                  zoom_ratio.input_resolution(), {zoom_step, zoom_step});
+        }
+    }
+    return stream_block_size;
+}
+
+bool GetPlanningRigor(const std::string& planner,
+                      sirius::fftw::PlanningRigor& rigor) {
+    if (planner == "estimate") {
+        rigor = sirius::fftw::PlanningRigor::kEstimate;
+    } else if (planner == "measure") {
+        rigor = sirius::fftw::PlanningRigor::kMeasure;
+    } else if (planner == "patient") {
+        rigor = sirius::fftw::PlanningRigor::kPatient;
+    } else if (planner == "exhaustive") {
+        rigor = sirius::fftw::PlanningRigor::kExhaustive;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool GetFilterEngine(const std::string& engine_name,
+                     sirius::FilterEngine& engine) {
+    if (engine_name == "auto") {
+        engine = sirius::FilterEngine::kAuto;
+    } else if (engine_name == "spectral") {
+        engine = sirius::FilterEngine::kSpectral;
+    } else if (engine_name == "direct") {
+        engine = sirius::FilterEngine::kDirect;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ReadBatchManifest(const std::string& manifest_path,
+                       std::vector<BatchJob>& jobs) {
+    std::ifstream manifest_file;
+    bool is_stdin = (manifest_path == "-");
+    if (!is_stdin) {
+        manifest_file.open(manifest_path);
+        if (!manifest_file) {
+            std::cerr << "sirius: cannot open batch manifest '"
+                      << manifest_path << "'" << std::endl;
+            return false;
+        }
+    }
+    std::istream& manifest = is_stdin ? std::cin : manifest_file;
+
+    // one "input-image output-image" pair per line, blank lines and lines
+    // starting with # are ignored
+    std::string line;
+    int line_number = 0;
+    while (std::getline(manifest, line)) {
+        ++line_number;
+        std::istringstream line_stream(line);
+        BatchJob job;
+        if (!(line_stream >> job.input_image_path) ||
+            job.input_image_path.front() == '#') {
+            continue;
+        }
+        std::string extra_field;
+        if (!(line_stream >> job.output_image_path) ||
+            (line_stream >> extra_field)) {
+            std::cerr << "sirius: batch manifest line " << line_number
+                      << ": expected 'input-image output-image'" << std::endl;
+            return false;
+        }
+        jobs.push_back(std::move(job));
+    }
+    return true;
 }
 
 CliParameters GetCliParameters(int argc, const char* argv[]) {
@@ -266,7 +708,11 @@ CliParameters GetCliParameters(int argc, const char* argv[]) {
          cxxopts::value(params.periodic_smooth_image_decomposition))
         ("zoom-zero-padding", "Use zero padding zoom algorithm "
          "(default is periodization zoom algorithm)",
-         cxxopts::value(params.zpd_zoom_strategy));
+         cxxopts::value(params.zpd_zoom_strategy))
+        ("single-precision",
+         "Compute the zoom in single precision (float32) "
+         "(default is double precision)",
+         cxxopts::value(params.single_precision));
 
     options.add_options("filter")
         ("filter",
@@ -283,7 +729,16 @@ CliParameters GetCliParameters(int argc, const char* argv[]) {
         ("filter-normalize",
          "Normalize filter coefficients "
          "(default is no normalization)",
-         cxxopts::value(params.filter_normalize));
+         cxxopts::value(params.filter_normalize))
+        ("filter-separable-tolerance",
+         "Relative tolerance under which the filter is applied as the outer "
+         "product of a column and a row kernel (negative disables it)",
+         cxxopts::value(params.filter_separable_tolerance)
+               ->default_value("1e-6"))
+        ("filter-engine",
+         "Filtering engine (auto,spectral,direct): spectrum product or "
+         "direct convolution, auto chooses the cheapest for each block size",
+         cxxopts::value(params.filter_engine)->default_value("spectral"));
 
     options.add_options("streaming")
         ("stream", "Enable stream mode",
@@ -295,11 +750,46 @@ CliParameters GetCliParameters(int argc, const char* argv[]) {
         ("no-block-resizing",
          "Disable block resizing optimization",
          cxxopts::value(params.stream_disable_block_resizing))
+        ("auto-block-size",
+         "Align stream blocks on the native blocks (tiles or strips) of "
+         "the input image, block width and height are used as size hints",
+         cxxopts::value(params.stream_auto_block_size))
+        ("tile-cache-size",
+         "Size in MiB of the decoded tile cache shared by the block reads "
+         "(0 disables the cache)",
+         cxxopts::value(params.stream_tile_cache_size)->default_value("256"))
+        ("batch-size",
+         "Number of blocks of the same size zoomed together with batched "
+         "FFTs (0 adapts the batch size to the block size)",
+         cxxopts::value(params.stream_batch_size)->default_value("0"))
         ("parallel-workers", stream_parallel_workers_desc.str(),
          cxxopts::value(params.stream_parallel_workers)
             ->default_value("1")
             ->implicit_value("1"));
 
+    options.add_options("fftw")
+        ("fftw-wisdom",
+         "FFTW wisdom file loaded at startup and saved at exit",
+         cxxopts::value(params.fftw_wisdom_path))
+        ("fftw-planner",
+         "FFTW planner rigor (estimate,measure,patient,exhaustive)",
+         cxxopts::value(params.fftw_planner)->default_value("estimate"))
+        ("fftw-threads",
+         "Threads used by FFTW for each transform (regular mode only)",
+         cxxopts::value(params.fftw_threads)->default_value("1"))
+        ("prepare-wisdom",
+         "Plan the FFT sizes required by the zoom, filter and block options, "
+         "save them into the wisdom file and exit "
+         "(input image is optional, output image is ignored)",
+         cxxopts::value(params.prepare_wisdom));
+
+    options.add_options("batch")
+        ("batch",
+         "Zoom the input-image output-image pairs listed one per line in "
+         "this manifest ('-' reads stdin) with the same zoom and filter, "
+         "images are zoomed concurrently by the parallel workers",
+         cxxopts::value(params.batch_manifest_path));
+
     options.add_options("positional arguments")
         ("i,input", "Input image", cxxopts::value(params.input_image_path))
         ("o,output", "Output image", cxxopts::value(params.output_image_path));
@@ -307,7 +797,8 @@ CliParameters GetCliParameters(int argc, const char* argv[]) {
 
     options.parse_positional({"input", "output"});
 
-    params.help_message = options.help({"", "zoom", "filter", "streaming"});
+    params.help_message =
+          options.help({"", "zoom", "filter", "streaming", "fftw", "batch"});
 
     try {
         auto result = options.parse(argc, argv);
@@ -21,7 +21,10 @@
 
 #include "sirius/fftw/fftw.h"
 
+#include <algorithm>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
 #include <fftw3.h>
 
@@ -33,91 +36,406 @@
 namespace sirius {
 namespace fftw {
 
+namespace {
+
+const char kFloatWisdomSuffix[] = ".f32";
+
+// extra bytes allocated for scratch arrays so that they can reproduce the
+// SIMD alignment offset of the planned arrays
+constexpr int kMaxAlignmentOffset = 64;
+
+template <typename Array>
+Array* OffsetArray(Array* array, int alignment_offset) {
+    return reinterpret_cast<Array*>(reinterpret_cast<char*>(array) +
+                                    alignment_offset);
+}
+
+}  // namespace
+
 namespace detail {
 
-void PlanDeleter::operator()(::fftw_plan plan) {
-    Fftw::Instance().DestroyPlan(plan);
+template <typename T>
+void PlanDeleter<T>::operator()(BasicPlan<T> plan) {
+    Fftw::Instance().DestroyPlan<T>(plan);
 }
 
 }  // namespace detail
 
+constexpr std::size_t Fftw::kMaxRegisteredPlans;
+
 Fftw& Fftw::Instance() {
     static Fftw instance;
     return instance;
 }
 
-PlanSPtr Fftw::GetRealToComplexPlan(const Size& size, double* in,
-                                    fftw_complex* out) {
-    LOG("fftw", trace, "get r2c plan {}x{}", size.row, size.col);
+Fftw::Fftw() {
+    // fftw threads must be initialized before any plan creation
+    is_multithreading_available_ =
+          Traits<double>::InitThreads() && Traits<float>::InitThreads();
+    if (!is_multithreading_available_) {
+        LOG("fftw", warn, "cannot initialize FFTW threads");
+    }
+}
 
-#ifdef SIRIUS_ENABLE_CACHE_OPTIMIZATION
-    // cache version
-    auto r2c_plan = r2c_plans_.Get(size);
-    if (r2c_plan == nullptr) {
-        LOG("fftw", trace, "cache r2c plan {}x{}", size.row, size.col);
-        r2c_plan = CreateR2CPlan(size, in, out);
-        r2c_plans_.Insert(size, r2c_plan);
+void Fftw::SetThreadCount(int thread_count) {
+    thread_count = std::max(thread_count, 1);
+    if (thread_count > 1 && !is_multithreading_available_) {
+        LOG("fftw", warn,
+            "FFTW threads are not available, plans will be monothreaded");
+        thread_count = 1;
     }
-#else
-    // no cache version
-    auto r2c_plan = CreateR2CPlan(size, in, out);
-#endif  // SIRIUS_ENABLE_CACHE_OPTIMIZATION
+    LOG("fftw", debug, "plans created with {} threads", thread_count);
+    thread_count_ = thread_count;
+}
+
+void Fftw::SetPlanningRigor(PlanningRigor rigor) {
+    if (rigor == planning_rigor_) {
+        return;
+    }
+
+    LOG("fftw", debug, "planning rigor set to {}", static_cast<int>(rigor));
+    planning_rigor_ = rigor;
 
-    return r2c_plan;
+    // release plans created with the previous rigor
+    ReleasePlans();
+}
+
+void Fftw::ReleasePlans() {
+    // plans are destroyed outside of the lock because their deleter takes
+    // plan_mutex_
+    PlanRegistry<double> old_double_plans;
+    PlanRegistry<float> old_float_plans;
+    {
+        std::lock_guard<std::mutex> lock(plan_mutex_);
+        std::swap(old_double_plans, double_plans_);
+        std::swap(old_float_plans, float_plans_);
+        ++generation_;
+    }
+    LOG("fftw", debug, "{} plans released",
+        old_double_plans.size() + old_float_plans.size());
+}
+
+std::size_t Fftw::registered_plan_count() {
+    std::lock_guard<std::mutex> lock(plan_mutex_);
+    return double_plans_.size() + float_plans_.size();
+}
+
+bool Fftw::ImportWisdom(const std::string& filepath) {
+    std::lock_guard<std::mutex> lock(plan_mutex_);
+    std::string float_filepath = filepath + kFloatWisdomSuffix;
+    bool double_imported = Traits<double>::ImportWisdom(filepath.c_str());
+    bool float_imported = Traits<float>::ImportWisdom(float_filepath.c_str());
+    if (double_imported) {
+        LOG("fftw", info, "double precision wisdom imported from {}",
+            filepath);
+    }
+    if (float_imported) {
+        LOG("fftw", info, "single precision wisdom imported from {}",
+            float_filepath);
+    }
+    if (!double_imported && !float_imported) {
+        LOG("fftw", warn, "no wisdom could be imported from {}", filepath);
+    }
+    return double_imported || float_imported;
+}
+
+bool Fftw::ExportWisdom(const std::string& filepath) {
+    std::lock_guard<std::mutex> lock(plan_mutex_);
+    std::string float_filepath = filepath + kFloatWisdomSuffix;
+    bool double_exported = Traits<double>::ExportWisdom(filepath.c_str());
+    bool float_exported = Traits<float>::ExportWisdom(float_filepath.c_str());
+    if (!double_exported || !float_exported) {
+        LOG("fftw", error, "cannot export wisdom into {}", filepath);
+        return false;
+    }
+    LOG("fftw", info, "wisdom exported into {}", filepath);
+    return true;
+}
+
+unsigned Fftw::PlannerFlags() const {
+    switch (planning_rigor_) {
+        case PlanningRigor::kMeasure:
+            return FFTW_MEASURE;
+        case PlanningRigor::kPatient:
+            return FFTW_PATIENT;
+        case PlanningRigor::kExhaustive:
+            return FFTW_EXHAUSTIVE;
+        case PlanningRigor::kEstimate:
+        default:
+            return FFTW_ESTIMATE;
+    }
 }
 
-PlanSPtr Fftw::GetComplexToRealPlan(const Size& size, fftw_complex* in,
-                                    double* out) {
+bool Fftw::PlanKey::operator<(const PlanKey& rhs) const {
+    return std::tie(size, direction, flags, thread_count, in_alignment,
+                    out_alignment, batch_count) <
+           std::tie(rhs.size, rhs.direction, rhs.flags, rhs.thread_count,
+                    rhs.in_alignment, rhs.out_alignment, rhs.batch_count);
+}
+
+template <>
+Fftw::PlanRegistry<double>& Fftw::Registry<double>() {
+    return double_plans_;
+}
+
+template <>
+Fftw::PlanRegistry<float>& Fftw::Registry<float>() {
+    return float_plans_;
+}
+
+template <typename T>
+Fftw::LocalPlanCache<T>& Fftw::LocalCache() {
+    static thread_local LocalPlanCache<T> local_cache;
+    return local_cache;
+}
+
+template <typename T>
+BasicPlanSPtr<T> Fftw::GetRealToComplexPlan(const Size& size, T* in,
+                                            BasicComplex<T>* out) {
+    LOG("fftw", trace, "get r2c plan {}x{}", size.row, size.col);
+    PlanKey key{size,
+                PlanDirection::kRealToComplex,
+                PlannerFlags(),
+                thread_count_,
+                Traits<T>::AlignmentOf(in),
+                Traits<T>::AlignmentOf(reinterpret_cast<T*>(out))};
+    return GetPlan<T>(key, in, out);
+}
+
+template <typename T>
+BasicPlanSPtr<T> Fftw::GetComplexToRealPlan(const Size& size,
+                                            BasicComplex<T>* in, T* out) {
     LOG("fftw", trace, "get c2r plan {}x{}", size.row, size.col);
+    PlanKey key{size,
+                PlanDirection::kComplexToReal,
+                PlannerFlags(),
+                thread_count_,
+                Traits<T>::AlignmentOf(reinterpret_cast<T*>(in)),
+                Traits<T>::AlignmentOf(out)};
+    return GetPlan<T>(key, out, in);
+}
 
+template <typename T>
+BasicPlanSPtr<T> Fftw::GetColumnsInversePlan(const Size& size,
+                                             BasicComplex<T>* data) {
+    LOG("fftw", trace, "get columns c2c plan {}x{}", size.row, size.col);
+    int alignment = Traits<T>::AlignmentOf(reinterpret_cast<T*>(data));
+    PlanKey key{size,
+                PlanDirection::kColumnsComplexToComplex,
+                PlannerFlags(),
+                thread_count_,
+                alignment,
+                alignment};
+    return GetPlan<T>(key, nullptr, data);
+}
+
+template <typename T>
+BasicPlanSPtr<T> Fftw::GetRowsComplexToRealPlan(const Size& size,
+                                                BasicComplex<T>* in, T* out) {
+    LOG("fftw", trace, "get rows c2r plan {}x{}", size.row, size.col);
+    PlanKey key{size,
+                PlanDirection::kRowsComplexToReal,
+                PlannerFlags() | FFTW_PRESERVE_INPUT,
+                thread_count_,
+                Traits<T>::AlignmentOf(reinterpret_cast<T*>(in)),
+                Traits<T>::AlignmentOf(out)};
+    return GetPlan<T>(key, out, in);
+}
+
+template <typename T>
+BasicPlanSPtr<T> Fftw::GetRealToComplexBatchPlan(const Size& size,
+                                                 int batch_count, T* in,
+                                                 BasicComplex<T>* out) {
+    LOG("fftw", trace, "get r2c plan {}x{}x{}", batch_count, size.row,
+        size.col);
+    PlanKey key{size,
+                PlanDirection::kBatchRealToComplex,
+                PlannerFlags(),
+                thread_count_,
+                Traits<T>::AlignmentOf(in),
+                Traits<T>::AlignmentOf(reinterpret_cast<T*>(out)),
+                batch_count};
+    return GetPlan<T>(key, in, out);
+}
+
+template <typename T>
+BasicPlanSPtr<T> Fftw::GetPlan(const PlanKey& key, T* real,
+                               BasicComplex<T>* complex) {
 #ifdef SIRIUS_ENABLE_CACHE_OPTIMIZATION
     // cache version
-    auto c2r_plan = c2r_plans_.Get(size);
-    if (c2r_plan == nullptr) {
-        LOG("fftw", trace, "cache c2r plan {}x{}", size.row, size.col);
-        c2r_plan = CreateC2RPlan(size, in, out);
-        c2r_plans_.Insert(size, c2r_plan);
+    // fast path: lock free lookup in the thread local cache
+    auto& local_cache = LocalCache<T>();
+    auto generation = generation_.load();
+    if (local_cache.generation != generation) {
+        local_cache.plans.clear();
+        local_cache.generation = generation;
+    }
+    auto local_it = local_cache.plans.find(key);
+    if (local_it != local_cache.plans.end()) {
+        return local_it->second;
     }
+
+    // slow path: fetch the plan from the shared registry or create it.
+    // The evicted plan is destroyed outside of the lock because its deleter
+    // takes plan_mutex_
+    BasicPlanSPtr<T> plan;
+    BasicPlanSPtr<T> evicted_plan;
+    {
+        std::lock_guard<std::mutex> lock(plan_mutex_);
+        auto& registry = Registry<T>();
+        auto it = registry.find(key);
+        if (it == registry.end()) {
+            if (registry.size() >= kMaxRegisteredPlans) {
+                // local caches are dropped so that they release the evicted
+                // plan. Plans still in use are fetched again from the
+                // registry, which refreshes their last fetch
+                auto lru_it = std::min_element(
+                      registry.begin(), registry.end(),
+                      [](const typename PlanRegistry<T>::value_type& lhs,
+                         const typename PlanRegistry<T>::value_type& rhs) {
+                          return lhs.second.last_fetch < rhs.second.last_fetch;
+                      });
+                LOG("fftw", trace, "evict plan {}x{}", lru_it->first.size.row,
+                    lru_it->first.size.col);
+                evicted_plan = std::move(lru_it->second.plan);
+                registry.erase(lru_it);
+                ++generation_;
+            }
+            LOG("fftw", trace, "cache plan {}x{}", key.size.row,
+                key.size.col);
+            RegisteredPlan<T> registered_plan{
+                  CreatePlan<T>(key, real, complex)};
+            it = registry.emplace(key, std::move(registered_plan)).first;
+        }
+        it->second.last_fetch = ++registry_clock_;
+        plan = it->second.plan;
+    }
+    local_cache.plans.emplace(key, plan);
+    return plan;
 #else
     // no cache version
-    auto c2r_plan = CreateC2RPlan(size, in, out);
+    std::lock_guard<std::mutex> lock(plan_mutex_);
+    return CreatePlan<T>(key, real, complex);
 #endif  // SIRIUS_ENABLE_CACHE_OPTIMIZATION
-
-    return c2r_plan;
 }
 
-PlanSPtr Fftw::CreateC2RPlan(const Size& size, fftw_complex* in, double* out) {
-    std::lock_guard<std::mutex> lock(plan_mutex_);
-    PlanSPtr c2r_plan(
-          fftw_plan_dft_c2r_2d(size.row, size.col, in, out, FFTW_ESTIMATE),
-          detail::PlanDeleter());
-    if (c2r_plan == nullptr) {
-        LOG("fftw", error, "cannot create c2r plan {}x{}", size.row, size.row);
-        throw Exception(fftw::ErrorCode::kPlanCreationFailed);
+template <typename T>
+BasicPlanSPtr<T> Fftw::CreatePlan(const PlanKey& key, T* real,
+                                  BasicComplex<T>* complex) {
+    const auto& size = key.size;
+    bool is_columns =
+          (key.direction == PlanDirection::kColumnsComplexToComplex);
+    int real_count = size.CellCount() * key.batch_count;
+    int complex_count =
+          is_columns ? size.CellCount()
+                     : size.row * (size.col / 2 + 1) * key.batch_count;
+
+    // measuring planners overwrite the arrays they plan on: plan on scratch
+    // arrays with the same alignment and execute the plan later with the
+    // new-array execute API
+    BasicRealUPtr<T> scratch_real;
+    BasicComplexUPtr<T> scratch_complex;
+    if ((key.flags & FFTW_ESTIMATE) == 0) {
+        bool is_r2c = (key.direction == PlanDirection::kRealToComplex ||
+                       key.direction == PlanDirection::kBatchRealToComplex);
+        int real_alignment = is_r2c ? key.in_alignment : key.out_alignment;
+        int complex_alignment = is_r2c ? key.out_alignment : key.in_alignment;
+        if (!is_columns) {
+            scratch_real.reset(Traits<T>::AllocReal(
+                  real_count + kMaxAlignmentOffset / sizeof(T)));
+        }
+        scratch_complex.reset(Traits<T>::AllocComplex(
+              complex_count + kMaxAlignmentOffset / sizeof(BasicComplex<T>)));
+        if ((!is_columns && scratch_real == nullptr) ||
+            scratch_complex == nullptr) {
+            LOG("fftw", error, "not enough memory to plan {}x{}", size.row,
+                size.col);
+            throw Exception(fftw::ErrorCode::kMemoryAllocationFailed);
+        }
+        if (!is_columns) {
+            real = OffsetArray(scratch_real.get(), real_alignment);
+        }
+        complex = OffsetArray(scratch_complex.get(), complex_alignment);
     }
-    return c2r_plan;
-}
 
-PlanSPtr Fftw::CreateR2CPlan(const Size& size, double* in, fftw_complex* out) {
-    std::lock_guard<std::mutex> lock(plan_mutex_);
-    PlanSPtr r2c_plan(
-          fftw_plan_dft_r2c_2d(size.row, size.col, in, out, FFTW_ESTIMATE),
-          detail::PlanDeleter());
-    if (r2c_plan == nullptr) {
-        LOG("fftw", error, "cannot create r2c plan {}x{}", size.row, size.row);
+    if (is_multithreading_available_) {
+        Traits<T>::PlanWithNThreads(key.thread_count);
+    }
+
+    BasicPlanSPtr<T> plan;
+    switch (key.direction) {
+        case PlanDirection::kRealToComplex:
+            plan = {Traits<T>::PlanR2C(size.row, size.col, real, complex,
+                                       key.flags),
+                    detail::PlanDeleter<T>()};
+            break;
+        case PlanDirection::kComplexToReal:
+            plan = {Traits<T>::PlanC2R(size.row, size.col, complex, real,
+                                       key.flags),
+                    detail::PlanDeleter<T>()};
+            break;
+        case PlanDirection::kColumnsComplexToComplex:
+            plan = {Traits<T>::PlanColumnsBackwardC2C(size.row, size.col,
+                                                      complex, key.flags),
+                    detail::PlanDeleter<T>()};
+            break;
+        case PlanDirection::kRowsComplexToReal:
+            plan = {Traits<T>::PlanRowsC2R(size.row, size.col, complex, real,
+                                           key.flags),
+                    detail::PlanDeleter<T>()};
+            break;
+        case PlanDirection::kBatchRealToComplex:
+            plan = {Traits<T>::PlanBatchR2C(key.batch_count, size.row,
+                                            size.col, real, complex,
+                                            key.flags),
+                    detail::PlanDeleter<T>()};
+            break;
+    }
+    if (plan == nullptr) {
+        LOG("fftw", error, "cannot create plan {}x{}", size.row, size.col);
         throw Exception(fftw::ErrorCode::kPlanCreationFailed);
     }
-    return r2c_plan;
+    return plan;
 }
 
-void Fftw::DestroyPlan(::fftw_plan plan) {
+template <typename T>
+void Fftw::DestroyPlan(BasicPlan<T> plan) {
     if (plan == nullptr) {
         return;
     }
 
     std::lock_guard<std::mutex> lock(plan_mutex_);
-    ::fftw_destroy_plan(plan);
+    Traits<T>::DestroyPlan(plan);
 }
 
+template BasicPlanSPtr<double> Fftw::GetRealToComplexPlan<double>(
+      const Size& size, double* in, BasicComplex<double>* out);
+template BasicPlanSPtr<float> Fftw::GetRealToComplexPlan<float>(
+      const Size& size, float* in, BasicComplex<float>* out);
+template BasicPlanSPtr<double> Fftw::GetComplexToRealPlan<double>(
+      const Size& size, BasicComplex<double>* in, double* out);
+template BasicPlanSPtr<float> Fftw::GetComplexToRealPlan<float>(
+      const Size& size, BasicComplex<float>* in, float* out);
+template BasicPlanSPtr<double> Fftw::GetColumnsInversePlan<double>(
+      const Size& size, BasicComplex<double>* data);
+template BasicPlanSPtr<float> Fftw::GetColumnsInversePlan<float>(
+      const Size& size, BasicComplex<float>* data);
+template BasicPlanSPtr<double> Fftw::GetRowsComplexToRealPlan<double>(
+      const Size& size, BasicComplex<double>* in, double* out);
+template BasicPlanSPtr<float> Fftw::GetRowsComplexToRealPlan<float>(
+      const Size& size, BasicComplex<float>* in, float* out);
+template BasicPlanSPtr<double> Fftw::GetRealToComplexBatchPlan<double>(
+      const Size& size, int batch_count, double* in,
+      BasicComplex<double>* out);
+template BasicPlanSPtr<float> Fftw::GetRealToComplexBatchPlan<float>(
+      const Size& size, int batch_count, float* in, BasicComplex<float>* out);
+
+namespace detail {
+
+template struct PlanDeleter<double>;
+template struct PlanDeleter<float>;
+
+}  // namespace detail
+
 }  // namespace fftw
 }  // namespace sirius
@@ -22,69 +22,295 @@
 #ifndef SIRIUS_FFTW_FFTW_H_
 #define SIRIUS_FFTW_FFTW_H_
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <type_traits>
 
 #include "sirius/fftw/types.h"
 #include "sirius/image.h"
 #include "sirius/types.h"
 
-#include "sirius/utils/lru_cache.h"
-
 namespace sirius {
 namespace fftw {
 
+template <typename T>
+using BasicPlan = typename Traits<T>::Plan;
+
 namespace detail {
 
 /**
- * \brief Deleter of fftw_plan for smart pointer
+ * \brief Deleter of fftw plan for smart pointer
  */
+template <typename T>
 struct PlanDeleter {
-    void operator()(::fftw_plan plan);
+    void operator()(BasicPlan<T> plan);
 };
+
 }  // namespace detail
 
-using PlanUPtr =
-      std::unique_ptr<std::remove_pointer_t<::fftw_plan>, detail::PlanDeleter>;
-using PlanSPtr = std::shared_ptr<std::remove_pointer_t<::fftw_plan>>;
+template <typename T>
+using BasicPlanUPtr = std::unique_ptr<std::remove_pointer_t<BasicPlan<T>>,
+                                      detail::PlanDeleter<T>>;
+template <typename T>
+using BasicPlanSPtr = std::shared_ptr<std::remove_pointer_t<BasicPlan<T>>>;
+
+using PlanUPtr = BasicPlanUPtr<double>;
+using PlanSPtr = BasicPlanSPtr<double>;
+
+/**
+ * \brief FFTW planner rigor
+ */
+enum class PlanningRigor {
+    kEstimate = 0, /**< heuristic plans, no measurement (FFTW_ESTIMATE) */
+    kMeasure,      /**< measured plans (FFTW_MEASURE) */
+    kPatient,      /**< extensively measured plans (FFTW_PATIENT) */
+    kExhaustive    /**< exhaustively measured plans (FFTW_EXHAUSTIVE) */
+};
 
 /**
  * \brief fftw3 management class
  */
 class Fftw {
   private:
-    static constexpr int kCacheSize = 10;
-    using PlanCache = utils::LRUCache<Size, PlanSPtr, kCacheSize>;
+    /**
+     * \brief Plan direction
+     */
+    enum class PlanDirection {
+        kRealToComplex = 0,       /**< 2D r2c */
+        kComplexToReal,           /**< 2D c2r */
+        kColumnsComplexToComplex, /**< in-place backward 1D c2c on columns */
+        kRowsComplexToReal,       /**< 1D c2r on rows, input preserved */
+        kBatchRealToComplex       /**< 2D r2c of contiguous arrays */
+    };
+
+    /**
+     * \brief Plan identifier
+     *
+     * A plan can only be executed on new arrays of the same size and the same
+     * SIMD alignment as the arrays it was created on
+     */
+    struct PlanKey {
+        Size size;
+        PlanDirection direction;
+        unsigned flags;
+        int thread_count;
+        int in_alignment;
+        int out_alignment;
+        int batch_count = 1;
+
+        bool operator<(const PlanKey& rhs) const;
+    };
+
+    template <typename T>
+    using PlanMap = std::map<PlanKey, BasicPlanSPtr<T>>;
+
+    /**
+     * \brief Plan of the shared registry
+     */
+    template <typename T>
+    struct RegisteredPlan {
+        BasicPlanSPtr<T> plan;
+        // registry clock of the last fetch, the least recent is evicted
+        std::uint64_t last_fetch{0};
+    };
+
+    template <typename T>
+    using PlanRegistry = std::map<PlanKey, RegisteredPlan<T>>;
+
+    /**
+     * \brief Per-thread view on the shared plan registry
+     *
+     * Looked up without any lock. Dropped when the registry generation
+     * changes.
+     */
+    template <typename T>
+    struct LocalPlanCache {
+        std::uint64_t generation{0};
+        PlanMap<T> plans;
+    };
 
   public:
+    /**
+     * \brief Maximum number of plans registered per precision
+     *
+     * Beyond it, the least recently fetched plan is evicted and the per-thread
+     * caches are dropped, so that plans of the sizes which are no longer used
+     * (e.g. previous images of a batch) are released.
+     */
+    static constexpr std::size_t kMaxRegisteredPlans = 64;
+
     /**
      * \brief Get Fftw singleton instance
      * \return Fftw instance
      */
     static Fftw& Instance();
 
+    /**
+     * \brief Set the rigor of the FFTW planner
+     *
+     * Plans already registered are released so that next plans are created
+     * with the new rigor.
+     *
+     * \remark Measuring planners are slow the first time a size is planned.
+     *         Import a wisdom file to reuse the measurements of a previous run.
+     *
+     * \param rigor planner rigor
+     */
+    void SetPlanningRigor(PlanningRigor rigor);
+
+    /**
+     * \brief Release the registered plans
+     *
+     * Plans in use are destroyed once they are no longer referenced.
+     */
+    void ReleasePlans();
+
+    /**
+     * \brief Get the number of registered plans of both precisions
+     * \return plan count
+     */
+    std::size_t registered_plan_count();
+
+    /**
+     * \brief Get the rigor of the FFTW planner
+     * \return planner rigor
+     */
+    PlanningRigor planning_rigor() const { return planning_rigor_; }
+
+    /**
+     * \brief Set the number of threads used to execute next created plans
+     *
+     * Plans are cached per thread count.
+     *
+     * \remark Multithreaded plans should not be used when the FFTs are
+     *         already computed in parallel (e.g. stream mode workers)
+     *
+     * \param thread_count thread count (values lower than 1 are set to 1)
+     */
+    void SetThreadCount(int thread_count);
+
+    /**
+     * \brief Get the number of threads used to execute next created plans
+     * \return thread count
+     */
+    int thread_count() const { return thread_count_; }
+
+    /**
+     * \brief Import FFTW wisdom from a file
+     *
+     * Double precision wisdom is read from filepath, single precision wisdom
+     * is read from filepath with the ".f32" suffix
+     *
+     * \param filepath wisdom file path
+     * \return true if wisdom of at least one precision was imported
+     */
+    bool ImportWisdom(const std::string& filepath);
+
+    /**
+     * \brief Export accumulated FFTW wisdom into a file
+     *
+     * Double precision wisdom is written into filepath, single precision
+     * wisdom is written into filepath with the ".f32" suffix
+     *
+     * \param filepath wisdom file path
+     * \return true if both precisions were exported
+     */
+    bool ExportWisdom(const std::string& filepath);
+
     /**
      * \brief Get a r2c fftw plan of the given size
+     *
+     * \remark Once a plan is known by the calling thread, this method does
+     *         not take any lock
+     *
+     * \param size plan size
      * \param in real input array complying with the size
      * \param out complex output array complying with the size
      * \return unique ptr to the created plan
      * \throws sirius::fftw::Exception if the plan creation fails
      */
-    PlanSPtr GetRealToComplexPlan(const Size& size, double* in,
-                                  fftw_complex* out);
+    template <typename T>
+    BasicPlanSPtr<T> GetRealToComplexPlan(const Size& size, T* in,
+                                          BasicComplex<T>* out);
     /**
      * \brief Get a c2r fftw plan of the given size
+     *
+     * \remark Once a plan is known by the calling thread, this method does
+     *         not take any lock
+     *
      * \param size plan size
      * \param in complex input array complying with the size
      * \param out real output array complying with the size
      * \throws sirius::fftw::Exception if the plan creation fails
      */
-    PlanSPtr GetComplexToRealPlan(const Size& size, fftw_complex* in,
-                                  double* out);
+    template <typename T>
+    BasicPlanSPtr<T> GetComplexToRealPlan(const Size& size,
+                                          BasicComplex<T>* in, T* out);
+
+    /**
+     * \brief Get a plan computing in-place backward 1D complex FFTs on each
+     *        column of a complex array
+     *
+     * \remark Once a plan is known by the calling thread, this method does
+     *         not take any lock
+     *
+     * \param size complex array size (FFT length is size.row)
+     * \param data complex array complying with the size
+     * \return shared ptr to the plan (execute with Traits<T>::ExecuteC2C)
+     * \throws sirius::fftw::Exception if the plan creation fails
+     */
+    template <typename T>
+    BasicPlanSPtr<T> GetColumnsInversePlan(const Size& size,
+                                           BasicComplex<T>* data);
+
+    /**
+     * \brief Get a plan computing 1D c2r FFTs on each row of an array
+     *
+     * Input rows have size.col / 2 + 1 complex values and are preserved by
+     * the transform.
+     *
+     * \remark Once a plan is known by the calling thread, this method does
+     *         not take any lock
+     *
+     * \param size real output array size (FFT length is size.col)
+     * \param in complex input array complying with the size
+     * \param out real output array complying with the size
+     * \return shared ptr to the plan (execute with Traits<T>::ExecuteC2R)
+     * \throws sirius::fftw::Exception if the plan creation fails
+     */
+    template <typename T>
+    BasicPlanSPtr<T> GetRowsComplexToRealPlan(const Size& size,
+                                              BasicComplex<T>* in, T* out);
+
+    /**
+     * \brief Get a plan computing the 2D r2c FFTs of contiguous real arrays
+     *
+     * Arrays of the batch are stored one after the other, input arrays are
+     * size.CellCount() apart and output arrays are
+     * size.row * (size.col / 2 + 1) apart.
+     *
+     * \remark Once a plan is known by the calling thread, this method does
+     *         not take any lock
+     *
+     * \param size size of one real array
+     * \param batch_count number of arrays
+     * \param in real input arrays complying with the size and the count
+     * \param out complex output arrays complying with the size and the count
+     * \return shared ptr to the plan (execute with Traits<T>::ExecuteR2C)
+     * \throws sirius::fftw::Exception if the plan creation fails
+     */
+    template <typename T>
+    BasicPlanSPtr<T> GetRealToComplexBatchPlan(const Size& size,
+                                               int batch_count, T* in,
+                                               BasicComplex<T>* out);
 
   private:
-    Fftw() = default;
+    Fftw();
 
     // not copyable
     Fftw(const Fftw&) = delete;
@@ -93,18 +319,41 @@ class Fftw {
     Fftw(Fftw&&) = delete;
     Fftw operator=(Fftw&&) = delete;
 
-    PlanSPtr CreateC2RPlan(const Size& size, fftw_complex* in, double* out);
-    PlanSPtr CreateR2CPlan(const Size& size, double* out, fftw_complex* in);
+    template <typename T>
+    BasicPlanSPtr<T> GetPlan(const PlanKey& key, T* real,
+                             BasicComplex<T>* complex);
+
+    // plan_mutex_ must be held
+    template <typename T>
+    BasicPlanSPtr<T> CreatePlan(const PlanKey& key, T* real,
+                                BasicComplex<T>* complex);
+
+    template <typename T>
+    PlanRegistry<T>& Registry();
+
+    template <typename T>
+    static LocalPlanCache<T>& LocalCache();
+
+    unsigned PlannerFlags() const;
 
     // allow PlanDeleter operator() to access private DestroyPlan method
-    friend void detail::PlanDeleter::operator()(::fftw_plan);
-    void DestroyPlan(::fftw_plan plan);
+    template <typename T>
+    friend struct detail::PlanDeleter;
+
+    template <typename T>
+    void DestroyPlan(BasicPlan<T> plan);
 
   private:
+    // guards FFTW planner (not thread safe) and plan registries
     std::mutex plan_mutex_;
+    std::atomic<PlanningRigor> planning_rigor_{PlanningRigor::kEstimate};
+    std::atomic<int> thread_count_{1};
+    bool is_multithreading_available_{false};
+    std::atomic<std::uint64_t> generation_{1};
+    std::uint64_t registry_clock_{0};
 
-    PlanCache r2c_plans_;
-    PlanCache c2r_plans_;
+    PlanRegistry<double> double_plans_;
+    PlanRegistry<float> float_plans_;
 };
 
 }  // namespace fftw
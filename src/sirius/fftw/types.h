@@ -22,45 +22,196 @@
 #ifndef SIRIUS_FFTW_TYPES_H_
 #define SIRIUS_FFTW_TYPES_H_
 
+#include <cstddef>
+
 #include <memory>
 
 #include <fftw3.h>
 
+#include "sirius/utils/buffer_pool.h"
 #include "sirius/utils/log.h"
 
 namespace sirius {
 namespace fftw {
 
+/**
+ * \brief FFTW types and functions of a given sample precision
+ *
+ * double precision maps to fftw_* API, single precision maps to fftwf_* API
+ * Arrays are drawn from the buffer pool (aligned on kBufferAlignment bytes)
+ *
+ * \tparam T sample type (double or float)
+ */
+template <typename T>
+struct Traits;
+
+template <>
+struct Traits<double> {
+    using Real = double;
+    using Complex = ::fftw_complex;
+    using Plan = ::fftw_plan;
+
+    static Real* AllocReal(std::size_t n) {
+        return static_cast<Real*>(
+              utils::BufferPool::Instance().Allocate(n * sizeof(Real)));
+    }
+    static Complex* AllocComplex(std::size_t n) {
+        return static_cast<Complex*>(
+              utils::BufferPool::Instance().Allocate(n * sizeof(Complex)));
+    }
+    static void Free(void* p) { utils::BufferPool::Instance().Release(p); }
+    static int AlignmentOf(Real* p) { return ::fftw_alignment_of(p); }
+
+    static Plan PlanR2C(int n0, int n1, Real* in, Complex* out,
+                        unsigned flags) {
+        return ::fftw_plan_dft_r2c_2d(n0, n1, in, out, flags);
+    }
+    static Plan PlanC2R(int n0, int n1, Complex* in, Real* out,
+                        unsigned flags) {
+        return ::fftw_plan_dft_c2r_2d(n0, n1, in, out, flags);
+    }
+    static Plan PlanColumnsBackwardC2C(int n0, int n1, Complex* data,
+                                       unsigned flags) {
+        return ::fftw_plan_many_dft(1, &n0, n1, data, nullptr, n1, 1, data,
+                                  nullptr, n1, 1, FFTW_BACKWARD, flags);
+    }
+    static Plan PlanRowsC2R(int n0, int n1, Complex* in, Real* out,
+                            unsigned flags) {
+        return ::fftw_plan_many_dft_c2r(1, &n1, n0, in, nullptr, 1, n1 / 2 + 1,
+                                      out, nullptr, 1, n1, flags);
+    }
+    static Plan PlanBatchR2C(int batch_count, int n0, int n1, Real* in,
+                             Complex* out, unsigned flags) {
+        int n[2] = {n0, n1};
+        return ::fftw_plan_many_dft_r2c(2, n, batch_count, in, nullptr, 1,
+                                      n0 * n1, out, nullptr, 1,
+                                      n0 * (n1 / 2 + 1), flags);
+    }
+    static void ExecuteR2C(const Plan plan, Real* in, Complex* out) {
+        ::fftw_execute_dft_r2c(plan, in, out);
+    }
+    static void ExecuteC2R(const Plan plan, Complex* in, Real* out) {
+        ::fftw_execute_dft_c2r(plan, in, out);
+    }
+    static void ExecuteC2C(const Plan plan, Complex* in, Complex* out) {
+        ::fftw_execute_dft(plan, in, out);
+    }
+    static void DestroyPlan(Plan plan) { ::fftw_destroy_plan(plan); }
+    static bool InitThreads() { return ::fftw_init_threads() != 0; }
+    static void PlanWithNThreads(int thread_count) {
+        ::fftw_plan_with_nthreads(thread_count);
+    }
+    static bool ImportWisdom(const char* filepath) {
+        return ::fftw_import_wisdom_from_filename(filepath) != 0;
+    }
+    static bool ExportWisdom(const char* filepath) {
+        return ::fftw_export_wisdom_to_filename(filepath) != 0;
+    }
+};
+
+template <>
+struct Traits<float> {
+    using Real = float;
+    using Complex = ::fftwf_complex;
+    using Plan = ::fftwf_plan;
+
+    static Real* AllocReal(std::size_t n) {
+        return static_cast<Real*>(
+              utils::BufferPool::Instance().Allocate(n * sizeof(Real)));
+    }
+    static Complex* AllocComplex(std::size_t n) {
+        return static_cast<Complex*>(
+              utils::BufferPool::Instance().Allocate(n * sizeof(Complex)));
+    }
+    static void Free(void* p) { utils::BufferPool::Instance().Release(p); }
+    static int AlignmentOf(Real* p) { return ::fftwf_alignment_of(p); }
+
+    static Plan PlanR2C(int n0, int n1, Real* in, Complex* out,
+                        unsigned flags) {
+        return ::fftwf_plan_dft_r2c_2d(n0, n1, in, out, flags);
+    }
+    static Plan PlanC2R(int n0, int n1, Complex* in, Real* out,
+                        unsigned flags) {
+        return ::fftwf_plan_dft_c2r_2d(n0, n1, in, out, flags);
+    }
+    static Plan PlanColumnsBackwardC2C(int n0, int n1, Complex* data,
+                                       unsigned flags) {
+        return ::fftwf_plan_many_dft(1, &n0, n1, data, nullptr, n1, 1, data,
+                                   nullptr, n1, 1, FFTW_BACKWARD, flags);
+    }
+    static Plan PlanRowsC2R(int n0, int n1, Complex* in, Real* out,
+                            unsigned flags) {
+        return ::fftwf_plan_many_dft_c2r(1, &n1, n0, in, nullptr, 1, n1 / 2 + 1,
+                                       out, nullptr, 1, n1, flags);
+    }
+    static Plan PlanBatchR2C(int batch_count, int n0, int n1, Real* in,
+                             Complex* out, unsigned flags) {
+        int n[2] = {n0, n1};
+        return ::fftwf_plan_many_dft_r2c(2, n, batch_count, in, nullptr, 1,
+                                       n0 * n1, out, nullptr, 1,
+                                       n0 * (n1 / 2 + 1), flags);
+    }
+    static void ExecuteR2C(const Plan plan, Real* in, Complex* out) {
+        ::fftwf_execute_dft_r2c(plan, in, out);
+    }
+    static void ExecuteC2R(const Plan plan, Complex* in, Real* out) {
+        ::fftwf_execute_dft_c2r(plan, in, out);
+    }
+    static void ExecuteC2C(const Plan plan, Complex* in, Complex* out) {
+        ::fftwf_execute_dft(plan, in, out);
+    }
+    static void DestroyPlan(Plan plan) { ::fftwf_destroy_plan(plan); }
+    static bool InitThreads() { return ::fftwf_init_threads() != 0; }
+    static void PlanWithNThreads(int thread_count) {
+        ::fftwf_plan_with_nthreads(thread_count);
+    }
+    static bool ImportWisdom(const char* filepath) {
+        return ::fftwf_import_wisdom_from_filename(filepath) != 0;
+    }
+    static bool ExportWisdom(const char* filepath) {
+        return ::fftwf_export_wisdom_to_filename(filepath) != 0;
+    }
+};
+
+template <typename T>
+using BasicComplex = typename Traits<T>::Complex;
+
 namespace detail {
 
 /**
- * \brief Deleter of fftw_complex array for smart pointer
+ * \brief Deleter of fftw complex array for smart pointer
  */
+template <typename T>
 struct ComplexDeleter {
-    void operator()(::fftw_complex* complex) {
+    void operator()(BasicComplex<T>* complex) {
         if (complex == nullptr) {
             return;
         }
-        ::fftw_free(complex);
+        Traits<T>::Free(complex);
     }
 };
 
 /**
  * \brief Deleter of fftw real array for smart pointer
  */
+template <typename T>
 struct RealDeleter {
-    void operator()(double* real) { ::fftw_free(real); }
+    void operator()(T* real) { Traits<T>::Free(real); }
 };
 
 }  // namespace detail
 
-using ComplexUPtr = std::unique_ptr<::fftw_complex[], detail::ComplexDeleter>;
+template <typename T>
+using BasicComplexUPtr =
+      std::unique_ptr<BasicComplex<T>[], detail::ComplexDeleter<T>>;
+using ComplexUPtr = BasicComplexUPtr<double>;
 
 #if (!defined(__GNUC__) && __cplusplus <= 201402L) || \
       (defined(__GNUC__) && __GNUC__ < 7 && __cplusplus <= 201402L)
 
 // C++14: no shared_ptr array syntax, classic definition
-using ComplexSPtr = std::shared_ptr<::fftw_complex>;
+template <typename T>
+using BasicComplexSPtr = std::shared_ptr<BasicComplex<T>>;
 
 #else
 
@@ -76,12 +227,17 @@ using ComplexSPtr = std::shared_ptr<::fftw_complex>;
 //   std::shared_ptr<double[2]>::element_type <=> double
 //   std::shared_ptr<double[][2]>::element_type <=> double[2]
 
-using ComplexSPtr = std::shared_ptr<::fftw_complex[]>;
+template <typename T>
+using BasicComplexSPtr = std::shared_ptr<BasicComplex<T>[]>;
 
 #endif  // (!defined(__GNUC__) && __cplusplus <= 201402L) ||
         //   (defined(__GNUC__) && __GNUC__ < 7 && __cplusplus <= 201402L)
 
-using RealUPtr = std::unique_ptr<double[], detail::RealDeleter>;
+using ComplexSPtr = BasicComplexSPtr<double>;
+
+template <typename T>
+using BasicRealUPtr = std::unique_ptr<T[], detail::RealDeleter<T>>;
+using RealUPtr = BasicRealUPtr<double>;
 
 }  // namespace fftw
 }  // namespace sirius
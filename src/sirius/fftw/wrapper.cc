@@ -29,66 +29,153 @@
 namespace sirius {
 namespace fftw {
 
-ComplexUPtr CreateComplex(const Size& size) {
-    ComplexUPtr complex(fftw_alloc_complex(size.CellCount()));
-    if (complex == nullptr) {
+namespace {
+
+template <typename T>
+BasicRealUPtr<T> AllocateReal(const Size& size) {
+    BasicRealUPtr<T> real(Traits<T>::AllocReal(size.CellCount()));
+    if (real == nullptr) {
         LOG("fftw", critical,
-            "not enough memory to allocate complex of size {}x{}", size.row,
+            "not enough memory to allocate real of size {}x{}", size.row,
             size.col);
-        throw fftw::Exception(fftw::ErrorCode::kComplexAllocationFailed);
+        throw fftw::Exception(fftw::ErrorCode::kRealAllocationFailed);
     }
-    std::memset(complex.get(), 0, size.CellCount() * sizeof(fftw_complex));
-    return complex;
+    return real;
 }
 
-RealUPtr CreateReal(const Size& size) {
-    RealUPtr real(fftw_alloc_real(size.CellCount()));
-    if (real == nullptr) {
+}  // namespace
+
+template <typename T>
+BasicComplexUPtr<T> AllocateComplex(const Size& size) {
+    BasicComplexUPtr<T> complex(Traits<T>::AllocComplex(size.CellCount()));
+    if (complex == nullptr) {
         LOG("fftw", critical,
             "not enough memory to allocate complex of size {}x{}", size.row,
             size.col);
-        throw fftw::Exception(fftw::ErrorCode::kRealAllocationFailed);
+        throw fftw::Exception(fftw::ErrorCode::kComplexAllocationFailed);
     }
+    return complex;
+}
 
-    std::memset(real.get(), 0, size.CellCount() * sizeof(double));
-    return real;
+template <typename T>
+BasicComplexUPtr<T> CreateComplex(const Size& size) {
+    auto complex = AllocateComplex<T>(size);
+    std::memset(complex.get(), 0, size.CellCount() * sizeof(BasicComplex<T>));
+    return complex;
 }
 
-ComplexUPtr FFT(const Image& image) {
-    auto val_real = CreateReal(image.size);
-    std::memcpy(val_real.get(), image.data.data(),
-                image.size.CellCount() * sizeof(double));
+template <typename T>
+BasicRealUPtr<T> CreateReal(const Size& size) {
+    auto real = AllocateReal<T>(size);
+    std::memset(real.get(), 0, size.CellCount() * sizeof(T));
+    return real;
+}
 
-    return FFT(val_real.get(), image.size);
+template <typename T>
+BasicComplexUPtr<T> FFT(const BasicImage<T>& image) {
+    // out-of-place r2c transforms preserve their input (plans are created on
+    // scratch arrays) so the image buffer is transformed directly
+    return FFT(const_cast<T*>(image.data.data()), image.size);
 }
 
-ComplexUPtr FFT(double* values, const Size& size) {
-    auto fft = fftw::CreateComplex({size.row, size.col / 2 + 1});
+template <typename T>
+BasicComplexUPtr<T> FFT(T* values, const Size& size) {
+    // every cell of the output array is written by the transform
+    auto fft = AllocateComplex<T>({size.row, size.col / 2 + 1});
     auto fft_plan =
-          Fftw::Instance().GetRealToComplexPlan(size, values, fft.get());
+          Fftw::Instance().GetRealToComplexPlan<T>(size, values, fft.get());
 
-    fftw_execute_dft_r2c(fft_plan.get(), values, fft.get());
+    Traits<T>::ExecuteR2C(fft_plan.get(), values, fft.get());
 
     return fft;
 }
 
-Image IFFT(const Size& image_size, ComplexUPtr image_fft) {
-    auto zoomed_values = CreateReal(image_size);
+template <typename T>
+BasicImage<T> IFFT(const Size& image_size, BasicComplexUPtr<T> image_fft) {
+    // transform directly into the (uninitialized) image buffer
+    BasicImage<T> zoomed_image(
+          image_size, typename BasicImage<T>::Buffer(image_size.CellCount()));
 
     // fftw expects image_fft of size H*(W/2 +1) and needs output
     // dims to create ifft plan
-    auto ifft_plan = Fftw::Instance().GetComplexToRealPlan(
-          image_size, image_fft.get(), zoomed_values.get());
+    auto ifft_plan = Fftw::Instance().GetComplexToRealPlan<T>(
+          image_size, image_fft.get(), zoomed_image.data.data());
 
-    fftw_execute_dft_c2r(ifft_plan.get(), image_fft.get(), zoomed_values.get());
-
-    // store zoomed_values into image
-    Image zoomed_image(image_size);
-    std::memcpy(zoomed_image.data.data(), zoomed_values.get(),
-                zoomed_image.CellCount() * sizeof(double));
+    Traits<T>::ExecuteC2R(ifft_plan.get(), image_fft.get(),
+                          zoomed_image.data.data());
 
     return zoomed_image;
 }
 
+template <typename T>
+BasicComplexUPtr<T> BatchFFT(const std::vector<BasicImage<T>>& images) {
+    const Size& size = images.front().size;
+    int batch_count = images.size();
+    int cell_count = size.CellCount();
+
+    // batch plans need the images in a single array
+    auto values = AllocateReal<T>({size.row * batch_count, size.col});
+    for (int i = 0; i < batch_count; ++i) {
+        std::memcpy(values.get() + i * cell_count, images[i].data.data(),
+                    cell_count * sizeof(T));
+    }
+
+    // every cell of the output array is written by the transform
+    auto batch_fft =
+          AllocateComplex<T>({size.row * batch_count, size.col / 2 + 1});
+    auto fft_plan = Fftw::Instance().GetRealToComplexBatchPlan<T>(
+          size, batch_count, values.get(), batch_fft.get());
+
+    Traits<T>::ExecuteR2C(fft_plan.get(), values.get(), batch_fft.get());
+
+    return batch_fft;
+}
+
+template <typename T>
+std::vector<BasicImage<T>> BatchIFFT(const Size& image_size, int batch_count,
+                                     BasicComplexUPtr<T> batch_fft) {
+    int complex_count = image_size.row * (image_size.col / 2 + 1);
+    auto& fftw_instance = Fftw::Instance();
+
+    // a batch plan writes the images into a single array which would then be
+    // copied into the image buffers: transform each FFT of the batch directly
+    // into its (uninitialized) image buffer instead
+    std::vector<BasicImage<T>> images;
+    images.reserve(batch_count);
+    for (int i = 0; i < batch_count; ++i) {
+        images.emplace_back(image_size, typename BasicImage<T>::Buffer(
+                                              image_size.CellCount()));
+        BasicComplex<T>* image_fft = batch_fft.get() + i * complex_count;
+        T* image_values = images.back().data.data();
+        auto ifft_plan = fftw_instance.GetComplexToRealPlan<T>(
+              image_size, image_fft, image_values);
+        Traits<T>::ExecuteC2R(ifft_plan.get(), image_fft, image_values);
+    }
+    return images;
+}
+
+template ComplexUPtr AllocateComplex<double>(const Size& size);
+template BasicComplexUPtr<float> AllocateComplex<float>(const Size& size);
+template ComplexUPtr CreateComplex<double>(const Size& size);
+template BasicComplexUPtr<float> CreateComplex<float>(const Size& size);
+template RealUPtr CreateReal<double>(const Size& size);
+template BasicRealUPtr<float> CreateReal<float>(const Size& size);
+template ComplexUPtr FFT<double>(const Image& image);
+template BasicComplexUPtr<float> FFT<float>(const FloatImage& image);
+template ComplexUPtr FFT<double>(double* values, const Size& size);
+template BasicComplexUPtr<float> FFT<float>(float* values, const Size& size);
+template ComplexUPtr BatchFFT<double>(const std::vector<Image>& images);
+template BasicComplexUPtr<float> BatchFFT<float>(
+      const std::vector<FloatImage>& images);
+template std::vector<Image> BatchIFFT<double>(const Size& image_size,
+                                              int batch_count,
+                                              ComplexUPtr batch_fft);
+template std::vector<FloatImage> BatchIFFT<float>(
+      const Size& image_size, int batch_count,
+      BasicComplexUPtr<float> batch_fft);
+template Image IFFT<double>(const Size& image_size, ComplexUPtr image_fft);
+template FloatImage IFFT<float>(const Size& image_size,
+                                BasicComplexUPtr<float> image_fft);
+
 }  // namespace fftw
 }  // namespace sirius
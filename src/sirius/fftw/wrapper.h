@@ -22,6 +22,8 @@
 #ifndef SIRIUS_FFTW_WRAPPER_H_
 #define SIRIUS_FFTW_WRAPPER_H_
 
+#include <vector>
+
 #include <gsl/gsl>
 
 #include "sirius/image.h"
@@ -32,21 +34,32 @@
 namespace sirius {
 namespace fftw {
 
+/**
+ * \brief Create complex array without initializing its values
+ * \param size complex array size
+ * \return fftw complex unique ptr
+ * \throws sirius::fftw::Exception if the complex creation fails
+ */
+template <typename T = double>
+BasicComplexUPtr<T> AllocateComplex(const Size& size);
+
 /**
  * \brief Create complex array and initialize it to 0
  * \param size complex array size
- * \return fftw_complex unique ptr
+ * \return fftw complex unique ptr
  * \throws sirius::fftw::Exception if the complex creation fails
  */
-ComplexUPtr CreateComplex(const Size& size);
+template <typename T = double>
+BasicComplexUPtr<T> CreateComplex(const Size& size);
 
 /**
  * \brief Create real array and initialize it to 0
  * \param size real array size
- * \return double* unique ptr
+ * \return T* unique ptr
  * \throws sirius::fftw::Exception if the real creation fails
  */
-RealUPtr CreateReal(const Size& size);
+template <typename T = double>
+BasicRealUPtr<T> CreateReal(const Size& size);
 
 /**
  * \brief Compute the FFT of an image
@@ -54,7 +67,8 @@ RealUPtr CreateReal(const Size& size);
  * \return complex array unique ptr
  * \throws sirius::fftw::Exception if the computation of FFT failed
  */
-ComplexUPtr FFT(const Image& image);
+template <typename T>
+BasicComplexUPtr<T> FFT(const BasicImage<T>& image);
 
 /**
  * \brief Compute the FFT of real array
@@ -63,7 +77,8 @@ ComplexUPtr FFT(const Image& image);
  * \return complex array unique ptr
  * \throws sirius::fftw::Exception if the computation of FFT failed
  */
-ComplexUPtr FFT(double* values, const Size& size);
+template <typename T>
+BasicComplexUPtr<T> FFT(T* values, const Size& size);
 
 /**
  * \brief Compute the IFFT of an image FFT
@@ -72,7 +87,33 @@ ComplexUPtr FFT(double* values, const Size& size);
  * \return image
  * \throws sirius::fftw::Exception if the computation of IFFT failed
  */
-Image IFFT(const Size& image_size, ComplexUPtr image_fft);
+template <typename T>
+BasicImage<T> IFFT(const Size& image_size, BasicComplexUPtr<T> image_fft);
+
+/**
+ * \brief Compute the FFTs of a batch of images with a single plan
+ * \param images images of the same size
+ * \return complex array unique ptr, image FFTs stored one after the other
+ * \throws sirius::fftw::Exception if the computation of FFTs failed
+ */
+template <typename T>
+BasicComplexUPtr<T> BatchFFT(const std::vector<BasicImage<T>>& images);
+
+/**
+ * \brief Compute the IFFTs of a batch of image FFTs
+ *
+ * Each IFFT is computed directly into its image buffer with the c2r plan of
+ * the image size, so that images are not copied out of a batch array.
+ *
+ * \param image_size size of one image
+ * \param batch_count number of FFTs
+ * \param batch_fft image FFTs stored one after the other (cf. BatchFFT)
+ * \return images
+ * \throws sirius::fftw::Exception if the computation of IFFTs failed
+ */
+template <typename T>
+std::vector<BasicImage<T>> BatchIFFT(const Size& image_size, int batch_count,
+                                     BasicComplexUPtr<T> batch_fft);
 
 }  // namespace fftw
 }  // namespace sirius
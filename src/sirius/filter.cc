@@ -21,7 +21,11 @@
 
 #include "sirius/filter.h"
 
+#include <algorithm>
+#include <cmath>
+#include <complex>
 #include <cstring>
+#include <exception>
 
 #include "sirius/exception.h"
 #include "sirius/frequency_zoom_factory.h"
@@ -33,6 +37,7 @@
 
 #include "sirius/gdal/wrapper.h"
 
+#include "sirius/utils/complex_multiply.h"
 #include "sirius/utils/gsl.h"
 #include "sirius/utils/numeric.h"
 
@@ -43,9 +48,112 @@ Image ZoomFilterImageToInputResolution(const Image& filter_image,
 void NormalizeFilterImage(Image& filter_image, int oversampling);
 Image FrequencyShift(const Image& filter_image);
 
+namespace {
+
+/**
+ * \brief Compute the FFT of a kernel centered in a zero image
+ * \param kernel kernel image
+ * \param image_size size of the zero image
+ * \return kernel FFT
+ */
+template <typename T>
+fftw::BasicComplexUPtr<T> CreateKernelFFT(const Image& kernel,
+                                          const Size& image_size) {
+    LOG("filter", trace, "pad filter image");
+    // pad filter, remains in the center
+    // TODO: use Image.CreateZeroPaddedImage?
+    std::vector<T> filter_values(image_size.CellCount(), 0);
+    int lower_row = image_size.row / 2 - (kernel.size.row - 1) / 2;
+    int upper_row = image_size.row / 2 + (kernel.size.row - 1) / 2;
+    int lower_col = image_size.col / 2 - (kernel.size.col - 1) / 2;
+    int upper_col = image_size.col / 2 + (kernel.size.col - 1) / 2;
+
+    auto filter_values_span = gsl::as_multi_span(filter_values);
+    for (int row = lower_row; row <= upper_row; ++row) {
+        for (int col = lower_col; col <= upper_col; ++col) {
+            filter_values_span[row * image_size.col + col] = static_cast<T>(
+                  kernel.Get(row - lower_row, col - lower_col));
+        }
+    }
+
+    // filter must be unshifted in order to have zero frequency in top left
+    // corner. fft expects signal to be between 0 and Fe, not -Fe/2, Fe/2
+    LOG("filter", trace, "shift filter image");
+    auto shifted_values =
+          fftw::CreateReal<T>({image_size.row, image_size.col});
+    utils::IFFTShift2D(filter_values.data(), image_size, shifted_values.get());
+
+    LOG("filter", trace, "compute filter FFT");
+    return fftw::FFT(shifted_values.get(), image_size);
+}
+
+/**
+ * \brief Positive modulo
+ */
+inline int Wrap(int index, int count) {
+    return ((index % count) + count) % count;
+}
+
+/**
+ * \brief Circular convolution of an image with a kernel centered as in
+ *        CreateKernelFFT, in place
+ *
+ * Rows are extended by their circular continuation so that the inner loop
+ * runs on contiguous samples and is vectorized by the compiler. The extended
+ * rows are the only copy of the image: the buffer is reused by the caller
+ * across passes.
+ *
+ * \param kernel kernel image
+ * \param extended_rows work buffer
+ * \param image image to convolve
+ */
+template <typename T>
+void CircularConvolve(const Image& kernel, std::vector<T>& extended_rows,
+                      BasicImage<T>& image) {
+    // the kernel spectrum only holds an odd centered window of the kernel
+    int kernel_row_center = (kernel.size.row - 1) / 2;
+    int kernel_col_center = (kernel.size.col - 1) / 2;
+    int kernel_row_count = 2 * kernel_row_center + 1;
+    int kernel_col_count = 2 * kernel_col_center + 1;
+    const Size& size = image.size;
+
+    int extended_col_count = size.col + kernel_col_count - 1;
+    extended_rows.resize(size.row * extended_col_count);
+    for (int row = 0; row < size.row; ++row) {
+        const T* image_row = image.data.data() + row * size.col;
+        T* extended_row = extended_rows.data() + row * extended_col_count;
+        for (int col = 0; col < extended_col_count; ++col) {
+            extended_row[col] =
+                  image_row[Wrap(col - kernel_col_center, size.col)];
+        }
+    }
+
+    for (int row = 0; row < size.row; ++row) {
+        T* convolved_row = image.data.data() + row * size.col;
+        std::fill(convolved_row, convolved_row + size.col, T(0));
+        for (int i = 0; i < kernel_row_count; ++i) {
+            int source_row = Wrap(row - i + kernel_row_center, size.row);
+            const T* extended_row =
+                  extended_rows.data() + source_row * extended_col_count;
+            for (int j = 0; j < kernel_col_count; ++j) {
+                T weight = static_cast<T>(kernel.Get(i, j));
+                const T* source = extended_row + (kernel_col_count - 1 - j);
+                for (int col = 0; col < size.col; ++col) {
+                    convolved_row[col] += weight * source[col];
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+constexpr double Filter::kSeparableTolerance;
+
 Filter Filter::Create(const std::string& image_path,
                       const ZoomRatio& zoom_ratio, PaddingType padding_type,
-                      bool normalize) {
+                      bool normalize, double separable_tolerance,
+                      FilterEngine engine) {
     // load image
     auto filter_image = gdal::LoadImage(image_path);
 
@@ -56,16 +164,23 @@ Filter Filter::Create(const std::string& image_path,
     LOG("filter", info, "input filter size: {}x{}", filter_image.size.row,
         filter_image.size.col);
 
+    Filter filter;
     if (zoom_ratio.ratio() <= 1) {
-        return CreateZoomOutFilter(std::move(filter_image), zoom_ratio,
-                                   padding_type);
+        filter = CreateZoomOutFilter(std::move(filter_image), zoom_ratio,
+                                     padding_type);
     } else if (!zoom_ratio.IsRealZoom()) {
-        return CreateZoomInFilter(std::move(filter_image), zoom_ratio,
-                                  padding_type);
-    } else {
-        return CreateRealZoomFilter(std::move(filter_image), zoom_ratio,
+        filter = CreateZoomInFilter(std::move(filter_image), zoom_ratio,
                                     padding_type);
+    } else {
+        filter = CreateRealZoomFilter(std::move(filter_image), zoom_ratio,
+                                      padding_type);
     }
+
+    if (separable_tolerance >= 0) {
+        filter.DetectSeparableKernels(separable_tolerance);
+    }
+    filter.engine_ = engine;
+    return filter;
 }
 
 Filter::Filter(Image&& filter_image, const Size& padding_size,
@@ -74,19 +189,106 @@ Filter::Filter(Image&& filter_image, const Size& padding_size,
       padding_size_(padding_size),
       zoom_ratio_(zoom_ratio),
       padding_type_(padding_type),
-      filter_fft_cache_(std::make_unique<FilterFFTCache>()) {
+      filter_fft_cache_(std::make_unique<FilterFFTCache>()),
+      float_filter_fft_cache_(
+            std::make_unique<BasicFilterFFTCache<float>>()),
+      filter_spectra_(std::make_unique<BasicFilterSpectra<double>>()),
+      float_filter_spectra_(std::make_unique<BasicFilterSpectra<float>>()),
+      filter_rows_fft_cache_(
+            std::make_unique<BasicFilterRowsFFTCache<double>>()),
+      float_filter_rows_fft_cache_(
+            std::make_unique<BasicFilterRowsFFTCache<float>>()) {
     LOG("filter", info, "filter size: {}x{}", filter_.size.row,
         filter_.size.col);
     LOG("filter", info, "filter padding: {}x{}", padding_size_.row,
         padding_size_.col);
 }
 
-fftw::ComplexUPtr Filter::Process(const Size& image_size,
-                                  fftw::ComplexUPtr image_fft) const {
-    if (!IsLoaded()) {
-        return image_fft;
+void Filter::DetectSeparableKernels(double tolerance) {
+    const Size& size = filter_.size;
+    double filter_norm = 0;
+    std::size_t max_index = 0;
+    for (std::size_t i = 0; i < filter_.data.size(); ++i) {
+        filter_norm += filter_.data[i] * filter_.data[i];
+        if (std::abs(filter_.data[i]) > std::abs(filter_.data[max_index])) {
+            max_index = i;
+        }
+    }
+    if (filter_norm == 0) {
+        return;
+    }
+
+    // dominant singular vectors of the filter by power iteration, starting
+    // from the filter row of its largest coefficient
+    constexpr int kMaxIterationCount = 100;
+    std::vector<double> column_values(size.row, 0);
+    std::vector<double> row_values(
+          filter_.data.begin() + (max_index / size.col) * size.col,
+          filter_.data.begin() + (max_index / size.col + 1) * size.col);
+    double singular_value = 0;
+    for (int iteration = 0; iteration < kMaxIterationCount; ++iteration) {
+        double column_norm = 0;
+        for (int row = 0; row < size.row; ++row) {
+            column_values[row] = 0;
+            for (int col = 0; col < size.col; ++col) {
+                column_values[row] += filter_.Get(row, col) * row_values[col];
+            }
+            column_norm += column_values[row] * column_values[row];
+        }
+        column_norm = std::sqrt(column_norm);
+        for (auto& value : column_values) {
+            value /= column_norm;
+        }
+
+        double row_norm = 0;
+        for (int col = 0; col < size.col; ++col) {
+            row_values[col] = 0;
+            for (int row = 0; row < size.row; ++row) {
+                row_values[col] += filter_.Get(row, col) * column_values[row];
+            }
+            row_norm += row_values[col] * row_values[col];
+        }
+        row_norm = std::sqrt(row_norm);
+        for (auto& value : row_values) {
+            value /= row_norm;
+        }
+
+        bool is_converged =
+              std::abs(row_norm - singular_value) <= 1e-15 * row_norm;
+        singular_value = row_norm;
+        if (is_converged) {
+            break;
+        }
+    }
+
+    // residual of the rank-1 approximation
+    double residual_norm = 0;
+    for (int row = 0; row < size.row; ++row) {
+        for (int col = 0; col < size.col; ++col) {
+            double residual = filter_.Get(row, col) -
+                              singular_value * column_values[row] *
+                                    row_values[col];
+            residual_norm += residual * residual;
+        }
+    }
+    double relative_residual = std::sqrt(residual_norm / filter_norm);
+    if (relative_residual > tolerance) {
+        LOG("filter", debug, "filter is not separable (residual: {:.3e})",
+            relative_residual);
+        return;
+    }
+
+    column_kernel_ = Image({size.row, 1});
+    for (int row = 0; row < size.row; ++row) {
+        column_kernel_.data[row] = singular_value * column_values[row];
     }
+    row_kernel_ = Image({1, size.col});
+    row_kernel_.data.assign(row_values.begin(), row_values.end());
+    LOG("filter", info, "separable filter (residual: {:.3e})",
+        relative_residual);
+}
 
+void Filter::CheckImageSize(const Size& image_size) const {
     if (image_size.row < filter_.size.row ||
         image_size.col < filter_.size.col) {
         LOG("filter", error,
@@ -94,74 +296,374 @@ fftw::ComplexUPtr Filter::Process(const Size& image_size,
             filter_.size.row, filter_.size.col, image_size.row, image_size.col);
         throw SiriusException("filter is too large to be applied on the image");
     }
+}
+
+bool Filter::UseDirectConvolution(const Size& image_size,
+                                  int pruned_zoom) const {
+    if (!IsLoaded()) {
+        return false;
+    }
+    if (engine_ != FilterEngine::kAuto) {
+        return engine_ == FilterEngine::kDirect;
+    }
 
-    int filter_fft_row = image_size.row;
-    int filter_fft_col = (image_size.col / 2 + 1);
-    int filter_fft_count = filter_fft_row * filter_fft_col;
+    // costs per pixel, in multiply-adds. These are estimates, not measures:
+    // they only let the smallest kernels go direct, which is why kAuto is
+    // not the default engine
+    constexpr double kSpectralProductCost = 3.;
+    constexpr double kIFFTCostPerLog2 = 1.25;
+    int row_tap_count = 2 * ((filter_.size.row - 1) / 2) + 1;
+    int col_tap_count = 2 * ((filter_.size.col - 1) / 2) + 1;
+    int tap_count = IsSeparable() ? row_tap_count + col_tap_count
+                                  : row_tap_count * col_tap_count;
+    // the pruned IFFT only transforms 1 / pruned_zoom of the columns
+    double saved_ifft_cost =
+          (1. - 1. / std::max(pruned_zoom, 1)) * kIFFTCostPerLog2 *
+          std::log2(std::max(image_size.row, 1));
+    return tap_count <= kSpectralProductCost + saved_ifft_cost;
+}
 
-#ifdef SIRIUS_ENABLE_CACHE_OPTIMIZATION
-    // cache version
-    auto filter_fft = filter_fft_cache_->Get(image_size);
-    if (filter_fft == nullptr) {
-        // create filter fft and cache it
-        LOG("filter", trace, "cache filter fft for image {}x{}", image_size.row,
-            image_size.col);
-        fftw::ComplexUPtr uptr_filter_fft = CreateFilterFFT(image_size);
-        filter_fft = {std::move(uptr_filter_fft)};
-        filter_fft_cache_->Insert(image_size, filter_fft);
+template <typename T>
+void Filter::Convolve(BasicImage<T>& image) const {
+    if (!IsLoaded()) {
+        return;
     }
-#else
-    // no cache version
-    fftw::ComplexSPtr filter_fft{std::move(CreateFilterFFT(image_size))};
-#endif  // SIRIUS_ENABLE_CACHE_OPTIMIZATION
+    CheckImageSize(image.size);
+
+    LOG("filter", trace, "convolve image {}x{} with filter {}x{}",
+        image.size.row, image.size.col, filter_.size.row, filter_.size.col);
+    // widest extension: row pass of a separable filter or full kernel
+    std::vector<T> extended_rows;
+    extended_rows.reserve(image.size.row *
+                          (image.size.col + filter_.size.col - 1));
+    if (IsSeparable()) {
+        CircularConvolve(column_kernel_, extended_rows, image);
+        CircularConvolve(row_kernel_, extended_rows, image);
+    } else {
+        CircularConvolve(filter_, extended_rows, image);
+    }
+}
 
-    auto image_fft_span = utils::MakeSmartPtrArraySpan(image_fft, image_size);
-    auto filter_fft_span = utils::MakeSmartPtrArraySpan(filter_fft, image_size);
+template <typename T>
+void Filter::ProcessRows(const Size& image_size, const std::vector<int>& rows,
+                         int col_count, fftw::BasicComplex<T>* fft) const {
+    if (!IsLoaded()) {
+        return;
+    }
+
+    LOG("filter", trace, "apply filter {}x{} on {} rows of image FFT {}x{}",
+        filter_.size.row, filter_.size.col, rows.size(), image_size.row,
+        image_size.col);
+    if (!IsSeparable()) {
+        auto filter_fft = GetFilterRowsFFT<T>(image_size, rows, col_count);
+        utils::MultiplyComplex(reinterpret_cast<T*>(fft),
+                               reinterpret_cast<const T*>(filter_fft.get()),
+                               rows.size() * col_count);
+        return;
+    }
+
+    // separable spectra are already 1D: expand their outer product on the
+    // rows of the compact spectrum
+    auto filter_fft = GetFilterFFT<T>(image_size);
+    const auto* row_fft = filter_fft.get() + image_size.row;
+    auto row_filter_fft = fftw::CreateComplex<T>({1, col_count});
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        const auto& column_value = filter_fft.get()[rows[i]];
+        for (int col = 0; col < col_count; ++col) {
+            row_filter_fft.get()[col][0] = column_value[0] * row_fft[col][0] -
+                                           column_value[1] * row_fft[col][1];
+            row_filter_fft.get()[col][1] = column_value[0] * row_fft[col][1] +
+                                           column_value[1] * row_fft[col][0];
+        }
+        utils::MultiplyComplex(
+              reinterpret_cast<T*>(fft + i * col_count),
+              reinterpret_cast<const T*>(row_filter_fft.get()), col_count);
+    }
+}
+
+int Filter::SpectrumCellCount(const Size& image_size) const {
+    if (IsSeparable()) {
+        // column spectrum followed by the row spectrum
+        return image_size.row + image_size.col / 2 + 1;
+    }
+    return image_size.row * (image_size.col / 2 + 1);
+}
+
+template <>
+Filter::BasicFilterFFTCache<double>& Filter::FFTCache<double>() const {
+    return *filter_fft_cache_;
+}
+
+template <>
+Filter::BasicFilterFFTCache<float>& Filter::FFTCache<float>() const {
+    return *float_filter_fft_cache_;
+}
+
+template <>
+Filter::BasicFilterRowsFFTCache<double>& Filter::RowsFFTCache<double>()
+      const {
+    return *filter_rows_fft_cache_;
+}
+
+template <>
+Filter::BasicFilterRowsFFTCache<float>& Filter::RowsFFTCache<float>() const {
+    return *float_filter_rows_fft_cache_;
+}
+
+template <>
+Filter::BasicFilterSpectra<double>& Filter::Spectra<double>() const {
+    return *filter_spectra_;
+}
+
+template <>
+Filter::BasicFilterSpectra<float>& Filter::Spectra<float>() const {
+    return *float_filter_spectra_;
+}
+
+template <typename T>
+void Filter::PrepareSpectra(const std::vector<Size>& image_sizes) const {
+    if (!IsLoaded()) {
+        return;
+    }
+
+    auto& filter_spectra = Spectra<T>();
+    std::size_t prepared_count = 0;
+    for (const auto& image_size : image_sizes) {
+        if (filter_spectra.count(image_size) > 0) {
+            continue;
+        }
+        if (image_size.row < filter_.size.row ||
+            image_size.col < filter_.size.col) {
+            // Process will report the error if this size is ever requested
+            LOG("filter", debug, "skip filter spectrum for image {}x{}",
+                image_size.row, image_size.col);
+            continue;
+        }
+        filter_spectra[image_size] =
+              fftw::BasicComplexSPtr<T>{CreateFilterFFT<T>(image_size)};
+        ++prepared_count;
+    }
 
-    // apply filter on image (filter x image)
-    //(a+ib)*(a'+ib') = (aa'-bb')+i(ab'+ba')
-    LOG("filter", trace, "apply filter {}x{} on image FFT {}x{}",
-        filter_.size.row, filter_.size.col, image_size.row, image_size.col);
-    for (int fft_index = 0; fft_index < filter_fft_count; ++fft_index) {
-        image_fft_span[fft_index][0] =
-              filter_fft_span[fft_index][0] * image_fft_span[fft_index][0] -
-              filter_fft_span[fft_index][1] * image_fft_span[fft_index][1];
-        image_fft_span[fft_index][1] =
-              filter_fft_span[fft_index][0] * image_fft_span[fft_index][1] +
-              filter_fft_span[fft_index][1] * image_fft_span[fft_index][0];
+    std::size_t spectra_bytes = 0;
+    for (const auto& filter_spectrum : filter_spectra) {
+        spectra_bytes += SpectrumCellCount(filter_spectrum.first) *
+                         sizeof(fftw::BasicComplex<T>);
+    }
+    LOG("filter", info, "{} filter spectra prepared, {} available ({:.1f} MiB)",
+        prepared_count, filter_spectra.size(),
+        spectra_bytes / (1024.0 * 1024.0));
+}
+
+template <typename T>
+fftw::BasicComplexUPtr<T> Filter::Process(
+      const Size& image_size, fftw::BasicComplexUPtr<T> image_fft) const {
+    if (!IsLoaded()) {
+        return image_fft;
     }
 
+    ProcessBatch<T>(image_size, 1, image_fft.get());
     return image_fft;
 }
 
-fftw::ComplexUPtr Filter::CreateFilterFFT(const Size& image_size) const {
-    LOG("filter", trace, "pad filter image");
-    // pad filter, remains in the center
-    // TODO: use Image.CreateZeroPaddedImage?
-    std::vector<double> filter_values(image_size.CellCount(), 0);
-    int lower_row = image_size.row / 2 - (filter_.size.row - 1) / 2;
-    int upper_row = image_size.row / 2 + (filter_.size.row - 1) / 2;
-    int lower_col = image_size.col / 2 - (filter_.size.col - 1) / 2;
-    int upper_col = image_size.col / 2 + (filter_.size.col - 1) / 2;
+template <typename T>
+void Filter::ProcessBatch(const Size& image_size, int batch_count,
+                          fftw::BasicComplex<T>* batch_fft) const {
+    if (!IsLoaded()) {
+        return;
+    }
 
-    auto filter_values_span = gsl::as_multi_span(filter_values);
-    for (int row = lower_row; row <= upper_row; ++row) {
-        for (int col = lower_col; col <= upper_col; ++col) {
-            filter_values_span[row * image_size.col + col] =
-                  filter_.Get(row - lower_row, col - lower_col);
+    auto filter_fft = GetFilterFFT<T>(image_size);
+    int fft_col_count = image_size.col / 2 + 1;
+    int filter_fft_count = image_size.row * fft_col_count;
+
+    // apply filter on images (filter x image)
+    LOG("filter", trace, "apply filter {}x{} on {} image FFTs {}x{}",
+        filter_.size.row, filter_.size.col, batch_count, image_size.row,
+        image_size.col);
+    if (IsSeparable()) {
+        // expand the outer product of the column and row spectra row by row
+        const auto* column_fft = filter_fft.get();
+        const auto* row_fft = filter_fft.get() + image_size.row;
+        auto row_filter_fft = fftw::CreateComplex<T>({1, fft_col_count});
+        for (int row = 0; row < image_size.row; ++row) {
+            for (int col = 0; col < fft_col_count; ++col) {
+                row_filter_fft.get()[col][0] =
+                      column_fft[row][0] * row_fft[col][0] -
+                      column_fft[row][1] * row_fft[col][1];
+                row_filter_fft.get()[col][1] =
+                      column_fft[row][0] * row_fft[col][1] +
+                      column_fft[row][1] * row_fft[col][0];
+            }
+            for (int i = 0; i < batch_count; ++i) {
+                utils::MultiplyComplex(
+                      reinterpret_cast<T*>(batch_fft + i * filter_fft_count +
+                                           row * fft_col_count),
+                      reinterpret_cast<const T*>(row_filter_fft.get()),
+                      fft_col_count);
+            }
         }
+        return;
     }
 
-    // filter must be unshifted in order to have zero frequency in top left
-    // corner. fft expects signal to be between 0 and Fe, not -Fe/2, Fe/2
-    LOG("filter", trace, "shift filter image");
-    auto shifted_values = fftw::CreateReal({image_size.row, image_size.col});
-    utils::IFFTShift2D(filter_values.data(), image_size, shifted_values.get());
+    for (int i = 0; i < batch_count; ++i) {
+        utils::MultiplyComplex(
+              reinterpret_cast<T*>(batch_fft + i * filter_fft_count),
+              reinterpret_cast<const T*>(filter_fft.get()), filter_fft_count);
+    }
+}
 
-    LOG("filter", trace, "compute filter FFT");
-    return fftw::FFT(shifted_values.get(), image_size);
+template <typename T>
+fftw::BasicComplexSPtr<T> Filter::GetFilterFFT(const Size& image_size) const {
+    CheckImageSize(image_size);
+
+    // prepared spectra are read-only while processing: no lock needed
+    const auto& filter_spectra = Spectra<T>();
+    auto filter_spectrum_it = filter_spectra.find(image_size);
+    if (filter_spectrum_it != filter_spectra.end()) {
+        return filter_spectrum_it->second;
+    }
+
+#ifdef SIRIUS_ENABLE_CACHE_OPTIMIZATION
+    // cache version: the first caller computes the filter fft, concurrent
+    // callers of the same size wait for it
+    auto& filter_fft_cache = FFTCache<T>();
+    std::promise<fftw::BasicComplexSPtr<T>> filter_fft_promise;
+    bool is_owner = false;
+    auto share_filter_fft = [&filter_fft_promise, &is_owner]() {
+        is_owner = true;
+        return filter_fft_promise.get_future().share();
+    };
+    auto filter_fft_future =
+          filter_fft_cache.GetOrInsert(image_size, share_filter_fft);
+    if (is_owner) {
+        LOG("filter", debug, "filter fft for image {}x{} was not prepared",
+            image_size.row, image_size.col);
+        try {
+            filter_fft_promise.set_value(
+                  fftw::BasicComplexSPtr<T>{CreateFilterFFT<T>(image_size)});
+        } catch (...) {
+            // let later callers retry
+            filter_fft_cache.Remove(image_size);
+            filter_fft_promise.set_exception(std::current_exception());
+        }
+    }
+    return filter_fft_future.get();
+#else
+    // no cache version
+    return fftw::BasicComplexSPtr<T>{CreateFilterFFT<T>(image_size)};
+#endif  // SIRIUS_ENABLE_CACHE_OPTIMIZATION
+}
+
+template <typename T>
+fftw::BasicComplexUPtr<T> Filter::CreateFilterFFT(
+      const Size& image_size) const {
+    if (!IsSeparable()) {
+        return CreateKernelFFT<T>(filter_, image_size);
+    }
+
+    // spectrum of the column kernel followed by the spectrum of the row
+    // kernel: their outer product is the 2D filter spectrum
+    auto column_fft = CreateKernelFFT<T>(column_kernel_, {image_size.row, 1});
+    auto row_fft = CreateKernelFFT<T>(row_kernel_, {1, image_size.col});
+    auto filter_fft =
+          fftw::CreateComplex<T>({1, SpectrumCellCount(image_size)});
+    std::memcpy(filter_fft.get(), column_fft.get(),
+                image_size.row * sizeof(fftw::BasicComplex<T>));
+    std::memcpy(filter_fft.get() + image_size.row, row_fft.get(),
+                (image_size.col / 2 + 1) * sizeof(fftw::BasicComplex<T>));
+    return filter_fft;
+}
+
+template <typename T>
+fftw::BasicComplexSPtr<T> Filter::GetFilterRowsFFT(
+      const Size& image_size, const std::vector<int>& rows,
+      int col_count) const {
+    CheckImageSize(image_size);
+    Size compact_size(static_cast<int>(rows.size()), col_count);
+#ifdef SIRIUS_ENABLE_CACHE_OPTIMIZATION
+    // rows of a compact spectrum only depend on the image sizes
+    return RowsFFTCache<T>().GetOrInsert(
+          std::make_pair(image_size, compact_size),
+          [this, &image_size, &rows, col_count]() {
+              return fftw::BasicComplexSPtr<T>{
+                    CreateFilterRowsFFT<T>(image_size, rows, col_count)};
+          });
+#else
+    return fftw::BasicComplexSPtr<T>{
+          CreateFilterRowsFFT<T>(image_size, rows, col_count)};
+#endif  // SIRIUS_ENABLE_CACHE_OPTIMIZATION
+}
+
+template <typename T>
+fftw::BasicComplexUPtr<T> Filter::CreateFilterRowsFFT(
+      const Size& image_size, const std::vector<int>& rows,
+      int col_count) const {
+    LOG("filter", debug, "compute {}x{} filter spectrum of image {}x{}",
+        rows.size(), col_count, image_size.row, image_size.col);
+    // H(r, c) = sum_y exp(-2i.pi.r.(y - center) / row_count) G_y(c) where
+    // G_y is the spectrum of the kernel row y, centered as in
+    // CreateKernelFFT: only 1D FFTs of the image width are computed
+    int kernel_row_center = (filter_.size.row - 1) / 2;
+    int kernel_row_count = 2 * kernel_row_center + 1;
+    Image kernel_row({1, filter_.size.col});
+    std::vector<fftw::BasicComplexUPtr<T>> kernel_row_ffts;
+    for (int y = 0; y < kernel_row_count; ++y) {
+        auto filter_row = filter_.data.begin() + y * filter_.size.col;
+        std::copy(filter_row, filter_row + filter_.size.col,
+                  kernel_row.data.begin());
+        kernel_row_ffts.push_back(
+              CreateKernelFFT<T>(kernel_row, {1, image_size.col}));
+    }
+
+    auto filter_fft = fftw::CreateComplex<T>(
+          {static_cast<int>(rows.size()), col_count});
+    std::vector<std::complex<double>> row_values(col_count);
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        std::fill(row_values.begin(), row_values.end(), 0.);
+        for (int y = 0; y < kernel_row_count; ++y) {
+            long long shift = Wrap(y - kernel_row_center, image_size.row);
+            double angle = -2 * M_PI * ((rows[i] * shift) % image_size.row) /
+                           static_cast<double>(image_size.row);
+            auto phase = std::polar(1.0, angle);
+            const auto* kernel_row_fft = kernel_row_ffts[y].get();
+            for (int col = 0; col < col_count; ++col) {
+                row_values[col] +=
+                      phase * std::complex<double>(kernel_row_fft[col][0],
+                                                   kernel_row_fft[col][1]);
+            }
+        }
+        auto* filter_row_fft = filter_fft.get() + i * col_count;
+        for (int col = 0; col < col_count; ++col) {
+            filter_row_fft[col][0] = static_cast<T>(row_values[col].real());
+            filter_row_fft[col][1] = static_cast<T>(row_values[col].imag());
+        }
+    }
+    return filter_fft;
 }
 
+template fftw::ComplexUPtr Filter::Process<double>(
+      const Size& image_size, fftw::ComplexUPtr image_fft) const;
+template fftw::BasicComplexUPtr<float> Filter::Process<float>(
+      const Size& image_size, fftw::BasicComplexUPtr<float> image_fft) const;
+template void Filter::ProcessBatch<double>(
+      const Size& image_size, int batch_count,
+      fftw::BasicComplex<double>* batch_fft) const;
+template void Filter::ProcessBatch<float>(
+      const Size& image_size, int batch_count,
+      fftw::BasicComplex<float>* batch_fft) const;
+template void Filter::ProcessRows<double>(
+      const Size& image_size, const std::vector<int>& rows, int col_count,
+      fftw::BasicComplex<double>* fft) const;
+template void Filter::ProcessRows<float>(
+      const Size& image_size, const std::vector<int>& rows, int col_count,
+      fftw::BasicComplex<float>* fft) const;
+template void Filter::Convolve<double>(BasicImage<double>& image) const;
+template void Filter::Convolve<float>(BasicImage<float>& image) const;
+template void Filter::PrepareSpectra<double>(
+      const std::vector<Size>& image_sizes) const;
+template void Filter::PrepareSpectra<float>(
+      const std::vector<Size>& image_sizes) const;
+
 Filter Filter::CreateZoomOutFilter(Image filter_image,
                                    const ZoomRatio& zoom_ratio,
                                    PaddingType padding_type) {
@@ -22,9 +22,12 @@
 #ifndef SIRIUS_FILTER_H_
 #define SIRIUS_FILTER_H_
 
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "sirius/image.h"
 #include "sirius/types.h"
@@ -35,6 +38,18 @@
 
 namespace sirius {
 
+/**
+ * \brief Filtering engine
+ *
+ * The direct convolution is opt-in: kAuto relies on a cost model which is
+ * not calibrated against FFTW, so the default engine is kSpectral.
+ */
+enum class FilterEngine {
+    kAuto = 0,     /**< choose the cheapest engine for each image size */
+    kSpectral = 1, /**< multiply the image FFT by the filter spectrum */
+    kDirect = 2    /**< convolve the image with the filter kernel */
+};
+
 /**
  * \brief Data class that contains Filter metadata
  */
@@ -50,23 +65,60 @@ struct FilterMetadata {
 class Filter {
   private:
     static constexpr int kCacheSize = 10;
-    using FilterFFTCache = utils::LRUCache<Size, fftw::ComplexSPtr, kCacheSize>;
-    using FilterFFTCacheUPtr = std::unique_ptr<FilterFFTCache>;
+    template <typename T>
+    using BasicFilterFFTFuture = std::shared_future<fftw::BasicComplexSPtr<T>>;
+    template <typename T>
+    using BasicFilterFFTCache =
+          utils::LRUCache<Size, BasicFilterFFTFuture<T>, kCacheSize>;
+    template <typename T>
+    using BasicFilterFFTCacheUPtr = std::unique_ptr<BasicFilterFFTCache<T>>;
+    using FilterFFTCache = BasicFilterFFTCache<double>;
+    using FilterFFTCacheUPtr = BasicFilterFFTCacheUPtr<double>;
+    template <typename T>
+    using BasicFilterSpectra = std::map<Size, fftw::BasicComplexSPtr<T>>;
+    template <typename T>
+    using BasicFilterSpectraUPtr = std::unique_ptr<BasicFilterSpectra<T>>;
+    // compact spectra of ProcessRows: (image size, compact spectrum size)
+    template <typename T>
+    using BasicFilterRowsFFTCache =
+          utils::LRUCache<std::pair<Size, Size>, fftw::BasicComplexSPtr<T>,
+                          kCacheSize>;
+    template <typename T>
+    using BasicFilterRowsFFTCacheUPtr =
+          std::unique_ptr<BasicFilterRowsFFTCache<T>>;
 
   public:
+    /**
+     * \brief Default relative tolerance of the separable filter detection
+     *
+     * Filter images are usually stored in single precision: a separable
+     * filter is only rank-1 up to the float32 rounding of its coefficients.
+     */
+    static constexpr double kSeparableTolerance = 1e-6;
+
     /**
      * \brief Filter which is adapted specifically for a particular zoom ratio
+     *
+     * The filter is applied as a separable filter (outer product of a column
+     * and a row kernel) if its rank-1 approximation is within
+     * separable_tolerance of the filter (relative Frobenius norm).
+     *
      * \param image_path image path of the filter
      * \param zoom_ratio ratio on which the filter must be applied
      * \param padding_type padding type
      * \param normalize normalize filter
+     * \param separable_tolerance relative tolerance of the separable filter
+     *        detection, negative to disable it
+     * \param engine filtering engine (the direct convolution is opt-in)
      *
      * \throw SiriusException if the filter image cannot be loaded
      */
     static Filter Create(const std::string& image_path,
                          const ZoomRatio& zoom_ratio,
                          PaddingType padding_type = PaddingType::kMirrorPadding,
-                         bool normalize = false);
+                         bool normalize = false,
+                         double separable_tolerance = kSeparableTolerance,
+                         FilterEngine engine = FilterEngine::kSpectral);
 
     Filter() = default;
 
@@ -85,6 +137,13 @@ class Filter {
      */
     bool IsLoaded() const { return filter_.IsLoaded(); }
 
+    /**
+     * \brief Filter is applied as the outer product of a column and a row
+     *        kernel
+     * \return bool
+     */
+    bool IsSeparable() const { return column_kernel_.IsLoaded(); }
+
     /**
      * \brief Filter image size
      * \return Size
@@ -130,6 +189,10 @@ class Filter {
      * \brief Apply the filter on the image_fft
      *
      * \remark This method is thread safe
+     * \remark Filter spectrum is computed in the precision of the image FFT
+     *         (double or float)
+     * \remark Spectrum of a separable filter is stored as its column and row
+     *         spectra and expanded row by row
      *
      * \param image_size size of the image of the fft
      * \param image_fft image fft computed by FFTW
@@ -137,8 +200,98 @@ class Filter {
      *
      * \throw SiriusException if the filter cannot be applied on the image FFT
      */
-    fftw::ComplexUPtr Process(const Size& image_size,
-                              fftw::ComplexUPtr image_fft) const;
+    template <typename T>
+    fftw::BasicComplexUPtr<T> Process(
+          const Size& image_size, fftw::BasicComplexUPtr<T> image_fft) const;
+
+    /**
+     * \brief Apply the filter on a batch of image FFTs of the same size
+     *
+     * The filter spectrum is fetched once for the whole batch.
+     *
+     * \remark This method is thread safe
+     *
+     * \param image_size size of the images of the ffts
+     * \param batch_count number of ffts
+     * \param batch_fft image ffts stored one after the other, filtered in
+     *        place
+     *
+     * \throw SiriusException if the filter cannot be applied on the image FFTs
+     */
+    template <typename T>
+    void ProcessBatch(const Size& image_size, int batch_count,
+                      fftw::BasicComplex<T>* batch_fft) const;
+
+    /**
+     * \brief Apply the filter on some rows of an image FFT
+     *
+     * Used to filter a compact spectrum, which holds only the non-zero rows
+     * and the first columns of the image FFT. The filter spectrum is only
+     * computed on these rows and columns: its size follows the compact
+     * spectrum, not the image. It is cached by image size.
+     *
+     * \remark This method is thread safe
+     *
+     * \param image_size size of the image of the full fft
+     * \param rows row of the full fft of each row of the compact spectrum
+     * \param col_count column count of the compact spectrum
+     * \param fft compact spectrum, filtered in place
+     *
+     * \throw SiriusException if the filter cannot be applied on the image FFT
+     */
+    template <typename T>
+    void ProcessRows(const Size& image_size, const std::vector<int>& rows,
+                     int col_count, fftw::BasicComplex<T>* fft) const;
+
+    /**
+     * \brief Check whether the filter is applied by direct convolution on
+     *        images of the given size
+     *
+     * In auto mode, direct convolution is chosen when its cost (one
+     * multiply-add per kernel tap and per pixel) is lower than what it saves
+     * on the spectral path: the filter product and, for a zero padded
+     * spectrum, the column IFFTs of the zero columns which the pruned IFFT
+     * skips. Strategies which compute the same IFFT on both paths (e.g.
+     * periodization) only save the product.
+     *
+     * \param image_size size of the zoomed image
+     * \param pruned_zoom zoom of the zero padded spectrum which is IFFTed
+     *        by pruning when it is not filtered (1 if the full IFFT is
+     *        computed on both paths)
+     * \return true if Convolve must be used instead of Process
+     */
+    bool UseDirectConvolution(const Size& image_size,
+                              int pruned_zoom = 1) const;
+
+    /**
+     * \brief Apply the filter on an image by direct circular convolution
+     *
+     * Spatial equivalent of Process: the result is the IFFT of the image FFT
+     * multiplied by the filter spectrum.
+     *
+     * \remark This method is thread safe
+     *
+     * \param image image to filter in place
+     *
+     * \throw SiriusException if the filter cannot be applied on the image
+     */
+    template <typename T>
+    void Convolve(BasicImage<T>& image) const;
+
+    /**
+     * \brief Precompute the filter spectra of the given image sizes
+     *
+     * Prepared spectra are shared read-only by Process and ProcessBatch
+     * without any lock. Sizes which were not prepared are computed on
+     * demand, once, and kept in a small LRU cache.
+     *
+     * \remark This method is not thread safe: call it before processing
+     *
+     * \param image_sizes sizes of the image FFTs the filter spectrum will be
+     *        applied on, cf. IFrequencyZoom::FilterSpectrumSizes
+     */
+    template <typename T>
+    void PrepareSpectra(const std::vector<Size>& image_sizes) const;
 
   private:
     static Filter CreateZoomInFilter(Image filter_image,
@@ -154,15 +307,54 @@ class Filter {
     Filter(Image&& filter_image, const Size& padding_size,
            const ZoomRatio& zoom_ratio, PaddingType padding_type);
 
-    fftw::ComplexUPtr CreateFilterFFT(const Size& image_size) const;
+    void DetectSeparableKernels(double tolerance);
+
+    void CheckImageSize(const Size& image_size) const;
+
+    int SpectrumCellCount(const Size& image_size) const;
+
+    template <typename T>
+    fftw::BasicComplexSPtr<T> GetFilterFFT(const Size& image_size) const;
+
+    template <typename T>
+    fftw::BasicComplexUPtr<T> CreateFilterFFT(const Size& image_size) const;
+
+    template <typename T>
+    fftw::BasicComplexSPtr<T> GetFilterRowsFFT(const Size& image_size,
+                                               const std::vector<int>& rows,
+                                               int col_count) const;
+
+    template <typename T>
+    fftw::BasicComplexUPtr<T> CreateFilterRowsFFT(
+          const Size& image_size, const std::vector<int>& rows,
+          int col_count) const;
+
+    template <typename T>
+    BasicFilterFFTCache<T>& FFTCache() const;
+
+    template <typename T>
+    BasicFilterSpectra<T>& Spectra() const;
+
+    template <typename T>
+    BasicFilterRowsFFTCache<T>& RowsFFTCache() const;
 
   private:
     Image filter_{};
     Size padding_size_{0, 0};
     ZoomRatio zoom_ratio_{};
     PaddingType padding_type_{PaddingType::kMirrorPadding};
+    Image column_kernel_{};
+    Image row_kernel_{};
+    FilterEngine engine_{FilterEngine::kSpectral};
 
     FilterFFTCacheUPtr filter_fft_cache_{nullptr};
+    BasicFilterFFTCacheUPtr<float> float_filter_fft_cache_{nullptr};
+
+    BasicFilterSpectraUPtr<double> filter_spectra_{nullptr};
+    BasicFilterSpectraUPtr<float> float_filter_spectra_{nullptr};
+
+    BasicFilterRowsFFTCacheUPtr<double> filter_rows_fft_cache_{nullptr};
+    BasicFilterRowsFFTCacheUPtr<float> float_filter_rows_fft_cache_{nullptr};
 };
 
 }  // namespace sirius
@@ -0,0 +1,406 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sirius/gdal/coalescing_writer.h"
+
+#include <algorithm>
+
+#include "sirius/gdal/error_code.h"
+
+#include "sirius/utils/log.h"
+
+namespace sirius {
+namespace gdal {
+
+constexpr std::size_t CoalescingWriter::kDefaultMaxBufferedBytes;
+
+CoalescingWriter::CoalescingWriter(
+      OutputZoomedStream& output_stream,
+      const std::vector<StreamBlockDescriptor>& blocks,
+      std::size_t max_buffered_bytes)
+    : output_stream_(output_stream),
+      max_buffered_bytes_(max_buffered_bytes),
+      band_count_(output_stream.band_count()) {
+    // blocks of a grid row share the same input row
+    std::vector<int> block_rows;
+    std::vector<std::vector<int>> strip_block_cols;
+    for (const auto& block : blocks) {
+        auto strip_index_it = strip_indices_.find(block.row_idx);
+        if (strip_index_it == strip_indices_.end()) {
+            strip_index_it =
+                  strip_indices_.emplace(block.row_idx, block_rows.size())
+                        .first;
+            block_rows.push_back(block.row_idx);
+            strip_block_cols.emplace_back();
+        }
+        strip_block_cols[strip_index_it->second].push_back(block.col_idx);
+    }
+
+    // a strip spans the output rows up to the next strip
+    auto output_size = output_stream_.Size();
+    int tile_col_count = output_stream_.native_block_size().col;
+    int chunk_col_count = output_size.col;
+    std::size_t chunked_strip_count = 0;
+    for (std::size_t i = 0; i < block_rows.size(); ++i) {
+        int output_row_idx = output_stream_.OutputRowIndex(block_rows[i]);
+        int next_output_row_idx =
+              (i + 1 < block_rows.size())
+                    ? output_stream_.OutputRowIndex(block_rows[i + 1])
+                    : output_size.row;
+        int row_count = next_output_row_idx - output_row_idx;
+
+        Strip strip;
+        strip.first_chunk_idx = chunks_.size();
+        strip.block_cols = std::move(strip_block_cols[i]);
+        std::sort(strip.block_cols.begin(), strip.block_cols.end());
+        strip.block_cols.erase(
+              std::unique(strip.block_cols.begin(), strip.block_cols.end()),
+              strip.block_cols.end());
+        strip.chunk_col_count = std::max(output_size.col, 1);
+        std::size_t col_bytes = static_cast<std::size_t>(band_count_) *
+                                std::max(row_count, 0) *
+                                sizeof(OutputZoomedStream::OutputType);
+        // half of the budget per chunk: a chunk is filled while the previous
+        // one is flushed
+        std::size_t max_chunk_bytes = max_buffered_bytes_ / 2;
+        if (col_bytes * output_size.col > max_buffered_bytes_ &&
+            col_bytes > 0 && col_bytes <= max_chunk_bytes) {
+            strip.chunk_col_count =
+                  static_cast<int>(max_chunk_bytes / col_bytes);
+            if (tile_col_count > 0 && tile_col_count < strip.chunk_col_count) {
+                strip.chunk_col_count -=
+                      strip.chunk_col_count % tile_col_count;
+            }
+            chunk_col_count = strip.chunk_col_count;
+            ++chunked_strip_count;
+        }
+
+        for (int col = 0; col < output_size.col;
+             col += strip.chunk_col_count) {
+            Chunk chunk;
+            chunk.output_row_idx = output_row_idx;
+            chunk.output_col_idx = col;
+            chunk.size = Size(row_count, std::min(strip.chunk_col_count,
+                                                  output_size.col - col));
+            chunks_.push_back(std::move(chunk));
+        }
+        strips_.push_back(strip);
+    }
+
+    if (chunked_strip_count > 0) {
+        LOG("coalescing_writer", warn,
+            "{} strips do not fit in the {} MiB write budget: they are "
+            "coalesced by chunks of {} columns",
+            chunked_strip_count, max_buffered_bytes_ / (1024 * 1024),
+            chunk_col_count);
+    }
+
+    flush_task_ =
+          std::async(std::launch::async, &CoalescingWriter::FlushChunks, this);
+}
+
+CoalescingWriter::~CoalescingWriter() {
+    if (flush_task_.valid()) {
+        std::error_code ec;
+        Close(ec);
+    }
+}
+
+template <typename T>
+void CoalescingWriter::Write(BasicStreamBlock<T>&& block,
+                             std::error_code& ec) {
+    using OutputType = OutputZoomedStream::OutputType;
+    const auto block_size = block.size();
+    const int band_count = static_cast<int>(block.bands.size());
+    int output_row_idx = output_stream_.OutputRowIndex(block.row_idx);
+    int output_col_idx = output_stream_.OutputColIndex(block.col_idx);
+    int output_col_count = output_stream_.Size().col;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (flush_ec_) {
+        ec = flush_ec_;
+        return;
+    }
+
+    auto strip_index_it = strip_indices_.find(block.row_idx);
+    if (strip_index_it == strip_indices_.end()) {
+        LOG("coalescing_writer", error, "block at ({}, {}) is not in the grid",
+            block.row_idx, block.col_idx);
+        ec = make_error_code(CPLE_IllegalArg);
+        return;
+    }
+    const auto& strip = strips_[strip_index_it->second];
+    const auto& first_chunk = chunks_[strip.first_chunk_idx];
+    auto block_col_it = std::lower_bound(
+          strip.block_cols.begin(), strip.block_cols.end(), block.col_idx);
+    if (block_col_it == strip.block_cols.end() ||
+        *block_col_it != block.col_idx) {
+        LOG("coalescing_writer", error, "block at ({}, {}) is not in the grid",
+            block.row_idx, block.col_idx);
+        ec = make_error_code(CPLE_IllegalArg);
+        return;
+    }
+    // on the image borders, blocks of a strip overlap: columns after the
+    // next block are written by the next block
+    int next_output_col_idx =
+          (std::next(block_col_it) != strip.block_cols.end())
+                ? output_stream_.OutputColIndex(*std::next(block_col_it))
+                : output_col_count;
+    int col_count =
+          std::min(block_size.col, next_output_col_idx - output_col_idx);
+    if (band_count != band_count_ || col_count <= 0 ||
+        output_col_idx + col_count > output_col_count) {
+        LOG("coalescing_writer", error,
+            "zoomed block {}x{} at ({}, {}) does not fit in the output strip",
+            block_size.row, block_size.col, output_row_idx, output_col_idx);
+        ec = make_error_code(CPLE_IllegalArg);
+        return;
+    }
+    ++block_count_;
+    // on the image borders, blocks of consecutive strips overlap: rows below
+    // the strip are written by the next strips
+    int row_count = std::min(block_size.row, first_chunk.size.row);
+
+    // chunks covered by the block
+    std::size_t begin_chunk_idx =
+          strip.first_chunk_idx + output_col_idx / strip.chunk_col_count;
+    std::size_t end_chunk_idx =
+          strip.first_chunk_idx +
+          (output_col_idx + col_count - 1) / strip.chunk_col_count + 1;
+    ReserveChunks(end_chunk_idx - 1);
+
+    std::vector<bool> is_direct_chunk;
+    for (std::size_t i = begin_chunk_idx; i < end_chunk_idx; ++i) {
+        auto& chunk = chunks_[i];
+        if (chunk.state == ChunkState::kComplete ||
+            chunk.state == ChunkState::kFlushed) {
+            LOG("coalescing_writer", error,
+                "block at ({}, {}) overlaps the complete chunk at ({}, {})",
+                block.row_idx, block.col_idx, chunk.output_row_idx,
+                chunk.output_col_idx);
+            ec = make_error_code(CPLE_IllegalArg);
+            return;
+        }
+        if (chunk.state == ChunkState::kEmpty) {
+            LOG("coalescing_writer", warn,
+                "no memory budget left for the {}x{} chunk at ({}, {}): write "
+                "its blocks directly",
+                chunk.size.row, chunk.size.col, chunk.output_row_idx,
+                chunk.output_col_idx);
+            chunk.state = ChunkState::kDirect;
+            ++direct_chunk_count_;
+        }
+        is_direct_chunk.push_back(chunk.state == ChunkState::kDirect);
+    }
+    lock.unlock();
+    // flush thread may wait for a chunk which is now written directly
+    chunk_cond_.notify_one();
+
+    // chunk images are not moved until all their columns are written:
+    // convert and copy the block in the calling thread, without lock
+    for (std::size_t i = begin_chunk_idx; i < end_chunk_idx; ++i) {
+        auto& chunk = chunks_[i];
+        int col_begin = std::max(output_col_idx, chunk.output_col_idx);
+        int col_end = std::min(output_col_idx + col_count,
+                               chunk.output_col_idx + chunk.size.col);
+        int copy_col_count = col_end - col_begin;
+        int block_col_idx = col_begin - output_col_idx;
+
+        if (is_direct_chunk[i - begin_chunk_idx]) {
+            std::vector<BasicImage<OutputType>> output_images;
+            for (const auto& band_image : block.bands) {
+                output_images.emplace_back(Size(row_count, copy_col_count));
+                auto& output_image = output_images.back();
+                for (int row = 0; row < row_count; ++row) {
+                    auto src = band_image.data.begin() +
+                               row * block_size.col + block_col_idx;
+                    std::copy(src, src + copy_col_count,
+                              output_image.data.begin() +
+                                    row * copy_col_count);
+                }
+            }
+            output_stream_.Write(output_row_idx, col_begin, output_images, ec);
+            if (ec) {
+                return;
+            }
+            continue;
+        }
+
+        int chunk_col_idx = col_begin - chunk.output_col_idx;
+        for (int band = 0; band < band_count; ++band) {
+            const auto& band_image = block.bands[band];
+            auto& chunk_image = chunk.bands[band];
+            for (int row = 0; row < row_count; ++row) {
+                auto src = band_image.data.begin() + row * block_size.col +
+                           block_col_idx;
+                std::copy(src, src + copy_col_count,
+                          chunk_image.data.begin() + row * chunk.size.col +
+                                chunk_col_idx);
+            }
+        }
+
+        lock.lock();
+        chunk.written_col_count += copy_col_count;
+        bool is_complete = (chunk.written_col_count == chunk.size.col);
+        if (is_complete) {
+            chunk.state = ChunkState::kComplete;
+        }
+        lock.unlock();
+        if (is_complete) {
+            chunk_cond_.notify_one();
+        }
+    }
+    ec = make_error_code(CPLE_None);
+}
+
+void CoalescingWriter::Close(std::error_code& ec) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_closed_ = true;
+    }
+    chunk_cond_.notify_one();
+    flush_task_.get();
+
+    LogStats();
+    if (flush_ec_) {
+        ec = flush_ec_;
+        return;
+    }
+    if (next_chunk_idx_ < chunks_.size()) {
+        LOG("coalescing_writer", error,
+            "{} chunks were not complete when the writer was closed",
+            chunks_.size() - next_chunk_idx_);
+        ec = make_error_code(CPLE_AppDefined);
+        return;
+    }
+    ec = make_error_code(CPLE_None);
+}
+
+std::size_t CoalescingWriter::ChunkBytes(const Chunk& chunk) const {
+    return static_cast<std::size_t>(band_count_) * chunk.size.CellCount() *
+           sizeof(OutputZoomedStream::OutputType);
+}
+
+void CoalescingWriter::ReserveChunks(std::size_t last_chunk_idx) {
+    // budget is given in scan order: chunks far from the flush cursor cannot
+    // hold the budget needed by the chunks before them
+    while (reserved_chunk_idx_ <= last_chunk_idx &&
+           reserved_chunk_idx_ < chunks_.size()) {
+        auto& chunk = chunks_[reserved_chunk_idx_];
+        if (chunk.state == ChunkState::kEmpty) {
+            std::size_t chunk_bytes = ChunkBytes(chunk);
+            if (chunk_bytes > max_buffered_bytes_) {
+                LOG("coalescing_writer", warn,
+                    "{}x{} chunk at ({}, {}) exceeds the write budget: write "
+                    "its blocks directly",
+                    chunk.size.row, chunk.size.col, chunk.output_row_idx,
+                    chunk.output_col_idx);
+                chunk.state = ChunkState::kDirect;
+                ++direct_chunk_count_;
+                ++reserved_chunk_idx_;
+                continue;
+            }
+            if (buffered_bytes_ + chunk_bytes > max_buffered_bytes_) {
+                return;
+            }
+            chunk.bands.clear();
+            for (int band = 0; band < band_count_; ++band) {
+                chunk.bands.emplace_back(chunk.size);
+            }
+            chunk.state = ChunkState::kBuffering;
+            buffered_bytes_ += chunk_bytes;
+            max_reached_buffered_bytes_ =
+                  std::max(max_reached_buffered_bytes_, buffered_bytes_);
+        }
+        ++reserved_chunk_idx_;
+    }
+}
+
+void CoalescingWriter::FlushChunks() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        chunk_cond_.wait(lock, [this]() {
+            return is_closed_ || next_chunk_idx_ == chunks_.size() ||
+                   chunks_[next_chunk_idx_].state == ChunkState::kComplete ||
+                   chunks_[next_chunk_idx_].state == ChunkState::kDirect;
+        });
+        if (next_chunk_idx_ == chunks_.size()) {
+            break;
+        }
+
+        auto& chunk = chunks_[next_chunk_idx_];
+        if (chunk.state == ChunkState::kDirect) {
+            // blocks are written by the workers
+            ++next_chunk_idx_;
+            continue;
+        }
+        if (chunk.state != ChunkState::kComplete) {
+            // closed before the end of the stream, reported by Close
+            break;
+        }
+
+        auto chunk_images = std::move(chunk.bands);
+        lock.unlock();
+        std::error_code write_ec;
+        output_stream_.Write(chunk.output_row_idx, chunk.output_col_idx,
+                             chunk_images, write_ec);
+        chunk_images.clear();
+        lock.lock();
+
+        buffered_bytes_ -= ChunkBytes(chunk);
+        chunk.state = ChunkState::kFlushed;
+        ++next_chunk_idx_;
+        if (write_ec) {
+            flush_ec_ = write_ec;
+            break;
+        }
+    }
+}
+
+void CoalescingWriter::LogStats() const {
+    auto stats = output_stream_.GetStats();
+    auto output_size = output_stream_.Size();
+    double output_bytes = output_size.CellCount() *
+                          output_stream_.band_count() *
+                          sizeof(OutputZoomedStream::OutputType);
+    double mean_write_duration =
+          stats.write_count > 0 ? stats.write_duration / stats.write_count
+                                : 0.0;
+    LOG("coalescing_writer", info,
+        "{} blocks written in {} writes ({} strips, {} chunks, {} chunks "
+        "written directly)",
+        block_count_, stats.write_count, strips_.size(), chunks_.size(),
+        direct_chunk_count_);
+    LOG("coalescing_writer", info,
+        "write amplification: {:.2f}, flush latency: mean {:.2f} ms, max "
+        "{:.2f} ms, max buffered: {} MiB",
+        stats.written_bytes / output_bytes, mean_write_duration * 1000,
+        stats.max_write_duration * 1000,
+        max_reached_buffered_bytes_ / (1024 * 1024));
+}
+
+template void CoalescingWriter::Write<double>(StreamBlock&& block,
+                                              std::error_code& ec);
+template void CoalescingWriter::Write<float>(FloatStreamBlock&& block,
+                                             std::error_code& ec);
+
+}  // namespace gdal
+}  // namespace sirius
@@ -0,0 +1,176 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIRIUS_GDAL_COALESCING_WRITER_H_
+#define SIRIUS_GDAL_COALESCING_WRITER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <future>
+#include <map>
+#include <mutex>
+#include <system_error>
+#include <vector>
+
+#include "sirius/image.h"
+
+#include "sirius/gdal/output_zoomed_stream.h"
+#include "sirius/gdal/stream_block.h"
+
+namespace sirius {
+namespace gdal {
+
+/**
+ * \brief Output stage that gathers zoomed blocks into full width strips
+ *
+ * The zoomed blocks of a row of the block grid are converted to the output
+ * pixel type and copied into a strip buffer by the thread which writes them.
+ * Complete strips are written in scan order by a flush thread, with one
+ * RasterIO call per strip.
+ *
+ * Strip buffers are limited by a memory budget. A strip which does not fit in
+ * the budget is split into column chunks aligned on the output tiles, each
+ * chunk is buffered and written like a strip. The budget is reserved in scan
+ * order from the flush cursor: blocks of a chunk which cannot be reserved
+ * (budget held by the chunks before it) are written directly in the output
+ * image.
+ */
+class CoalescingWriter {
+  public:
+    static constexpr std::size_t kDefaultMaxBufferedBytes = 256 * 1024 * 1024;
+
+    /**
+     * \brief Instanciate a writer and start its flush thread
+     * \param output_stream output image
+     * \param blocks block grid of the input image, cf. InputStream::blocks
+     * \param max_buffered_bytes memory budget of the strip buffers
+     */
+    CoalescingWriter(OutputZoomedStream& output_stream,
+                     const std::vector<StreamBlockDescriptor>& blocks,
+                     std::size_t max_buffered_bytes = kDefaultMaxBufferedBytes);
+
+    /**
+     * \brief Close the writer if needed
+     */
+    ~CoalescingWriter();
+
+    CoalescingWriter(const CoalescingWriter&) = delete;
+    CoalescingWriter& operator=(const CoalescingWriter&) = delete;
+    CoalescingWriter(CoalescingWriter&&) = delete;
+    CoalescingWriter& operator=(CoalescingWriter&&) = delete;
+
+    /**
+     * \brief Write a zoomed block
+     *
+     * \remark This method is thread safe
+     *
+     * \param block zoomed block
+     * \param ec error code if the block or a previous strip could not be
+     *        written
+     */
+    template <typename T>
+    void Write(BasicStreamBlock<T>&& block, std::error_code& ec);
+
+    /**
+     * \brief Flush the complete strips and stop the flush thread
+     *
+     * Strips which are not complete (e.g. cancelled stream) are dropped
+     * and reported as an error.
+     *
+     * \param ec error code if a strip could not be written or was not
+     *        complete
+     */
+    void Close(std::error_code& ec);
+
+  private:
+    enum class ChunkState {
+        kEmpty = 0, /**< no budget reserved */
+        kBuffering, /**< blocks are copied in the chunk buffer */
+        kComplete,  /**< all columns received, chunk can be flushed */
+        kDirect,    /**< no budget, blocks are written directly */
+        kFlushed    /**< chunk written */
+    };
+
+    /**
+     * \brief Output window buffered and written at once: a full width strip
+     *        or a column range of it
+     */
+    struct Chunk {
+        int output_row_idx = 0;
+        int output_col_idx = 0;
+        Size size{};
+        int written_col_count = 0;
+        ChunkState state = ChunkState::kEmpty;
+        // one image per band
+        std::vector<BasicImage<OutputZoomedStream::OutputType>> bands{};
+    };
+
+    struct Strip {
+        std::size_t first_chunk_idx = 0;
+        int chunk_col_count = 0;
+        // sorted column indices of the strip blocks in the input image
+        std::vector<int> block_cols{};
+    };
+
+    std::size_t ChunkBytes(const Chunk& chunk) const;
+
+    /**
+     * \brief Reserve the budget of the chunks, in scan order, up to
+     *        last_chunk_idx
+     *
+     * \remark mutex_ must be held
+     */
+    void ReserveChunks(std::size_t last_chunk_idx);
+
+    void FlushChunks();
+
+    void LogStats() const;
+
+  private:
+    OutputZoomedStream& output_stream_;
+    std::size_t max_buffered_bytes_;
+    int band_count_;
+
+    std::mutex mutex_;
+    std::condition_variable chunk_cond_;
+    std::vector<Strip> strips_;
+    // chunks of all the strips, in scan order
+    std::vector<Chunk> chunks_;
+    // block row in the input image -> strip index
+    std::map<int, std::size_t> strip_indices_;
+    // flush cursor
+    std::size_t next_chunk_idx_ = 0;
+    // chunks before this index have been reserved or are written directly
+    std::size_t reserved_chunk_idx_ = 0;
+    std::size_t buffered_bytes_ = 0;
+    std::size_t max_reached_buffered_bytes_ = 0;
+    std::size_t block_count_ = 0;
+    std::size_t direct_chunk_count_ = 0;
+    std::error_code flush_ec_;
+    bool is_closed_ = false;
+
+    std::future<void> flush_task_;
+};
+
+}  // namespace gdal
+}  // namespace sirius
+
+#endif  // SIRIUS_GDAL_COALESCING_WRITER_H_
@@ -32,161 +32,248 @@
 namespace sirius {
 namespace gdal {
 
+namespace {
+
+/**
+ * \brief Average count of reads of each native block of the image
+ *
+ * A ratio of 1 means that each native block (tile or strip) is read, and
+ * decompressed, once by the block grid.
+ */
+double ComputeNativeBlockReadRatio(
+      const std::vector<StreamBlockDescriptor>& blocks,
+      const sirius::Size& native_block_size, const sirius::Size& image_size) {
+    auto native_block_count = [](int idx, int length, int native_length) {
+        return (idx + length - 1) / native_length - idx / native_length + 1;
+    };
+
+    double native_block_reads = 0;
+    for (const auto& block : blocks) {
+        native_block_reads +=
+              native_block_count(block.read_row_idx, block.read_size.row,
+                                 native_block_size.row) *
+              native_block_count(block.read_col_idx, block.read_size.col,
+                                 native_block_size.col);
+    }
+    double image_native_blocks =
+          native_block_count(0, image_size.row, native_block_size.row) *
+          native_block_count(0, image_size.col, native_block_size.col);
+    return native_block_reads / image_native_blocks;
+}
+
+}  // namespace
+
 InputStream::InputStream(const std::string& image_path,
                          const sirius::Size& block_size,
                          const sirius::Size& block_margin_size,
                          PaddingType block_padding_type)
-    : input_dataset_(gdal::LoadDataset(image_path)),
-      block_size_(block_size),
-      block_margin_size_(block_margin_size),
-      block_padding_type_(block_padding_type),
-      is_ended_(false),
-      row_idx_(0),
-      col_idx_(0) {
-    if (block_size_.row <= 0 || block_size_.col <= 0) {
+    : image_path_(image_path), input_dataset_(gdal::LoadDataset(image_path)) {
+    if (block_size.row <= 0 || block_size.col <= 0) {
         LOG("input_stream", error, "invalid block size");
         throw SiriusException("invalid block size");
     }
 
-    LOG("input_stream", info, "input image \"{}\", size: {}x{}", image_path,
-        input_dataset_->GetRasterYSize(), input_dataset_->GetRasterXSize());
-}
+    image_size_ = {input_dataset_->GetRasterYSize(),
+                   input_dataset_->GetRasterXSize()};
+    band_count_ = input_dataset_->GetRasterCount();
+    LOG("input_stream", info, "input image \"{}\", size: {}x{}, {} band(s)",
+        image_path, image_size_.row, image_size_.col, band_count_);
 
-StreamBlock InputStream::Read(std::error_code& ec) {
-    if (is_ended_) {
-        ec = make_error_code(CPLE_ObjectNull);
-        return {};
-    }
+    ComputeBlockGrid(block_size, block_margin_size, block_padding_type);
+    LOG("input_stream", info, "{} blocks to stream", blocks_.size());
 
-    int w = input_dataset_->GetRasterXSize();
-    int h = input_dataset_->GetRasterYSize();
-    int padded_block_w = block_size_.col + 2 * block_margin_size_.col;
-    int padded_block_h = block_size_.row + 2 * block_margin_size_.row;
+    native_block_size_ = GetNativeBlockSize(input_dataset_.get());
+    LOG("input_stream", info,
+        "native block size: {}x{}, {:.2f} reads per native block",
+        native_block_size_.row, native_block_size_.col,
+        ComputeNativeBlockReadRatio(blocks_, native_block_size_, image_size_));
+}
 
-    if (padded_block_w > w || padded_block_h > h) {
+void InputStream::ComputeBlockGrid(const sirius::Size& block_size,
+                                   const sirius::Size& block_margin_size,
+                                   PaddingType block_padding_type) {
+    int w = image_size_.col;
+    int h = image_size_.row;
+    if (block_size.col + 2 * block_margin_size.col > w ||
+        block_size.row + 2 * block_margin_size.row > h) {
         LOG("input_stream", critical,
             "requested block size ({}x{}) is bigger than source image ({}x{}). "
             "You should use regular processing",
-            padded_block_w, padded_block_h, w, h);
-        ec = make_error_code(CPLE_ObjectNull);
-        return {};
+            block_size.col + 2 * block_margin_size.col,
+            block_size.row + 2 * block_margin_size.row, w, h);
+        throw SiriusException("block size is bigger than source image");
     }
 
-    // resize block if needed
-    if (row_idx_ + padded_block_h > h) {
-        // assign size that can be read
-        padded_block_h -= (row_idx_ + padded_block_h - h);
+    int row_idx = 0;
+    int col_idx = 0;
+    bool is_ended = false;
+    while (!is_ended) {
+        int padded_block_w = block_size.col + 2 * block_margin_size.col;
+        int padded_block_h = block_size.row + 2 * block_margin_size.row;
 
-        if (padded_block_h < block_margin_size_.row) {
-            LOG("input_stream", error,
-                "block at coordinates ({}, {}) cannot be read because "
-                "available reading height {} is less than margin size {}",
-                row_idx_, col_idx_, padded_block_h, block_margin_size_.row);
-            ec = make_error_code(CPLE_ObjectNull);
-            return {};
+        // resize block if needed
+        if (row_idx + padded_block_h > h) {
+            // assign size that can be read
+            padded_block_h -= (row_idx + padded_block_h - h);
+
+            if (padded_block_h < block_margin_size.row) {
+                LOG("input_stream", error,
+                    "block at coordinates ({}, {}) cannot be read because "
+                    "available reading height {} is less than margin size {}",
+                    row_idx, col_idx, padded_block_h, block_margin_size.row);
+                throw SiriusException("block cannot be read");
+            }
+
+            if (padded_block_h > block_margin_size.row + block_size.row) {
+                // bottom margin is partly read. add missing margin
+                padded_block_h += (row_idx + block_size.row +
+                                   2 * block_margin_size.row - h);
+            } else {
+                padded_block_h += block_margin_size.row;
+            }
         }
+        if (col_idx + padded_block_w > w) {
+            padded_block_w -= (col_idx + padded_block_w - w);
 
-        if (padded_block_h > block_margin_size_.row + block_size_.row) {
-            // bottom margin is partly read. add missing margin
-            padded_block_h +=
-                  (row_idx_ + block_size_.row + 2 * block_margin_size_.row - h);
-        } else {
-            padded_block_h += block_margin_size_.row;
+            if (padded_block_w < block_margin_size.col) {
+                LOG("input_stream", error,
+                    "block at coordinates ({}, {}) cannot be read because "
+                    "available reading width {} is less than margin size {}",
+                    row_idx, col_idx, padded_block_w, block_margin_size.col);
+                throw SiriusException("block cannot be read");
+            }
+
+            if (padded_block_w > block_size.col + block_margin_size.col) {
+                padded_block_w += (col_idx + block_size.col +
+                                   2 * block_margin_size.col - w);
+            } else {
+                padded_block_w += block_margin_size.col;
+            }
         }
-    }
-    if (col_idx_ + padded_block_w > w) {
-        padded_block_w -= (col_idx_ + padded_block_w - w);
-
-        if (padded_block_w < block_margin_size_.col) {
-            LOG("ReadBlock", error,
-                "block at coordinates {}, {}, cannot be read because available "
-                "reading width {} is less than margin size {}",
-                row_idx_, col_idx_, padded_block_w, block_margin_size_.col);
-            ec = make_error_code(CPLE_ObjectNull);
-            return {};
+        Padding block_padding;
+        block_padding.type = block_padding_type;
+        int w_to_read = padded_block_w;
+        int h_to_read = padded_block_h;
+        // top padding needed
+        if (row_idx == 0) {
+            block_padding.top = block_margin_size.row;
+            h_to_read -= block_margin_size.row;
         }
 
-        if (padded_block_w > block_size_.col + block_margin_size_.col) {
-            padded_block_w +=
-                  (col_idx_ + block_size_.col + 2 * block_margin_size_.col - w);
-        } else {
-            padded_block_w += block_margin_size_.col;
+        // bottom padding needed
+        if (row_idx >= (h - block_size.row - 2 * block_margin_size.row)) {
+            block_padding.bottom = block_margin_size.row;
+            h_to_read -= (row_idx + padded_block_h - h);
         }
-    }
-    Padding block_padding;
-    block_padding.type = block_padding_type_;
-    int w_to_read = padded_block_w;
-    int h_to_read = padded_block_h;
-    // top padding needed
-    if (row_idx_ == 0) {
-        block_padding.top = block_margin_size_.row;
-        h_to_read -= block_margin_size_.row;
-    }
 
-    // bottom padding needed
-    if (row_idx_ >= (h - block_size_.row - 2 * block_margin_size_.row)) {
-        block_padding.bottom = block_margin_size_.row;
-        h_to_read -= (row_idx_ + padded_block_h - h);
-    }
+        // left padding needed
+        if (col_idx == 0) {
+            block_padding.left = block_margin_size.col;
+            w_to_read -= block_margin_size.col;
+        }
 
-    // left padding needed
-    if (col_idx_ == 0) {
-        block_padding.left = block_margin_size_.col;
-        w_to_read -= block_margin_size_.col;
-    }
+        // right padding needed
+        if (col_idx >= (w - block_size.col - 2 * block_margin_size.col)) {
+            block_padding.right = block_margin_size.col;
+            w_to_read -= (col_idx + padded_block_w - w);
+        }
 
-    // right padding needed
-    if (col_idx_ >= (w - block_size_.col - 2 * block_margin_size_.col)) {
-        block_padding.right = block_margin_size_.col;
-        w_to_read -= (col_idx_ + padded_block_w - w);
-    }
+        StreamBlockDescriptor block_descriptor;
+        block_descriptor.read_row_idx = row_idx;
+        block_descriptor.read_col_idx = col_idx;
+        block_descriptor.read_size = {h_to_read, w_to_read};
+        block_descriptor.row_idx =
+              (row_idx == 0) ? 0 : row_idx + block_margin_size.row;
+        block_descriptor.col_idx =
+              (col_idx == 0) ? 0 : col_idx + block_margin_size.col;
+        block_descriptor.padding = block_padding;
+        blocks_.push_back(block_descriptor);
 
-    Image output_buffer({h_to_read, w_to_read});
+        if (((row_idx + padded_block_h - block_margin_size.row) >= h) &&
+            ((col_idx + padded_block_w - block_margin_size.col) >= w)) {
+            is_ended = true;
+        }
 
-    CPLErr err = input_dataset_->GetRasterBand(1)->RasterIO(
-          GF_Read, col_idx_, row_idx_, w_to_read, h_to_read,
-          output_buffer.data.data(), w_to_read, h_to_read, GDT_Float64, 0, 0);
+        if (col_idx >= w - block_size.col - block_margin_size.col) {
+            col_idx = 0;
+            if (row_idx == 0) {
+                row_idx += block_size.row - block_margin_size.row;
+            } else {
+                row_idx += block_size.row;
+            }
+        } else {
+            if (col_idx == 0) {
+                col_idx += block_size.col - block_margin_size.col;
+            } else {
+                col_idx += block_size.col;
+            }
+        }
+    }
+}
 
-    if (err) {
-        LOG("input_stream", error,
-            "GDAL error: {} - could not read from the dataset", err);
-        ec = make_error_code(err);
+template <typename T>
+BasicStreamBlock<T> InputStream::Read(std::error_code& ec) {
+    if (IsAtEnd()) {
+        ec = make_error_code(CPLE_ObjectNull);
         return {};
     }
+    return Read<T>(blocks_[next_block_idx_++], input_dataset_.get(), nullptr,
+                   ec);
+}
 
-    int block_row_idx = (row_idx_ == 0) ? 0 : row_idx_ + block_margin_size_.row;
-    int block_col_idx = (col_idx_ == 0) ? 0 : col_idx_ + block_margin_size_.col;
-
-    StreamBlock output_block(std::move(output_buffer), block_row_idx,
-                             block_col_idx, block_padding);
+DatasetUPtr InputStream::OpenDataset() const {
+    return gdal::LoadDataset(image_path_);
+}
 
-    if (((row_idx_ + padded_block_h - block_margin_size_.row) >= h) &&
-        ((col_idx_ + padded_block_w - block_margin_size_.col) >= w)) {
-        is_ended_ = true;
-    }
+template <typename T>
+BasicStreamBlock<T> InputStream::Read(
+      const StreamBlockDescriptor& block_descriptor, ::GDALDataset* dataset,
+      BasicTileCache<T>* tile_cache, std::error_code& ec) const {
+    const auto& read_size = block_descriptor.read_size;
+    std::vector<BasicImage<T>> band_images(band_count_);
 
-    if (col_idx_ >= w - block_size_.col - block_margin_size_.col) {
-        col_idx_ = 0;
-        if (row_idx_ == 0) {
-            row_idx_ += block_size_.row - block_margin_size_.row;
-        } else {
-            row_idx_ += block_size_.row;
+    for (int band = 1; band <= band_count_; ++band) {
+        auto& band_image = band_images[band - 1];
+        if (tile_cache != nullptr) {
+            band_image = tile_cache->Read(dataset, band, block_descriptor, ec);
+            if (ec) {
+                return {};
+            }
+            continue;
         }
-    } else {
-        if (col_idx_ == 0) {
-            col_idx_ += block_size_.col - block_margin_size_.col;
-        } else {
-            col_idx_ += block_size_.col;
+
+        band_image = BasicImage<T>(read_size);
+        CPLErr err = dataset->GetRasterBand(band)->RasterIO(
+              GF_Read, block_descriptor.read_col_idx,
+              block_descriptor.read_row_idx, read_size.col, read_size.row,
+              band_image.data.data(), read_size.col, read_size.row,
+              DataType<T>::value, 0, 0);
+        if (err) {
+            LOG("input_stream", error,
+                "GDAL error: {} - could not read band {} from the dataset",
+                err, band);
+            ec = make_error_code(err);
+            return {};
         }
     }
 
     LOG("input_stream", debug, "reading block of size {}x{} at ({},{})",
-        output_block.buffer.size.row, output_block.buffer.size.col,
-        output_block.row_idx, output_block.col_idx);
+        read_size.row, read_size.col, block_descriptor.row_idx,
+        block_descriptor.col_idx);
 
     ec = make_error_code(CPLE_None);
-    return output_block;
+    return {std::move(band_images), block_descriptor.row_idx,
+            block_descriptor.col_idx, block_descriptor.padding};
 }
 
+template StreamBlock InputStream::Read<double>(std::error_code& ec);
+template FloatStreamBlock InputStream::Read<float>(std::error_code& ec);
+template StreamBlock InputStream::Read<double>(
+      const StreamBlockDescriptor& block_descriptor, ::GDALDataset* dataset,
+      TileCache* tile_cache, std::error_code& ec) const;
+template FloatStreamBlock InputStream::Read<float>(
+      const StreamBlockDescriptor& block_descriptor, ::GDALDataset* dataset,
+      FloatTileCache* tile_cache, std::error_code& ec) const;
+
 }  // namespace gdal
 }  // namespace sirius
@@ -22,13 +22,15 @@
 #ifndef SIRIUS_GDAL_INPUT_STREAM_H_
 #define SIRIUS_GDAL_INPUT_STREAM_H_
 
-#include <mutex>
+#include <string>
 #include <system_error>
+#include <vector>
 
 #include "sirius/image.h"
 #include "sirius/types.h"
 
 #include "sirius/gdal/stream_block.h"
+#include "sirius/gdal/tile_cache.h"
 #include "sirius/gdal/types.h"
 
 namespace sirius {
@@ -36,15 +38,22 @@ namespace gdal {
 
 /**
  * \brief Stream an image in block
+ *
+ * The block grid is computed at instantiation and does not change
+ * afterwards. Blocks can be read sequentially with Read(ec), or in any order
+ * and from any thread with Read(block, dataset, ec) given a dataset handle
+ * per thread.
  */
 class InputStream {
   public:
     /**
-     * \brief Instanciate an InputStreamer and set its block size
+     * \brief Instanciate an InputStreamer and compute its block grid
      * \param image_path path to the input image
      * \param block_size blocks size
      * \param block_margin_size block margin size
      * \param block_padding_type block padding type
+     *
+     * \throw SiriusException if the image cannot be split into blocks
      */
     InputStream(const std::string& image_path, const sirius::Size& block_size,
                 const sirius::Size& block_margin_size,
@@ -61,32 +70,88 @@ class InputStream {
      * \brief Get the size of the input file
      * \return input file size
      */
-    sirius::Size Size() {
-        return {input_dataset_->GetRasterYSize(),
-                input_dataset_->GetRasterXSize()};
+    sirius::Size Size() const { return image_size_; }
+
+    /**
+     * \brief Get the number of bands of the input file
+     * \return band count
+     */
+    int band_count() const { return band_count_; }
+
+    /**
+     * \brief Get the native block size (tile or strip) of the input file
+     * \return native block size
+     */
+    sirius::Size native_block_size() const { return native_block_size_; }
+
+    /**
+     * \brief Block grid of the image in scan order
+     * \return block descriptors
+     */
+    const std::vector<StreamBlockDescriptor>& blocks() const {
+        return blocks_;
     }
 
     /**
-     * \brief Read a block from the image
+     * \brief Read all the bands of the next block from the image
+     * \tparam T block pixel type (double or float)
      * \param ec error code if operation failed
      * \return block read
      */
-    StreamBlock Read(std::error_code& ec);
+    template <typename T = double>
+    BasicStreamBlock<T> Read(std::error_code& ec);
+
+    /**
+     * \brief Open a new handle on the input image
+     *
+     * GDAL dataset handles cannot be shared between threads: each reading
+     * thread needs its own handle.
+     *
+     * \return dataset handle
+     *
+     * \throw gdal::Exception if the image cannot be opened
+     */
+    DatasetUPtr OpenDataset() const;
+
+    /**
+     * \brief Read all the bands of a block from the image
+     *
+     * \remark This method is reentrant
+     *
+     * \tparam T block pixel type (double or float)
+     * \param block_descriptor block to read, cf. blocks()
+     * \param dataset handle on the input image owned by the calling thread,
+     *        cf. OpenDataset
+     * \param tile_cache tile cache shared by the reading threads, nullptr to
+     *        read the image directly
+     * \param ec error code if operation failed
+     * \return block read
+     */
+    template <typename T = double>
+    BasicStreamBlock<T> Read(const StreamBlockDescriptor& block_descriptor,
+                             ::GDALDataset* dataset,
+                             BasicTileCache<T>* tile_cache,
+                             std::error_code& ec) const;
 
     /**
      * \brief Indicate end of image
      * \return boolean if end is reached
      */
-    bool IsAtEnd() { return is_ended_; }
+    bool IsAtEnd() const { return next_block_idx_ >= blocks_.size(); }
+
+  private:
+    void ComputeBlockGrid(const sirius::Size& block_size,
+                          const sirius::Size& block_margin_size,
+                          PaddingType block_padding_type);
 
   private:
+    std::string image_path_;
     gdal::DatasetUPtr input_dataset_;
-    sirius::Size block_size_{256, 256};
-    sirius::Size block_margin_size_;
-    PaddingType block_padding_type_;
-    bool is_ended_ = false;
-    int row_idx_ = 0;
-    int col_idx_ = 0;
+    sirius::Size image_size_;
+    int band_count_ = 1;
+    sirius::Size native_block_size_;
+    std::vector<StreamBlockDescriptor> blocks_;
+    std::size_t next_block_idx_ = 0;
 };
 
 }  // namespace gdal
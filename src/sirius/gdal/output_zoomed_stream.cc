@@ -21,6 +21,10 @@
 
 #include "sirius/gdal/output_zoomed_stream.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
 #include "sirius/gdal/error_code.h"
 #include "sirius/gdal/wrapper.h"
 
@@ -41,36 +45,88 @@ OutputZoomedStream::OutputZoomedStream(const std::string& input_path,
           std::ceil(input_dataset->GetRasterXSize() * zoom_ratio_.ratio());
 
     auto geo_ref = gdal::ComputeZoomedGeoReference(input_path, zoom_ratio);
-    output_dataset_ =
-          gdal::CreateDataset(output_path, output_w, output_h, 1, geo_ref);
-    LOG("output_stream", info, "output image \"{}\", size: {}x{}", output_path,
-        output_h, output_w);
+    output_size_ = {output_h, output_w};
+    band_count_ = input_dataset->GetRasterCount();
+    output_dataset_ = gdal::CreateDataset(output_path, output_w, output_h,
+                                          band_count_, geo_ref);
+    native_block_size_ = gdal::GetNativeBlockSize(output_dataset_.get());
+    LOG("output_stream", info, "output image \"{}\", size: {}x{}, {} band(s)",
+        output_path, output_h, output_w, band_count_);
+}
+
+int OutputZoomedStream::OutputRowIndex(int row_idx) const {
+    return std::floor(row_idx * zoom_ratio_.input_resolution() /
+                      static_cast<double>(zoom_ratio_.output_resolution()));
+}
+
+int OutputZoomedStream::OutputColIndex(int col_idx) const {
+    return std::floor(col_idx * zoom_ratio_.input_resolution() /
+                      static_cast<double>(zoom_ratio_.output_resolution()));
+}
+
+template <typename T>
+void OutputZoomedStream::Write(BasicStreamBlock<T>&& block,
+                               std::error_code& ec) {
+    Write(OutputRowIndex(block.row_idx), OutputColIndex(block.col_idx),
+          block.bands, ec);
 }
 
-void OutputZoomedStream::Write(StreamBlock&& block, std::error_code& ec) {
-    int out_row_idx =
-          std::floor(block.row_idx * zoom_ratio_.input_resolution() /
-                     static_cast<double>(zoom_ratio_.output_resolution()));
-    int out_col_idx =
-          std::floor(block.col_idx * zoom_ratio_.input_resolution() /
-                     static_cast<double>(zoom_ratio_.output_resolution()));
-
-    LOG("output_stream", debug, "writing {}x{} at {}x{}", block.buffer.size.row,
-        block.buffer.size.col, out_row_idx, out_col_idx);
-
-    CPLErr err = output_dataset_->GetRasterBand(1)->RasterIO(
-          GF_Write, out_col_idx, out_row_idx, block.buffer.size.col,
-          block.buffer.size.row, const_cast<double*>(block.buffer.data.data()),
-          block.buffer.size.col, block.buffer.size.row, GDT_Float64, 0, 0,
-          NULL);
-    if (err) {
+template <typename T>
+void OutputZoomedStream::Write(int row_idx, int col_idx,
+                               const std::vector<BasicImage<T>>& band_images,
+                               std::error_code& ec) {
+    if (static_cast<int>(band_images.size()) != band_count_) {
         LOG("output_zoomed_stream", error,
-            "GDAL error: {} - could not write to the given dataset", err);
-        ec = make_error_code(err);
+            "{} band(s) to write in an image of {} band(s)",
+            band_images.size(), band_count_);
+        ec = make_error_code(CPLE_IllegalArg);
         return;
     }
+
+    std::lock_guard<std::mutex> lock(output_dataset_mutex_);
+    for (int band = 1; band <= band_count_; ++band) {
+        const auto& image = band_images[band - 1];
+        LOG("output_stream", debug, "writing {}x{} at {}x{} in band {}",
+            image.size.row, image.size.col, row_idx, col_idx, band);
+
+        auto start = std::chrono::steady_clock::now();
+        CPLErr err = output_dataset_->GetRasterBand(band)->RasterIO(
+              GF_Write, col_idx, row_idx, image.size.col, image.size.row,
+              const_cast<T*>(image.data.data()), image.size.col,
+              image.size.row, DataType<T>::value, 0, 0, NULL);
+        std::chrono::duration<double> duration =
+              std::chrono::steady_clock::now() - start;
+        if (err) {
+            LOG("output_zoomed_stream", error,
+                "GDAL error: {} - could not write to the given dataset", err);
+            ec = make_error_code(err);
+            return;
+        }
+
+        ++stats_.write_count;
+        stats_.written_bytes += image.CellCount() * sizeof(T);
+        stats_.write_duration += duration.count();
+        stats_.max_write_duration =
+              std::max(stats_.max_write_duration, duration.count());
+    }
     ec = make_error_code(CPLE_None);
 }
 
+OutputStreamStats OutputZoomedStream::GetStats() const {
+    std::lock_guard<std::mutex> lock(output_dataset_mutex_);
+    return stats_;
+}
+
+template void OutputZoomedStream::Write<double>(StreamBlock&& block,
+                                                std::error_code& ec);
+template void OutputZoomedStream::Write<float>(FloatStreamBlock&& block,
+                                               std::error_code& ec);
+template void OutputZoomedStream::Write<double>(
+      int row_idx, int col_idx, const std::vector<Image>& band_images,
+      std::error_code& ec);
+template void OutputZoomedStream::Write<float>(
+      int row_idx, int col_idx, const std::vector<FloatImage>& band_images,
+      std::error_code& ec);
+
 }  // namespace gdal
 }  // namespace sirus
@@ -22,10 +22,13 @@
 #ifndef SIRIUS_GDAL_OUTPUT_ZOOMED_STREAM_H_
 #define SIRIUS_GDAL_OUTPUT_ZOOMED_STREAM_H_
 
+#include <cstddef>
 #include <mutex>
-#include <stack>
+#include <string>
 #include <system_error>
+#include <vector>
 
+#include "sirius/image.h"
 #include "sirius/types.h"
 
 #include "sirius/gdal/stream_block.h"
@@ -34,11 +37,38 @@
 namespace sirius {
 namespace gdal {
 
+/**
+ * \brief Statistics of the writes in the output image
+ */
+struct OutputStreamStats {
+    /**
+     * \brief Number of RasterIO writes
+     */
+    std::size_t write_count = 0;
+    /**
+     * \brief Bytes passed to RasterIO writes
+     */
+    std::size_t written_bytes = 0;
+    /**
+     * \brief Cumulated and max duration of a RasterIO write in seconds
+     */
+    double write_duration = 0.0;
+    double max_write_duration = 0.0;
+};
+
 /**
  * \brief Write a zoomed image by block
+ *
+ * \remark Write methods are thread safe: writes on the dataset are
+ *         serialized
  */
 class OutputZoomedStream {
   public:
+    /**
+     * \brief Output pixel type
+     */
+    using OutputType = float;
+
     OutputZoomedStream(const std::string& input_path,
                        const std::string& output_path,
                        const ZoomRatio& zoom_ratio);
@@ -49,16 +79,74 @@ class OutputZoomedStream {
     OutputZoomedStream(OutputZoomedStream&&) = delete;
     OutputZoomedStream& operator=(OutputZoomedStream&&) = delete;
 
+    /**
+     * \brief Get the size of the output file
+     * \return output file size
+     */
+    sirius::Size Size() const { return output_size_; }
+
+    /**
+     * \brief Get the number of bands of the output file (same as the input)
+     * \return band count
+     */
+    int band_count() const { return band_count_; }
+
+    /**
+     * \brief Get the native block size (tile or strip) of the output file
+     * \return native block size
+     */
+    sirius::Size native_block_size() const { return native_block_size_; }
+
+    /**
+     * \brief Row of a zoomed block in the output image
+     * \param row_idx row of the block in the input image
+     * \return output row
+     */
+    int OutputRowIndex(int row_idx) const;
+
+    /**
+     * \brief Column of a zoomed block in the output image
+     * \param col_idx column of the block in the input image
+     * \return output column
+     */
+    int OutputColIndex(int col_idx) const;
+
     /**
      * \brief Write a zoomed block in the output file
      * \param block block to write
      * \param ec error code if operation failed
      */
-    void Write(StreamBlock&& block, std::error_code& ec);
+    template <typename T>
+    void Write(BasicStreamBlock<T>&& block, std::error_code& ec);
+
+    /**
+     * \brief Write the bands of an image at a given position of the output
+     *        file
+     * \param row_idx output row of the top left corner
+     * \param col_idx output column of the top left corner
+     * \param band_images images to write, one per band
+     * \param ec error code if operation failed
+     */
+    template <typename T>
+    void Write(int row_idx, int col_idx,
+               const std::vector<BasicImage<T>>& band_images,
+               std::error_code& ec);
+
+    /**
+     * \brief Statistics of the writes
+     * \return stats
+     */
+    OutputStreamStats GetStats() const;
 
   private:
     gdal::DatasetUPtr output_dataset_;
     ZoomRatio zoom_ratio_;
+    sirius::Size output_size_;
+    sirius::Size native_block_size_;
+    int band_count_ = 1;
+
+    mutable std::mutex output_dataset_mutex_;
+    OutputStreamStats stats_;
 };
 
 }  // namespace gdal
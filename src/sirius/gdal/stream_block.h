@@ -22,47 +22,89 @@
 #ifndef SIRIUS_GDAL_STREAM_H_
 #define SIRIUS_GDAL_STREAM_H_
 
+#include <vector>
+
 #include "sirius/image.h"
 
 namespace sirius {
 namespace gdal {
 
+/**
+ * \brief Position of a stream block in the input image
+ */
+struct StreamBlockDescriptor {
+    /**
+     * \brief Top left corner of the window to read in the input image
+     */
+    int read_row_idx = 0;
+    int read_col_idx = 0;
+    /**
+     * \brief Size of the window to read in the input image
+     */
+    Size read_size{};
+    /**
+     * \brief Position of the block, cf. BasicStreamBlock
+     */
+    int row_idx = 0;
+    int col_idx = 0;
+    Padding padding{};
+};
+
+/**
+ * \brief Batch of stream blocks zoomed together
+ *
+ * Blocks of a batch have the same read size and padding.
+ */
+using StreamBlockBatch = std::vector<StreamBlockDescriptor>;
+
 /**
  * \brief Stream block
+ *
+ * A block carries all the bands of the image: band images share the same
+ * size and position.
  */
-struct StreamBlock {
-    StreamBlock() = default;
+template <typename T>
+struct BasicStreamBlock {
+    BasicStreamBlock() = default;
 
     /**
-     * \brief Instanciate a stream block from its block image and its position
+     * \brief Instanciate a stream block from its band images and its position
      *        in the input image
      *
-     * \param block_image image buffer of this block
+     * \param band_images image buffers of this block, one per band
      * \param row_idx row index of the top left corner in the input image
      * \param col_idx col index of the top left corner in the input image
      * \param padding required filter padding
      */
-    StreamBlock(Image&& i_block_image, int i_row_idx, int i_col_idx,
-                const Padding& i_padding)
-        : buffer(std::move(i_block_image)),
+    BasicStreamBlock(std::vector<BasicImage<T>>&& i_band_images,
+                     int i_row_idx, int i_col_idx, const Padding& i_padding)
+        : bands(std::move(i_band_images)),
           row_idx(i_row_idx),
           col_idx(i_col_idx),
           padding(i_padding),
           is_initialized(true) {}
 
-    ~StreamBlock() = default;
-    StreamBlock(const StreamBlock&) = default;
-    StreamBlock& operator=(const StreamBlock&) = default;
-    StreamBlock(StreamBlock&&) = default;
-    StreamBlock& operator=(StreamBlock&&) = default;
+    ~BasicStreamBlock() = default;
+    BasicStreamBlock(const BasicStreamBlock&) = default;
+    BasicStreamBlock& operator=(const BasicStreamBlock&) = default;
+    BasicStreamBlock(BasicStreamBlock&&) = default;
+    BasicStreamBlock& operator=(BasicStreamBlock&&) = default;
 
-    Image buffer{};
+    /**
+     * \brief Size of the band images
+     */
+    Size size() const { return bands.empty() ? Size() : bands.front().size; }
+
+    std::vector<BasicImage<T>> bands{};
     int row_idx = 0;
     int col_idx = 0;
     Padding padding{};
     bool is_initialized = false;
 };
 
+using StreamBlock = BasicStreamBlock<double>;
+using FloatStreamBlock = BasicStreamBlock<float>;
+
 }  // namespace gdal
 }  // namespace sirius
 
@@ -0,0 +1,256 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sirius/gdal/tile_cache.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "sirius/gdal/error_code.h"
+
+#include "sirius/utils/log.h"
+
+namespace sirius {
+namespace gdal {
+
+template <typename T>
+constexpr std::size_t BasicTileCache<T>::kDefaultMaxCachedBytes;
+template <typename T>
+constexpr int BasicTileCache<T>::kMinTileLength;
+
+template <typename T>
+BasicTileCache<T>::BasicTileCache(
+      const Size& image_size, const Size& native_block_size,
+      const std::vector<StreamBlockDescriptor>& blocks,
+      std::size_t max_cached_bytes)
+    : image_size_(image_size), max_cached_bytes_(max_cached_bytes) {
+    // group small native blocks (e.g. one row strips)
+    auto cache_tile_length = [](int native_length, int image_length) {
+        native_length = std::max(native_length, 1);
+        int native_block_count =
+              (kMinTileLength + native_length - 1) / native_length;
+        return std::min(native_block_count * native_length, image_length);
+    };
+    tile_size_ = {cache_tile_length(native_block_size.row, image_size.row),
+                  cache_tile_length(native_block_size.col, image_size.col)};
+    tile_count_ = {(image_size.row + tile_size_.row - 1) / tile_size_.row,
+                   (image_size.col + tile_size_.col - 1) / tile_size_.col};
+
+    tile_read_counts_.assign(tile_count_.CellCount(), 0);
+    for (const auto& block : blocks) {
+        int first_tile_row = block.read_row_idx / tile_size_.row;
+        int last_tile_row =
+              (block.read_row_idx + block.read_size.row - 1) / tile_size_.row;
+        int first_tile_col = block.read_col_idx / tile_size_.col;
+        int last_tile_col =
+              (block.read_col_idx + block.read_size.col - 1) / tile_size_.col;
+        for (int tile_row = first_tile_row; tile_row <= last_tile_row;
+             ++tile_row) {
+            for (int tile_col = first_tile_col; tile_col <= last_tile_col;
+                 ++tile_col) {
+                ++tile_read_counts_[tile_row * tile_count_.col + tile_col];
+            }
+        }
+    }
+
+    LOG("tile_cache", info, "cache tile size: {}x{}, memory budget: {} MiB",
+        tile_size_.row, tile_size_.col, max_cached_bytes_ / (1024 * 1024));
+}
+
+template <typename T>
+BasicImage<T> BasicTileCache<T>::Read(
+      ::GDALDataset* dataset, int band,
+      const StreamBlockDescriptor& block_descriptor, std::error_code& ec) {
+    const int read_row_idx = block_descriptor.read_row_idx;
+    const int read_col_idx = block_descriptor.read_col_idx;
+    const auto& read_size = block_descriptor.read_size;
+    BasicImage<T> window(read_size);
+
+    int first_tile_row = read_row_idx / tile_size_.row;
+    int last_tile_row = (read_row_idx + read_size.row - 1) / tile_size_.row;
+    int first_tile_col = read_col_idx / tile_size_.col;
+    int last_tile_col = (read_col_idx + read_size.col - 1) / tile_size_.col;
+    for (int tile_row = first_tile_row; tile_row <= last_tile_row;
+         ++tile_row) {
+        for (int tile_col = first_tile_col; tile_col <= last_tile_col;
+             ++tile_col) {
+            TileKey key(band, tile_row, tile_col);
+            auto tile = AcquireTile(dataset, key, ec);
+            if (!tile) {
+                return {};
+            }
+
+            // copy the intersection of the tile and the window
+            const auto& tile_image = tile->image;
+            int begin_row = std::max(read_row_idx, tile->row_idx);
+            int end_row = std::min(read_row_idx + read_size.row,
+                                   tile->row_idx + tile_image.size.row);
+            int begin_col = std::max(read_col_idx, tile->col_idx);
+            int end_col = std::min(read_col_idx + read_size.col,
+                                   tile->col_idx + tile_image.size.col);
+            for (int row = begin_row; row < end_row; ++row) {
+                auto src = tile_image.data.begin() +
+                           (row - tile->row_idx) * tile_image.size.col +
+                           (begin_col - tile->col_idx);
+                std::copy(src, src + (end_col - begin_col),
+                          window.data.begin() +
+                                (row - read_row_idx) * read_size.col +
+                                (begin_col - read_col_idx));
+            }
+
+            ReleaseTile(key);
+        }
+    }
+
+    ec = make_error_code(CPLE_None);
+    return window;
+}
+
+template <typename T>
+TileCacheStats BasicTileCache<T>::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+template <typename T>
+typename BasicTileCache<T>::TilePtr BasicTileCache<T>::AcquireTile(
+      ::GDALDataset* dataset, const TileKey& key, std::error_code& ec) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    int tile_row = std::get<1>(key);
+    int tile_col = std::get<2>(key);
+    if (remaining_read_counts_.count(key) == 0) {
+        // windows outside of the block grid read the tile once
+        remaining_read_counts_[key] = std::max(
+              tile_read_counts_[tile_row * tile_count_.col + tile_col], 1);
+    }
+
+    auto entry_it = entries_.find(key);
+    if (entry_it != entries_.end()) {
+        auto& entry = entry_it->second;
+        ++stats_.hit_count;
+        stats_.saved_bytes += entry.bytes;
+        lru_keys_.splice(lru_keys_.begin(), lru_keys_, entry.lru_it);
+        auto tile_future = entry.tile;
+        lock.unlock();
+
+        // wait for the thread which decodes the tile
+        auto tile = tile_future.get();
+        if (!tile) {
+            ec = make_error_code(CPLE_FileIO);
+        }
+        return tile;
+    }
+
+    ++stats_.miss_count;
+    std::promise<TilePtr> tile_promise;
+    Entry entry;
+    entry.tile = tile_promise.get_future().share();
+    int tile_h =
+          std::min(tile_size_.row, image_size_.row - tile_row * tile_size_.row);
+    int tile_w =
+          std::min(tile_size_.col, image_size_.col - tile_col * tile_size_.col);
+    entry.bytes = static_cast<std::size_t>(tile_h) * tile_w * sizeof(T);
+    lru_keys_.push_front(key);
+    entry.lru_it = lru_keys_.begin();
+    cached_bytes_ += entry.bytes;
+    entries_.emplace(key, entry);
+
+    // evict least recently used tiles, except the new one
+    while (cached_bytes_ > max_cached_bytes_ && lru_keys_.back() != key) {
+        ++stats_.evicted_count;
+        EraseEntry(entries_.find(lru_keys_.back()));
+    }
+    stats_.max_cached_bytes = std::max(stats_.max_cached_bytes, cached_bytes_);
+    lock.unlock();
+
+    auto tile = DecodeTile(dataset, key, ec);
+    tile_promise.set_value(tile);
+    if (!tile) {
+        // do not keep failed tiles
+        lock.lock();
+        entry_it = entries_.find(key);
+        if (entry_it != entries_.end() &&
+            entry_it->second.tile.wait_for(std::chrono::seconds(0)) ==
+                  std::future_status::ready &&
+            !entry_it->second.tile.get()) {
+            EraseEntry(entry_it);
+        }
+    }
+    return tile;
+}
+
+template <typename T>
+typename BasicTileCache<T>::TilePtr BasicTileCache<T>::DecodeTile(
+      ::GDALDataset* dataset, const TileKey& key, std::error_code& ec) const {
+    auto tile = std::make_shared<Tile>();
+    tile->row_idx = std::get<1>(key) * tile_size_.row;
+    tile->col_idx = std::get<2>(key) * tile_size_.col;
+    Size size(std::min(tile_size_.row, image_size_.row - tile->row_idx),
+              std::min(tile_size_.col, image_size_.col - tile->col_idx));
+    tile->image = BasicImage<T>(size);
+
+    CPLErr err = dataset->GetRasterBand(std::get<0>(key))
+                       ->RasterIO(GF_Read, tile->col_idx, tile->row_idx,
+                                  size.col, size.row, tile->image.data.data(),
+                                  size.col, size.row, DataType<T>::value, 0,
+                                  0);
+    if (err) {
+        LOG("tile_cache", error,
+            "GDAL error: {} - could not read tile at ({},{})", err,
+            tile->row_idx, tile->col_idx);
+        ec = make_error_code(err);
+        return nullptr;
+    }
+
+    ec = make_error_code(CPLE_None);
+    return tile;
+}
+
+template <typename T>
+void BasicTileCache<T>::ReleaseTile(const TileKey& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto remaining_it = remaining_read_counts_.find(key);
+    if (remaining_it == remaining_read_counts_.end() ||
+        --remaining_it->second > 0) {
+        return;
+    }
+
+    // last read of the tile
+    remaining_read_counts_.erase(remaining_it);
+    auto entry_it = entries_.find(key);
+    if (entry_it != entries_.end()) {
+        EraseEntry(entry_it);
+    }
+}
+
+template <typename T>
+void BasicTileCache<T>::EraseEntry(
+      typename std::map<TileKey, Entry>::iterator entry_it) {
+    cached_bytes_ -= entry_it->second.bytes;
+    lru_keys_.erase(entry_it->second.lru_it);
+    entries_.erase(entry_it);
+}
+
+template class BasicTileCache<double>;
+template class BasicTileCache<float>;
+
+}  // namespace gdal
+}  // namespace sirius
@@ -0,0 +1,183 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIRIUS_GDAL_TILE_CACHE_H_
+#define SIRIUS_GDAL_TILE_CACHE_H_
+
+#include <cstddef>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+#include "sirius/image.h"
+#include "sirius/types.h"
+
+#include "sirius/gdal/stream_block.h"
+#include "sirius/gdal/types.h"
+
+namespace sirius {
+namespace gdal {
+
+/**
+ * \brief Statistics of a tile cache
+ */
+struct TileCacheStats {
+    /**
+     * \brief Tile requests served from the cache
+     */
+    std::size_t hit_count = 0;
+    /**
+     * \brief Tile requests which decoded the tile
+     */
+    std::size_t miss_count = 0;
+    /**
+     * \brief Bytes served from the cache instead of being decoded again
+     */
+    std::size_t saved_bytes = 0;
+    /**
+     * \brief Tiles evicted by the memory budget before their last use
+     */
+    std::size_t evicted_count = 0;
+    /**
+     * \brief Peak size of the cached tiles in bytes
+     */
+    std::size_t max_cached_bytes = 0;
+};
+
+/**
+ * \brief Cache of decoded tiles shared between the block reads of a stream
+ *
+ * The image is split into cache tiles aligned on its native blocks (tiles or
+ * strips). Small native blocks are grouped so that a cache tile is at least
+ * kMinTileLength pixels high and wide. Windows are assembled from cache
+ * tiles, so that the margins shared by neighbouring blocks are decoded once.
+ *
+ * The block grid gives the number of reads of each tile: a tile is dropped
+ * after its last read. Tiles are also evicted in LRU order when the cached
+ * tiles exceed the memory budget.
+ *
+ * \remark Read is thread safe. Concurrent requests of the same tile wait for
+ *         a single decoding.
+ *
+ * \tparam T pixel type (double or float)
+ */
+template <typename T>
+class BasicTileCache {
+  public:
+    static constexpr std::size_t kDefaultMaxCachedBytes = 256 * 1024 * 1024;
+    static constexpr int kMinTileLength = 64;
+
+    /**
+     * \brief Instanciate a tile cache for a block grid
+     * \param image_size size of the image
+     * \param native_block_size native block size of the image
+     * \param blocks block grid of the stream, cf. InputStream::blocks
+     * \param max_cached_bytes memory budget of the cached tiles
+     */
+    BasicTileCache(const Size& image_size, const Size& native_block_size,
+                   const std::vector<StreamBlockDescriptor>& blocks,
+                   std::size_t max_cached_bytes = kDefaultMaxCachedBytes);
+
+    ~BasicTileCache() = default;
+    BasicTileCache(const BasicTileCache&) = delete;
+    BasicTileCache& operator=(const BasicTileCache&) = delete;
+    BasicTileCache(BasicTileCache&&) = delete;
+    BasicTileCache& operator=(BasicTileCache&&) = delete;
+
+    /**
+     * \brief Size of the cache tiles
+     * \return cache tile size
+     */
+    Size tile_size() const { return tile_size_; }
+
+    /**
+     * \brief Read the window of a block through the cache
+     * \param dataset handle on the image owned by the calling thread
+     * \param band band index (starting at 1)
+     * \param block_descriptor block to read, cf. InputStream::blocks
+     * \param ec error code if a tile could not be decoded
+     * \return window of the block
+     */
+    BasicImage<T> Read(::GDALDataset* dataset, int band,
+                       const StreamBlockDescriptor& block_descriptor,
+                       std::error_code& ec);
+
+    /**
+     * \brief Get the statistics of the cache
+     * \return cache statistics
+     */
+    TileCacheStats GetStats() const;
+
+  private:
+    struct Tile {
+        int row_idx = 0;
+        int col_idx = 0;
+        BasicImage<T> image{};
+    };
+    using TilePtr = std::shared_ptr<const Tile>;
+    // band, tile row, tile col
+    using TileKey = std::tuple<int, int, int>;
+
+    struct Entry {
+        std::shared_future<TilePtr> tile;
+        std::size_t bytes = 0;
+        std::list<TileKey>::iterator lru_it;
+    };
+
+    TilePtr AcquireTile(::GDALDataset* dataset, const TileKey& key,
+                        std::error_code& ec);
+
+    TilePtr DecodeTile(::GDALDataset* dataset, const TileKey& key,
+                       std::error_code& ec) const;
+
+    void ReleaseTile(const TileKey& key);
+
+    void EraseEntry(typename std::map<TileKey, Entry>::iterator entry_it);
+
+  private:
+    Size image_size_;
+    Size tile_size_;
+    Size tile_count_;
+    std::size_t max_cached_bytes_;
+    // reads of each tile by the block grid, in scan order of the tiles
+    std::vector<int> tile_read_counts_;
+
+    mutable std::mutex mutex_;
+    std::map<TileKey, Entry> entries_;
+    std::map<TileKey, int> remaining_read_counts_;
+    // most recently used tile first
+    std::list<TileKey> lru_keys_;
+    std::size_t cached_bytes_ = 0;
+    TileCacheStats stats_;
+};
+
+using TileCache = BasicTileCache<double>;
+using FloatTileCache = BasicTileCache<float>;
+
+}  // namespace gdal
+}  // namespace sirius
+
+#endif  // SIRIUS_GDAL_TILE_CACHE_H_
@@ -44,6 +44,22 @@ struct DatasetDeleter {
 
 using DatasetUPtr = std::unique_ptr<::GDALDataset, detail::DatasetDeleter>;
 
+/**
+ * \brief GDAL data type matching a pixel type
+ */
+template <typename T>
+struct DataType;
+
+template <>
+struct DataType<double> {
+    static constexpr ::GDALDataType value = GDT_Float64;
+};
+
+template <>
+struct DataType<float> {
+    static constexpr ::GDALDataType value = GDT_Float32;
+};
+
 }  // namespace gdal
 }  // namespace sirius
 
@@ -96,7 +96,46 @@ DatasetUPtr CreateDataset(const std::string& filepath, int w, int h,
     return dataset;
 }
 
-Image LoadImage(const std::string& filepath) {
+namespace {
+
+template <typename T>
+BasicImage<T> ReadBand(GDALDataset* dataset, int band,
+                       const std::string& filepath) {
+    Size size = {dataset->GetRasterYSize(), dataset->GetRasterXSize()};
+    BasicBuffer<T> buffer(size.row * size.col);
+
+    CPLErr err = dataset->GetRasterBand(band)->RasterIO(
+          GF_Read, 0, 0, size.col, size.row, buffer.data(), size.col,
+          size.row, DataType<T>::value, 0, 0);
+    if (err) {
+        LOG("gdal", error,
+            "GDAL error: {} - could not get band {} data from file {}", err,
+            band, filepath);
+        throw gdal::Exception();
+    }
+
+    return {size, std::move(buffer)};
+}
+
+template <typename T>
+void WriteBand(GDALDataset* dataset, int band, const BasicImage<T>& image,
+               const std::string& output_filepath) {
+    CPLErr err = dataset->GetRasterBand(band)->RasterIO(
+          GF_Write, 0, 0, image.size.col, image.size.row,
+          const_cast<T*>(image.data.data()), image.size.col, image.size.row,
+          DataType<T>::value, 0, 0);
+    if (err) {
+        LOG("image", error,
+            "GDAL error: {} - could not write band {} in file {}", err, band,
+            output_filepath);
+        throw gdal::Exception();
+    }
+}
+
+}  // namespace
+
+template <typename T>
+BasicImage<T> LoadImage(const std::string& filepath) {
     if (filepath.empty()) {
         LOG("gdal", debug, "no filepath provided");
         return {};
@@ -104,45 +143,83 @@ Image LoadImage(const std::string& filepath) {
 
     LOG("gdal", trace, "loading image '{}'", filepath);
     auto dataset = LoadDataset(filepath);
+    LOG("gdal", trace, "image size: {}x{}", dataset->GetRasterYSize(),
+        dataset->GetRasterXSize());
 
-    Size tmp_size = {dataset->GetRasterYSize(), dataset->GetRasterXSize()};
-    LOG("gdal", trace, "image size: {}x{}", tmp_size.row, tmp_size.col);
-
-    Buffer tmp_buffer(tmp_size.row * tmp_size.col);
+    return ReadBand<T>(dataset.get(), 1, filepath);
+}
 
-    CPLErr err = dataset->GetRasterBand(1)->RasterIO(
-          GF_Read, 0, 0, tmp_size.col, tmp_size.row, tmp_buffer.data(),
-          tmp_size.col, tmp_size.row, GDT_Float64, 0, 0);
-    if (err) {
-        LOG("gdal", error,
-            "GDAL error: {} - could not get image data from file {}", err,
-            filepath);
-        throw gdal::Exception();
+template <typename T>
+std::vector<BasicImage<T>> LoadImageBands(const std::string& filepath) {
+    if (filepath.empty()) {
+        LOG("gdal", debug, "no filepath provided");
+        return {};
     }
 
-    return {tmp_size, std::move(tmp_buffer)};
+    LOG("gdal", trace, "loading image bands '{}'", filepath);
+    auto dataset = LoadDataset(filepath);
+    LOG("gdal", trace, "image size: {}x{}, {} band(s)",
+        dataset->GetRasterYSize(), dataset->GetRasterXSize(),
+        dataset->GetRasterCount());
+
+    std::vector<BasicImage<T>> band_images;
+    for (int band = 1; band <= dataset->GetRasterCount(); ++band) {
+        band_images.push_back(ReadBand<T>(dataset.get(), band, filepath));
+    }
+    return band_images;
 }
 
-void SaveImage(const Image& image, const std::string& output_filepath,
+template <typename T>
+void SaveImage(const BasicImage<T>& image, const std::string& output_filepath,
                const GeoReference& geoRef) {
     LOG("gdal", trace, "saving image into '{}'", output_filepath);
 
     // TODO: basic save implementation, test only ATM
     auto dataset = CreateDataset(output_filepath, image.size.col,
                                  image.size.row, 1, geoRef);
+    WriteBand(dataset.get(), 1, image, output_filepath);
+}
 
-    auto band = dataset->GetRasterBand(1);
-    CPLErr err =
-          band->RasterIO(GF_Write, 0, 0, image.size.col, image.size.row,
-                         const_cast<double*>(image.data.data()), image.size.col,
-                         image.size.row, GDT_Float64, 0, 0);
-    if (err) {
-        LOG("image", error, "GDAL error: {} - could not write in file {}", err,
-            output_filepath);
+template <typename T>
+void SaveImageBands(const std::vector<BasicImage<T>>& band_images,
+                    const std::string& output_filepath,
+                    const GeoReference& geoRef) {
+    if (band_images.empty()) {
+        LOG("gdal", error, "no band to save into '{}'", output_filepath);
         throw gdal::Exception();
     }
+    LOG("gdal", trace, "saving {} band(s) into '{}'", band_images.size(),
+        output_filepath);
+
+    const auto& size = band_images.front().size;
+    auto dataset =
+          CreateDataset(output_filepath, size.col, size.row,
+                        static_cast<int>(band_images.size()), geoRef);
+    for (std::size_t i = 0; i < band_images.size(); ++i) {
+        WriteBand(dataset.get(), static_cast<int>(i) + 1, band_images[i],
+                  output_filepath);
+    }
 }
 
+template Image LoadImage<double>(const std::string& filepath);
+template FloatImage LoadImage<float>(const std::string& filepath);
+template std::vector<Image> LoadImageBands<double>(
+      const std::string& filepath);
+template std::vector<FloatImage> LoadImageBands<float>(
+      const std::string& filepath);
+template void SaveImage<double>(const Image& image,
+                                const std::string& output_filepath,
+                                const GeoReference& geoRef);
+template void SaveImage<float>(const FloatImage& image,
+                               const std::string& output_filepath,
+                               const GeoReference& geoRef);
+template void SaveImageBands<double>(const std::vector<Image>& band_images,
+                                     const std::string& output_filepath,
+                                     const GeoReference& geoRef);
+template void SaveImageBands<float>(
+      const std::vector<FloatImage>& band_images,
+      const std::string& output_filepath, const GeoReference& geoRef);
+
 GeoReference ComputeZoomedGeoReference(const std::string& input_path,
                                        const ZoomRatio& zoom_ratio) {
     auto input_dataset = sirius::gdal::LoadDataset(input_path);
@@ -151,6 +228,13 @@ GeoReference ComputeZoomedGeoReference(const std::string& input_path,
             input_dataset->GetProjectionRef()};
 }
 
+Size GetNativeBlockSize(GDALDataset* dataset) {
+    int block_w = 0;
+    int block_h = 0;
+    dataset->GetRasterBand(1)->GetBlockSize(&block_w, &block_h);
+    return {block_h, block_w};
+}
+
 std::vector<double> ComputeOutputGeoTransform(GDALDataset* dataset,
                                               const ZoomRatio& zoom_ratio) {
     std::vector<double> geo_transform(6);
@@ -23,6 +23,7 @@
 #define SIRIUS_GDAL_WRAPPER_H_
 
 #include <string>
+#include <vector>
 
 #include "sirius/gdal/types.h"
 #include "sirius/image.h"
@@ -49,16 +50,51 @@ struct GeoReference {
     bool is_initialized{false};
 };
 
-Image LoadImage(const std::string& filepath);
+/**
+ * \brief Load the first band of an image
+ * \tparam T pixel type (double or float)
+ * \param filepath image path
+ * \return image
+ */
+template <typename T = double>
+BasicImage<T> LoadImage(const std::string& filepath);
+
+/**
+ * \brief Load all the bands of an image
+ * \tparam T pixel type (double or float)
+ * \param filepath image path
+ * \return band images, one per band
+ */
+template <typename T = double>
+std::vector<BasicImage<T>> LoadImageBands(const std::string& filepath);
 
-void SaveImage(const Image& image, const std::string& output_filepath,
+template <typename T>
+void SaveImage(const BasicImage<T>& image, const std::string& output_filepath,
                const GeoReference& geoRef = {});
 
+/**
+ * \brief Save band images into a multi-band image
+ * \param band_images band images of the same size, one per band
+ * \param output_filepath image path
+ * \param geoRef georeference of the image
+ */
+template <typename T>
+void SaveImageBands(const std::vector<BasicImage<T>>& band_images,
+                    const std::string& output_filepath,
+                    const GeoReference& geoRef = {});
+
 DatasetUPtr LoadDataset(const std::string& filepath);
 
 DatasetUPtr CreateDataset(const std::string& filepath, int w, int h,
                           int n_bands, const GeoReference& geo_ref = {});
 
+/**
+ * \brief Get the native block size (tile or strip) of the first band
+ * \param dataset dataset
+ * \return native block size
+ */
+Size GetNativeBlockSize(GDALDataset* dataset);
+
 /**
  * \brief Compute zoomed georeference information
  * \param input_path input image path
@@ -61,6 +61,93 @@ class IFrequencyZoom {
     virtual Image Compute(const ZoomRatio& zoom_ratio, const Image& input,
                           const Padding& image_padding,
                           const Filter& filter = {}) const = 0;
+
+    /**
+     * \brief Zoom in/out a single precision image by a zoom ratio
+     *
+     * Same as the double precision overload but the whole computation
+     * (FFT, filter, IFFT) is done in single precision.
+     *
+     * \remark This method is thread safe
+     *
+     * \param zoom_ratio zoom ratio
+     * \param input image to zoom in/out
+     * \param image_padding expected padding to add to the image to
+     *        comply with the filter
+     * \param filter optional filter to apply after the zoom transformation.
+     *        The filter must be compatible with the requested ratio.
+     * \return Zoomed in/out image
+     *
+     * \throw SiriusException if a computing issue happens
+     */
+    virtual FloatImage Compute(const ZoomRatio& zoom_ratio,
+                               const FloatImage& input,
+                               const Padding& image_padding,
+                               const Filter& filter = {}) const = 0;
+
+    /**
+     * \brief Zoom in/out a batch of images by a zoom ratio
+     *
+     * Images of the batch share the same padding. Images of the same size
+     * are transformed together: FFTs are computed with a single FFTW plan and
+     * the filter spectrum is fetched once, which amortizes the per-image
+     * overhead on small images.
+     *
+     * \remark This method is thread safe
+     *
+     * \param zoom_ratio zoom ratio
+     * \param inputs images to zoom in/out
+     * \param image_padding expected padding to add to the images to
+     *        comply with the filter
+     * \param filter optional filter to apply after the zoom transformation.
+     *        The filter must be compatible with the requested ratio.
+     * \return Zoomed in/out images, in the order of the inputs
+     *
+     * \throw SiriusException if a computing issue happens
+     */
+    virtual std::vector<Image> Compute(const ZoomRatio& zoom_ratio,
+                                       const std::vector<Image>& inputs,
+                                       const Padding& image_padding,
+                                       const Filter& filter = {}) const = 0;
+
+    /**
+     * \brief Zoom in/out a batch of single precision images by a zoom ratio
+     *
+     * Same as the double precision overload but the whole computation
+     * (FFT, filter, IFFT) is done in single precision.
+     *
+     * \remark This method is thread safe
+     *
+     * \param zoom_ratio zoom ratio
+     * \param inputs images to zoom in/out
+     * \param image_padding expected padding to add to the images to
+     *        comply with the filter
+     * \param filter optional filter to apply after the zoom transformation.
+     *        The filter must be compatible with the requested ratio.
+     * \return Zoomed in/out images, in the order of the inputs
+     *
+     * \throw SiriusException if a computing issue happens
+     */
+    virtual std::vector<FloatImage> Compute(
+          const ZoomRatio& zoom_ratio, const std::vector<FloatImage>& inputs,
+          const Padding& image_padding, const Filter& filter = {}) const = 0;
+
+    /**
+     * \brief Select the zoomed image sizes whose filter spectrum is used
+     *
+     * Real zooms only filter the sampled rows of the spectrum, and the sizes
+     * filtered by direct convolution need no spectrum. The result is meant
+     * for Filter::PrepareSpectra.
+     *
+     * \param zoom_ratio zoom ratio
+     * \param zoomed_sizes sizes of the zoomed images (images padded to even
+     *        size, then zoomed by the input resolution)
+     * \param filter filter to apply after the zoom transformation
+     * \return sizes of zoomed_sizes on which the filter spectrum is applied
+     */
+    virtual std::vector<Size> FilterSpectrumSizes(
+          const ZoomRatio& zoom_ratio, const std::vector<Size>& zoomed_sizes,
+          const Filter& filter) const = 0;
 };
 
 }  // namespace sirius
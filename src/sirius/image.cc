@@ -21,8 +21,6 @@
 
 #include "sirius/image.h"
 
-#include <cstring>
-
 #include <algorithm>
 
 #include <gdal.h>
@@ -43,15 +41,29 @@ Padding::Padding(int i_top, int i_bottom, int i_left, int i_right,
       right(i_right),
       type(i_type) {}
 
-Image::Image(const Size& size) : size(size) {
+Size PaddedEvenSize(const Size& size, const Padding& padding) {
+    Size padded_size = size;
+    if (!padding.IsEmpty()) {
+        padded_size.row += padding.top + padding.bottom;
+        padded_size.col += padding.left + padding.right;
+    }
+    padded_size.row += padded_size.row % 2;
+    padded_size.col += padded_size.col % 2;
+    return padded_size;
+}
+
+template <typename T>
+BasicImage<T>::BasicImage(const Size& size) : size(size) {
     data.resize(size.CellCount());
     std::fill(data.begin(), data.end(), 0);
 }
 
-Image::Image(const Size& size, Buffer&& buf)
+template <typename T>
+BasicImage<T>::BasicImage(const Size& size, Buffer&& buf)
     : size(size), data(std::move(buf)) {}
 
-Image Image::CreatePaddedImage(const Padding& padding) const {
+template <typename T>
+BasicImage<T> BasicImage<T>::CreatePaddedImage(const Padding& padding) const {
     if (padding.IsEmpty()) {
         return {*this};
     }
@@ -69,135 +81,121 @@ Image Image::CreatePaddedImage(const Padding& padding) const {
     }
 }
 
-Image Image::CreateZeroPaddedImage(const Padding& padding) const {
+template <typename T>
+BasicImage<T> BasicImage<T>::CreateZeroPaddedImage(
+      const Padding& padding) const {
     LOG("image", trace, "zero pad image {}x{} by ({}, {}, {}, {})", size.row,
         size.col, padding.top, padding.bottom, padding.left, padding.right);
-    int row_count = size.row + padding.top + padding.bottom;
-    int col_count = size.col + padding.left + padding.right;
-
-    Image result({row_count, col_count});
+    Padding zero_padding(padding);
+    zero_padding.type = PaddingType::kZeroPadding;
+    return PadImage(zero_padding, false);
+}
 
-    std::fill(result.data.begin(), result.data.end(), 0);
+template <typename T>
+BasicImage<T> BasicImage<T>::CreateMirrorPaddedImage(
+      const Padding& padding) const {
+    LOG("image", trace, "mirror pad image {}x{} by ({}, {}, {}, {})", size.row,
+        size.col, padding.top, padding.bottom, padding.left, padding.right);
+    Padding mirror_padding(padding);
+    mirror_padding.type = PaddingType::kMirrorPadding;
+    return PadImage(mirror_padding, false);
+}
 
-    // left and right zero padding
-    // beginning of the first real image's line
-    int top_offset = col_count * padding.top;
+template <typename T>
+BasicImage<T> BasicImage<T>::CreatePaddedEvenImage(
+      const Padding& padding) const {
+    if (padding.IsEmpty()) {
+        return PadImage({0, 0, 0, 0, PaddingType::kZeroPadding}, true);
+    }
 
-    for (int i_row = 0; i_row < size.row; ++i_row) {
-        // copy row
-        auto result_row_index = top_offset + (i_row * col_count) + padding.left;
+    LOG("image", trace, "pad image {}x{} by ({}, {}, {}, {}) to even size",
+        size.row, size.col, padding.top, padding.bottom, padding.left,
+        padding.right);
+    if (padding.type != PaddingType::kZeroPadding &&
+        padding.type != PaddingType::kMirrorPadding) {
+        LOG("image", warn, "padding type not handled, zero pad image");
+    }
+    return PadImage(padding, true);
+}
 
-        auto begin_result_it = result.data.begin() + result_row_index;
-        auto begin_row_it = data.cbegin() + i_row * size.col;
-        auto end_row_it = begin_row_it + size.col;
+template <typename T>
+void BasicImage<T>::CreateEvenImage() {
+    LOG("image", trace, "Resize image to pair dimensions");
+    *this = PadImage({0, 0, 0, 0, PaddingType::kZeroPadding}, true);
+}
 
-        std::copy(begin_row_it, end_row_it, begin_result_it);
+template <typename T>
+BasicImage<T> BasicImage<T>::Sample(const SamplingGrid& grid) const {
+    // every cell is written below, no need to fill the buffer
+    BasicImage result(grid.size, Buffer(grid.size.CellCount()));
+    for (int row = 0; row < grid.size.row; ++row) {
+        const T* data_row =
+              data.data() + (grid.row_begin + row * grid.step) * size.col +
+              grid.col_begin;
+        T* result_row = result.data.data() + row * grid.size.col;
+        for (int col = 0; col < grid.size.col; ++col) {
+            result_row[col] = data_row[col * grid.step];
+        }
     }
-
     return result;
 }
 
-Image Image::CreateMirrorPaddedImage(const Padding& padding) const {
-    LOG("image", trace, "mirror pad image {}x{} by ({}, {}, {}, {})", size.row,
-        size.col, padding.top, padding.bottom, padding.left, padding.right);
+template <typename T>
+BasicImage<T> BasicImage<T>::PadImage(const Padding& padding,
+                                      bool is_even) const {
     int row_count = size.row + padding.top + padding.bottom;
     int col_count = size.col + padding.left + padding.right;
-
-    Image result({row_count, col_count});
-
-    std::fill(result.data.begin(), result.data.end(), 0);
-
-    // top mirroring
-    for (int i = 0; i < padding.top; ++i) {
-        int result_row_offset = i * col_count + padding.left;
-        int data_row_offset = (padding.top - 1 - i) * size.col;
-
-        std::copy(data.begin() + data_row_offset,
-                  data.begin() + data_row_offset + size.col,
-                  result.data.begin() + result_row_offset);
+    Size result_size = {row_count, col_count};
+    if (is_even) {
+        result_size.row += row_count % 2;
+        result_size.col += col_count % 2;
     }
+    bool is_mirror = (padding.type == PaddingType::kMirrorPadding);
 
-    // copy original image
-    // beginning of the first real image's line
-    int top_offset = col_count * padding.top;
-    for (int i_row = 0; i_row < size.row; ++i_row) {
-        // copy row
-        auto result_row_index = top_offset + (i_row * col_count) + padding.left;
-
-        auto begin_result_it = result.data.begin() + result_row_index;
-        auto begin_row_it = data.cbegin() + i_row * size.col;
-        auto end_row_it = begin_row_it + size.col;
+    // every cell is written below, no need to fill the buffer
+    BasicImage result(result_size, Buffer(result_size.CellCount()));
 
-        std::copy(begin_row_it, end_row_it, begin_result_it);
-    }
+    for (int row = 0; row < result_size.row; ++row) {
+        T* result_row = result.data.data() + row * result_size.col;
 
-    // bottom mirroring
-    int bottom_offset = row_count * col_count - padding.bottom * col_count;
-    int end_data = size.col * size.row;
-    for (int row = 0; row < padding.bottom; ++row) {
-        int result_row_offset = bottom_offset + padding.left + row * col_count;
-        int data_row_offset = end_data - (row + 1) * size.col;
-
-        std::copy(data.begin() + data_row_offset,
-                  data.begin() + data_row_offset + size.col,
-                  result.data.begin() + result_row_offset);
-    }
+        // even extension duplicates the last padded row
+        int data_row = std::min(row, row_count - 1) - padding.top;
+        if (is_mirror && data_row < 0) {
+            data_row = -data_row - 1;
+        } else if (is_mirror && data_row >= size.row) {
+            data_row = 2 * size.row - data_row - 1;
+        }
+        if (data_row < 0 || data_row >= size.row) {
+            std::fill(result_row, result_row + result_size.col, T(0));
+            continue;
+        }
 
-    // left mirroring
-    for (int row = 0; row < row_count; ++row) {
-        for (int col = 0; col < padding.left; ++col) {
-            result.Set(row, col, result.Get(row, 2 * padding.left - col - 1));
+        const T* data_row_begin = data.data() + data_row * size.col;
+        T* right_begin = result_row + padding.left + size.col;
+        if (is_mirror) {
+            for (int col = 0; col < padding.left; ++col) {
+                result_row[col] = data_row_begin[padding.left - col - 1];
+            }
+            for (int col = 0; col < padding.right; ++col) {
+                right_begin[col] = data_row_begin[size.col - col - 1];
+            }
+        } else {
+            std::fill(result_row, result_row + padding.left, T(0));
+            std::fill(right_begin, right_begin + padding.right, T(0));
         }
-    }
+        std::copy(data_row_begin, data_row_begin + size.col,
+                  result_row + padding.left);
 
-    // right mirroring
-    for (int row = 0; row < row_count; ++row) {
-        for (int col = 0; col < padding.right; ++col) {
-            result.Set(row, size.col + padding.left + col,
-                       result.Get(row, size.col + padding.left - col - 1));
+        // even extension duplicates the last padded col
+        if (result_size.col != col_count) {
+            result_row[col_count] = result_row[col_count - 1];
         }
     }
 
     return result;
 }
 
-void Image::CreateEvenImage() {
-    LOG("image", trace, "Resize image to pair dimensions");
-    auto new_size = size;
-    bool odd_row = false;
-    bool odd_col = false;
-    if (size.row % 2 != 0) {
-        new_size.row += 1;
-        odd_row = true;
-    }
-    if (size.col % 2 != 0) {
-        new_size.col += 1;
-        odd_col = true;
-    }
-
-    Image output_image(new_size);
-    int begin_src = 0;
-    int begin_dst = 0;
-    for (int i = 0; i < size.row; ++i) {
-        memcpy(&output_image.data[begin_dst], &data[begin_src],
-               size.col * sizeof(double));
-        begin_src += size.col;
-        begin_dst += size.col;
-        if (odd_col) {
-            output_image.data[begin_dst] = output_image.data[begin_dst - 1];
-            begin_dst++;
-        }
-    }
-
-    int x_size = size.col;
-    if (odd_col) x_size++;
-    if (odd_row) {
-        memcpy(&output_image.data[begin_dst],
-               &output_image.data[begin_dst - x_size], x_size * sizeof(double));
-    }
-
-    data = output_image.data;
-    size = output_image.size;
-}
+template class BasicImage<double>;
+template class BasicImage<float>;
 
 }  // namespace sirius
@@ -58,35 +58,66 @@ struct Padding {
                (top == 0 && bottom == 0 && left == 0 && right == 0);
     }
 
+    bool operator==(const Padding& rhs) const {
+        return top == rhs.top && bottom == rhs.bottom && left == rhs.left &&
+               right == rhs.right && type == rhs.type;
+    }
+
     PaddingType type{PaddingType::kMirrorPadding};
 };
 
+/**
+ * \brief Regular grid of samples of an image
+ *
+ * Sample (i, j) of the grid is the pixel (row_begin + i * step,
+ * col_begin + j * step) of the image.
+ */
+struct SamplingGrid {
+    int row_begin{0};
+    int col_begin{0};
+    int step{1};
+    Size size{};
+};
+
+/**
+ * \brief Size of an image padded by BasicImage::CreatePaddedEvenImage
+ * \param size image size
+ * \param padding padding of the image
+ * \return padded size rounded up to even dimensions
+ */
+Size PaddedEvenSize(const Size& size, const Padding& padding);
+
 /**
  * \brief Data class that represents an image (Size + Buffer)
+ * \tparam T sample type (double or float)
  */
-class Image {
+template <typename T>
+class BasicImage {
+  public:
+    using Buffer = BasicBuffer<T>;
+
   public:
-    Image() = default;
+    BasicImage() = default;
     /**
      * \brief Instanciate an image of the given size and pre-allocate its buffer
      *        with 0
      * \param size image size
      */
-    Image(const Size& size);
+    BasicImage(const Size& size);
 
     /**
      * \brief Instanciate an image of the given size with data
      * \param size image size
      * \param buffer image buffer
      */
-    Image(const Size& size, Buffer&& buffer);
+    BasicImage(const Size& size, Buffer&& buffer);
 
-    ~Image() = default;
+    ~BasicImage() = default;
 
-    Image(const Image&) = default;
-    Image& operator=(const Image&) = default;
-    Image(Image&&) = default;
-    Image& operator=(Image&&) = default;
+    BasicImage(const BasicImage&) = default;
+    BasicImage& operator=(const BasicImage&) = default;
+    BasicImage(BasicImage&&) = default;
+    BasicImage& operator=(BasicImage&&) = default;
 
     /**
      * \brief Get the cell count of the image (row x col)
@@ -99,7 +130,7 @@ class Image {
      *        Row and col starts at 0
      * \return value
      */
-    inline Buffer::value_type Get(int row, int col) const {
+    inline T Get(int row, int col) const {
         assert(row < size.row && col < size.col);
 
         return data[row * size.col + col];
@@ -109,7 +140,7 @@ class Image {
      * \brief Set the value at cell (row, col)
      *        Row and col starts at 0
      */
-    inline void Set(int row, int col, Buffer::value_type val) {
+    inline void Set(int row, int col, T val) {
         assert(row < size.row && col < size.col);
 
         data[row * size.col + col] = val;
@@ -133,32 +164,70 @@ class Image {
      * \param padding padding to apply
      * \return generated image
      */
-    Image CreatePaddedImage(const Padding& padding) const;
+    BasicImage CreatePaddedImage(const Padding& padding) const;
 
     /**
      * \brief Create a zero padded image from the current image
      * \param zero_padding padding to apply
      * \return generated image
      */
-    Image CreateZeroPaddedImage(const Padding& zero_padding) const;
+    BasicImage CreateZeroPaddedImage(const Padding& zero_padding) const;
 
     /**
      * \brief Create a padded image using mirroring on borders
      * \param padding_size size of the margins
      * \return generated image
      */
-    Image CreateMirrorPaddedImage(const Padding& mirror_padding) const;
+    BasicImage CreateMirrorPaddedImage(const Padding& mirror_padding) const;
+
+    /**
+     * \brief Create a padded image with even dimensions from the current image
+     *
+     * Equivalent to CreatePaddedImage followed by CreateEvenImage, computed in
+     * one pass without intermediate image
+     *
+     * \param padding padding to apply
+     * \return generated image
+     */
+    BasicImage CreatePaddedEvenImage(const Padding& padding) const;
 
     /**
      * \brief add row and col according to odd dim of calling image
      */
     void CreateEvenImage();
 
+    /**
+     * \brief Extract a regular grid of samples from the current image
+     * \param grid samples to extract, inside the image
+     * \return sampled image
+     */
+    BasicImage Sample(const SamplingGrid& grid) const;
+
+  private:
+    /**
+     * \brief Pad the image and optionally duplicate its last row and col to
+     *        get even dimensions
+     * \param padding padding to apply (zero padding if type is not mirror)
+     * \param is_even true to extend the padded image to even dimensions
+     * \return generated image
+     */
+    BasicImage PadImage(const Padding& padding, bool is_even) const;
+
   public:
     Size size{0, 0};
     Buffer data;
 };
 
+/**
+ * \brief Double precision image
+ */
+using Image = BasicImage<double>;
+
+/**
+ * \brief Single precision image
+ */
+using FloatImage = BasicImage<float>;
+
 }  // namespace sirius
 
 #endif  // SIRIUS_IMAGE_H_
@@ -21,182 +21,400 @@
 
 #include "sirius/image_streamer.h"
 
-#include <future>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
 #include <vector>
 
+#include "sirius/exception.h"
+
 #include "sirius/gdal/stream_block.h"
 
-#include "sirius/utils/concurrent_queue.h"
+#include "sirius/utils/buffer_pool.h"
 #include "sirius/utils/log.h"
+#include "sirius/utils/work_stealing_scheduler.h"
 
 namespace sirius {
 
+namespace {
+
+/**
+ * \brief Flush the remaining strips of the writer and log its errors
+ * \param block_writer writer to close
+ * \return false if a strip could not be written
+ */
+bool CloseWriter(gdal::CoalescingWriter& block_writer) {
+    std::error_code close_ec;
+    block_writer.Close(close_ec);
+    if (close_ec) {
+        LOG("image_streamer", error, "error while writing strip: {}",
+            close_ec.message());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * \brief Adaptive batch size: number of blocks zoomed together
+ *
+ * Small blocks are batched until the batch holds about kBatchPixelCount
+ * pixels so that the per-transform overhead (plan and filter lookups,
+ * allocations) is amortized. Large blocks are zoomed one by one.
+ *
+ * \param block_size size of a padded block
+ * \param band_count number of bands of a block
+ * \return batch size
+ */
+unsigned int ComputeBatchSize(const Size& block_size, int band_count) {
+    constexpr int kBatchPixelCount = 256 * 256;
+    constexpr int kMaxBatchSize = 16;
+    int block_pixel_count = std::max(block_size.CellCount() * band_count, 1);
+    return std::max(
+          std::min(kBatchPixelCount / block_pixel_count, kMaxBatchSize), 1);
+}
+
+/**
+ * \brief Split the blocks of an input stream with the same read size and
+ *        padding into batches
+ * \param input_stream input stream
+ * \param batch_size maximum batch size, 0 adapts it to the block size
+ * \return batches in scan order
+ */
+std::vector<gdal::StreamBlockBatch> CreateInputBlockBatches(
+      const gdal::InputStream& input_stream, unsigned int batch_size) {
+    const auto& blocks = input_stream.blocks();
+    if (blocks.empty()) {
+        return {};
+    }
+
+    if (batch_size == 0) {
+        const auto& first_block = blocks.front();
+        Size padded_block_size(first_block.read_size.row +
+                                     first_block.padding.top +
+                                     first_block.padding.bottom,
+                               first_block.read_size.col +
+                                     first_block.padding.left +
+                                     first_block.padding.right);
+        batch_size =
+              ComputeBatchSize(padded_block_size, input_stream.band_count());
+    }
+
+    // consecutive blocks of a grid row share their size and padding, except
+    // the blocks on the image borders
+    std::vector<gdal::StreamBlockBatch> block_batches;
+    for (const auto& block : blocks) {
+        if (block_batches.empty() ||
+            block_batches.back().size() >= batch_size ||
+            !(block_batches.back().front().read_size == block.read_size) ||
+            !(block_batches.back().front().padding == block.padding)) {
+            block_batches.emplace_back();
+        }
+        block_batches.back().push_back(block);
+    }
+
+    LOG("image_streamer", info, "{} blocks zoomed in {} batches (up to {})",
+        blocks.size(), block_batches.size(), batch_size);
+    return block_batches;
+}
+
+/**
+ * \brief Sizes of the zoomed block FFTs the filter is applied on
+ * \param input_stream input stream
+ * \param zoom_ratio zoom ratio
+ * \return distinct sizes of the block grid
+ */
+std::vector<Size> ComputeInputZoomedBlockSizes(
+      const gdal::InputStream& input_stream, const ZoomRatio& zoom_ratio) {
+    // blocks are padded to even size then zoomed by the input resolution
+    std::vector<Size> zoomed_block_sizes;
+    for (const auto& block : input_stream.blocks()) {
+        Size padded_size = PaddedEvenSize(block.read_size, block.padding);
+        Size zoomed_size(padded_size.row * zoom_ratio.input_resolution(),
+                         padded_size.col * zoom_ratio.input_resolution());
+        if (std::find(zoomed_block_sizes.begin(), zoomed_block_sizes.end(),
+                      zoomed_size) == zoomed_block_sizes.end()) {
+            zoomed_block_sizes.push_back(zoomed_size);
+        }
+    }
+    return zoomed_block_sizes;
+}
+
+}  // namespace
+
 ImageStreamer::ImageStreamer(const std::string& input_path,
                              const std::string& output_path,
                              const Size& block_size,
                              const ZoomRatio& zoom_ratio,
                              const FilterMetadata& filter_metadata,
-                             unsigned int max_parallel_workers)
+                             unsigned int max_parallel_workers,
+                             std::size_t max_tile_cache_bytes,
+                             unsigned int batch_size,
+                             bool prepare_filter_spectra,
+                             bool trim_buffer_pool)
     : max_parallel_workers_(max_parallel_workers),
+      max_tile_cache_bytes_(max_tile_cache_bytes),
+      batch_size_(batch_size),
+      prepare_filter_spectra_(prepare_filter_spectra),
+      trim_buffer_pool_(trim_buffer_pool),
       block_size_(block_size),
       zoom_ratio_(zoom_ratio),
       input_stream_(input_path, block_size, filter_metadata.margin_size,
                     filter_metadata.padding_type),
       output_stream_(input_path, output_path, zoom_ratio) {}
 
+template <typename T>
 void ImageStreamer::Stream(const IFrequencyZoom& frequency_zoom,
                            const Filter& filter) {
     LOG("image_streamer", info, "stream block size: {}x{}", block_size_.row,
         block_size_.col);
+
+    std::unique_ptr<gdal::BasicTileCache<T>> tile_cache;
+    if (max_tile_cache_bytes_ > 0) {
+        tile_cache = std::make_unique<gdal::BasicTileCache<T>>(
+              input_stream_.Size(), input_stream_.native_block_size(),
+              input_stream_.blocks(), max_tile_cache_bytes_);
+    }
+
+    if (filter.IsLoaded() && prepare_filter_spectra_) {
+        // spectra are then shared read-only by the workers
+        filter.PrepareSpectra<T>(frequency_zoom.FilterSpectrumSizes(
+              zoom_ratio_, ComputeZoomedBlockSizes(), filter));
+    }
+
+    auto block_batches = CreateBlockBatches();
+    bool is_streamed = false;
     if (max_parallel_workers_ == 1) {
-        RunMonothreadStream(frequency_zoom, filter);
+        is_streamed = RunMonothreadStream<T>(block_batches, frequency_zoom,
+                                             filter, tile_cache.get());
     } else {
-        RunMultithreadStream(frequency_zoom, filter);
+        is_streamed = RunMultithreadStream<T>(
+              std::move(block_batches), frequency_zoom, filter,
+              tile_cache.get());
+    }
+
+    if (tile_cache) {
+        auto stats = tile_cache->GetStats();
+        std::size_t request_count = stats.hit_count + stats.miss_count;
+        LOG("image_streamer", info,
+            "tile cache: {} hits, {} misses ({:.1f}% hit rate), {:.1f} MiB "
+            "saved, {} evictions, {:.1f} MiB max cached",
+            stats.hit_count, stats.miss_count,
+            request_count > 0 ? 100.0 * stats.hit_count / request_count : 0.0,
+            stats.saved_bytes / (1024.0 * 1024.0), stats.evicted_count,
+            stats.max_cached_bytes / (1024.0 * 1024.0));
+    }
+    // idle buffers of this stream (block sizes of this image, buffers left
+    // by the exited workers) are not kept for the next run
+    tile_cache.reset();
+    if (trim_buffer_pool_) {
+        utils::BufferPool::Instance().Trim();
+    }
+
+    if (!is_streamed) {
+        throw SiriusException("image could not be streamed");
     }
 }
 
-void ImageStreamer::RunMonothreadStream(const IFrequencyZoom& frequency_zoom,
-                                        const Filter& filter) {
+template <typename T>
+bool ImageStreamer::RunMonothreadStream(
+      const std::vector<gdal::StreamBlockBatch>& block_batches,
+      const IFrequencyZoom& frequency_zoom, const Filter& filter,
+      gdal::BasicTileCache<T>* tile_cache) {
     LOG("image_streamer", info, "start monothreaded streaming");
-    while (!input_stream_.IsAtEnd()) {
+    gdal::CoalescingWriter block_writer(output_stream_, input_stream_.blocks());
+    auto input_dataset = input_stream_.OpenDataset();
+    bool is_streamed = true;
+    for (const auto& block_batch : block_batches) {
+        if (!ProcessBlockBatch(block_batch, input_dataset.get(),
+                               frequency_zoom, filter, tile_cache,
+                               block_writer)) {
+            is_streamed = false;
+            break;
+        }
+    }
+    // strips are flushed even if the stream failed
+    is_streamed = CloseWriter(block_writer) && is_streamed;
+    LOG("image_streamer", info, "end monothreaded streaming");
+    return is_streamed;
+}
+
+template <typename T>
+bool ImageStreamer::RunMultithreadStream(
+      std::vector<gdal::StreamBlockBatch> block_batches,
+      const IFrequencyZoom& frequency_zoom, const Filter& filter,
+      gdal::BasicTileCache<T>* tile_cache) {
+    LOG("image_streamer", info, "start multithreaded streaming");
+
+    // GDAL dataset handles cannot be shared: one input handle per worker
+    std::vector<gdal::DatasetUPtr> input_datasets;
+    for (unsigned int i = 0; i < max_parallel_workers_; ++i) {
+        input_datasets.push_back(input_stream_.OpenDataset());
+    }
+
+    gdal::CoalescingWriter block_writer(output_stream_, input_stream_.blocks());
+
+    // workers read, zoom and hand their blocks over to the writer
+    std::atomic<bool> is_streamed{true};
+    auto process_batch = [this, &frequency_zoom, &filter, &input_datasets,
+                          tile_cache, &block_writer, &is_streamed](
+                               unsigned int worker_index,
+                               const gdal::StreamBlockBatch& block_batch) {
+        if (!ProcessBlockBatch(block_batch, input_datasets[worker_index].get(),
+                               frequency_zoom, filter, tile_cache,
+                               block_writer)) {
+            is_streamed = false;
+            return false;
+        }
+        return true;
+    };
+
+    LOG("image_streamer", info,
+        "start zoom processing of {} blocks with {} workers",
+        input_stream_.blocks().size(), max_parallel_workers_);
+    utils::WorkStealingScheduler<gdal::StreamBlockBatch> scheduler(
+          max_parallel_workers_);
+    try {
+        scheduler.Run(std::move(block_batches), process_batch);
+    } catch (const std::exception& e) {
+        LOG("image_streamer", error, "exception while processing block: {}",
+            e.what());
+        is_streamed = false;
+    }
+    LOG("image_streamer", debug, "{} block batches stolen between workers",
+        scheduler.steal_count());
+    // strips are flushed even if the stream failed
+    bool is_closed = CloseWriter(block_writer);
+    LOG("image_streamer", info, "end multithreaded streaming");
+    return is_closed && is_streamed;
+}
+
+template <typename T>
+bool ImageStreamer::ProcessBlockBatch(const gdal::StreamBlockBatch& block_batch,
+                                      GDALDataset* input_dataset,
+                                      const IFrequencyZoom& frequency_zoom,
+                                      const Filter& filter,
+                                      gdal::BasicTileCache<T>* tile_cache,
+                                      gdal::CoalescingWriter& block_writer) {
+    std::vector<gdal::BasicStreamBlock<T>> blocks;
+    blocks.reserve(block_batch.size());
+    for (const auto& block_descriptor : block_batch) {
         std::error_code read_ec;
-        auto block = input_stream_.Read(read_ec);
+        blocks.push_back(input_stream_.Read<T>(block_descriptor, input_dataset,
+                                               tile_cache, read_ec));
         if (read_ec) {
             LOG("image_streamer", error, "error while reading block: {}",
                 read_ec.message());
-            break;
+            return false;
         }
-        block.buffer = std::move(frequency_zoom.Compute(
-              zoom_ratio_, block.buffer, block.padding, filter));
+    }
+
+    ZoomBlocks(frequency_zoom, filter, blocks);
 
+    for (auto& block : blocks) {
         std::error_code write_ec;
-        output_stream_.Write(std::move(block), write_ec);
+        block_writer.Write(std::move(block), write_ec);
         if (write_ec) {
             LOG("image_streamer", error, "error while writing block: {}",
                 write_ec.message());
-            break;
+            return false;
         }
     }
-    LOG("image_streamer", info, "end monothreaded streaming");
+    return true;
 }
 
-void ImageStreamer::RunMultithreadStream(const IFrequencyZoom& frequency_zoom,
-                                         const Filter& filter) {
-    LOG("image_streamer", info, "start multithreaded streaming");
+template <typename T>
+void ImageStreamer::ZoomBlocks(
+      const IFrequencyZoom& frequency_zoom, const Filter& filter,
+      std::vector<gdal::BasicStreamBlock<T>>& blocks) const {
+    // band images of all the blocks are zoomed in a single batch
+    std::vector<BasicImage<T>> band_images;
+    for (auto& block : blocks) {
+        std::move(block.bands.begin(), block.bands.end(),
+                  std::back_inserter(band_images));
+    }
 
-    // use block queues
-    utils::ConcurrentQueue<gdal::StreamBlock> input_queue(
-          max_parallel_workers_);
-    utils::ConcurrentQueue<gdal::StreamBlock> output_queue(
-          max_parallel_workers_);
+    auto zoomed_band_images = frequency_zoom.Compute(
+          zoom_ratio_, band_images, blocks.front().padding, filter);
 
-    auto input_stream_task = [this, &input_queue]() {
-        LOG("image_streamer", info, "start reading blocks");
-        while (!input_stream_.IsAtEnd() && input_queue.IsActive()) {
-            std::error_code read_ec;
-            auto block = input_stream_.Read(read_ec);
-            if (read_ec) {
-                LOG("image_streamer", error, "error while reading block: {}",
-                    read_ec.message());
-                break;
-            }
-
-            std::error_code push_input_ec;
-            input_queue.Push(std::move(block), push_input_ec);
-            if (push_input_ec) {
-                LOG("image_streamer", error,
-                    "cannot push input block into input queue: {}",
-                    push_input_ec.message());
-                break;
-            }
+    auto zoomed_band_it = zoomed_band_images.begin();
+    for (auto& block : blocks) {
+        for (auto& band_image : block.bands) {
+            band_image = std::move(*zoomed_band_it++);
         }
-        input_queue.Deactivate();
-        LOG("image_streamer", info, "end reading blocks");
-    };
+    }
+}
 
-    auto worker_task = [this, &input_queue, &output_queue, &frequency_zoom,
-                        &filter]() {
-        try {
-            while (input_queue.CanPop()) {
-                std::error_code pop_input_ec;
-                auto block = input_queue.Pop(pop_input_ec);
-                if (pop_input_ec) {
-                    // no more block to process
-                    LOG("image_streamer", debug,
-                        "cannot pop input block from input queue: {}",
-                        pop_input_ec.message());
-                    break;
-                }
-
-                auto zoomed_block = std::move(frequency_zoom.Compute(
-                      zoom_ratio_, block.buffer, block.padding, filter));
-
-                block.buffer = std::move(zoomed_block);
-
-                std::error_code push_output_ec;
-                output_queue.Push(std::move(block), push_output_ec);
-                if (push_output_ec) {
-                    LOG("image_streamer", error,
-                        "cannot push computed block into output queue: {}",
-                        push_output_ec.message());
-                    break;
-                }
-            }
-        } catch (const std::exception& e) {
-            LOG("image_streamer", error, "exception while processing block: {}",
-                e.what());
-            input_queue.Deactivate();
-            output_queue.Deactivate();
-        }
-    };
+std::vector<gdal::StreamBlockBatch> ImageStreamer::CreateBlockBatches() const {
+    return CreateInputBlockBatches(input_stream_, batch_size_);
+}
 
-    auto output_stream_task = [this, &output_queue]() {
-        LOG("image_streamer", info, "start writing blocks");
-        while (output_queue.CanPop()) {
-            std::error_code pop_output_ec;
-            std::error_code write_ec;
-            auto block = output_queue.Pop(pop_output_ec);
-            if (pop_output_ec) {
-                // no more block to process
-                break;
-            }
-            output_stream_.Write(std::move(block), write_ec);
-            if (write_ec) {
-                LOG("image_streamer", error, "error while writing block: {}",
-                    write_ec.message());
-                output_queue.DeactivateAndClear();
-            }
-        }
-        output_queue.Deactivate();
-        LOG("image_streamer", info, "end writing blocks");
-    };
+std::vector<Size> ImageStreamer::ComputeZoomedBlockSizes() const {
+    return ComputeInputZoomedBlockSizes(input_stream_, zoom_ratio_);
+}
 
-    auto output_task_future =
-          std::async(std::launch::async, output_stream_task);
-    auto input_task_future = std::async(std::launch::async, input_stream_task);
+template <typename T>
+void ImageStreamer::PrepareZoom(const std::string& input_path,
+                                const Size& block_size,
+                                const ZoomRatio& zoom_ratio,
+                                const FilterMetadata& filter_metadata,
+                                unsigned int batch_size,
+                                const IFrequencyZoom& frequency_zoom,
+                                const Filter& filter) {
+    gdal::InputStream input_stream(input_path, block_size,
+                                   filter_metadata.margin_size,
+                                   filter_metadata.padding_type);
+    if (filter.IsLoaded()) {
+        filter.PrepareSpectra<T>(frequency_zoom.FilterSpectrumSizes(
+              zoom_ratio,
+              ComputeInputZoomedBlockSizes(input_stream, zoom_ratio),
+              filter));
+    }
 
-    LOG("image_streamer", info, "start zoom processing with {} workers",
-        max_parallel_workers_);
-    using WorkerTasks = std::vector<std::future<void>>;
-    WorkerTasks worker_task_futures;
-    for (unsigned int i = 0; i < max_parallel_workers_; ++i) {
-        worker_task_futures.push_back(
-              std::async(std::launch::async, worker_task));
-    }
-    for (auto& worker_task_future : worker_task_futures) {
-        try {
-            // wait end of task or error
-            worker_task_future.get();
-        } catch (const std::exception& e) {
-            LOG("image_streamer", error, "exception on worker task: {}",
-                e.what());
+    // one batch per shape: the plans of a shape do not depend on the pixels
+    std::vector<gdal::StreamBlockBatch> shape_batches;
+    for (auto& block_batch :
+         CreateInputBlockBatches(input_stream, batch_size)) {
+        auto shape_it = std::find_if(
+              shape_batches.begin(), shape_batches.end(),
+              [&block_batch](const gdal::StreamBlockBatch& shape_batch) {
+                  return shape_batch.size() == block_batch.size() &&
+                         shape_batch.front().read_size ==
+                               block_batch.front().read_size &&
+                         shape_batch.front().padding ==
+                               block_batch.front().padding;
+              });
+        if (shape_it == shape_batches.end()) {
+            shape_batches.push_back(std::move(block_batch));
         }
     }
-    LOG("image_streamer", info, "end zoom processing");
-    output_queue.Deactivate();
-    output_task_future.get();
-    input_task_future.get();
-    LOG("image_streamer", info, "end multithreaded streaming");
+
+    for (const auto& shape_batch : shape_batches) {
+        const auto& block = shape_batch.front();
+        LOG("image_streamer", debug, "zoom {} zero block(s) {}x{}",
+            shape_batch.size(), block.read_size.row, block.read_size.col);
+        std::vector<BasicImage<T>> band_images(
+              shape_batch.size() * input_stream.band_count(),
+              BasicImage<T>(block.read_size));
+        frequency_zoom.Compute(zoom_ratio, band_images, block.padding, filter);
+    }
+    LOG("image_streamer", info, "{} block batch shapes zoomed",
+        shape_batches.size());
 }
 
+template void ImageStreamer::Stream<double>(
+      const IFrequencyZoom& frequency_zoom, const Filter& filter);
+template void ImageStreamer::Stream<float>(
+      const IFrequencyZoom& frequency_zoom, const Filter& filter);
+template void ImageStreamer::PrepareZoom<double>(
+      const std::string& input_path, const Size& block_size,
+      const ZoomRatio& zoom_ratio, const FilterMetadata& filter_metadata,
+      unsigned int batch_size, const IFrequencyZoom& frequency_zoom,
+      const Filter& filter);
+template void ImageStreamer::PrepareZoom<float>(
+      const std::string& input_path, const Size& block_size,
+      const ZoomRatio& zoom_ratio, const FilterMetadata& filter_metadata,
+      unsigned int batch_size, const IFrequencyZoom& frequency_zoom,
+      const Filter& filter);
+
 }  // namespace sirius
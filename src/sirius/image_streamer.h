@@ -22,11 +22,17 @@
 #ifndef SIRIUS_IMAGE_STREAMER_H_
 #define SIRIUS_IMAGE_STREAMER_H_
 
+#include <cstddef>
+#include <vector>
+
 #include "sirius/filter.h"
 #include "sirius/i_frequency_zoom.h"
 
+#include "sirius/gdal/coalescing_writer.h"
 #include "sirius/gdal/input_stream.h"
 #include "sirius/gdal/output_zoomed_stream.h"
+#include "sirius/gdal/stream_block.h"
+#include "sirius/gdal/tile_cache.h"
 #include "sirius/gdal/wrapper.h"
 
 namespace sirius {
@@ -47,48 +53,163 @@ class ImageStreamer {
      * \param padding_type filter padding type
      * \param max_parallel_workers max parallel workers to compute the zoom on
      *        stream blocks
+     * \param max_tile_cache_bytes memory budget of the decoded tile cache
+     *        shared by the block reads, 0 disables the cache
+     * \param batch_size number of blocks of the same size zoomed together
+     *        with batched FFTs, 0 adapts the batch size to the block size
+     * \param prepare_filter_spectra prepare the filter spectra of the block
+     *        sizes before streaming. Set it to false when the filter is shared
+     *        with concurrent streams: Filter::PrepareSpectra is not thread
+     *        safe and spectra which were not prepared are computed on demand
+     * \param trim_buffer_pool release the idle buffers of the pool at the end
+     *        of the stream. Set it to false when concurrent streams use the
+     *        pool, the caller trims it once they are done
      */
     ImageStreamer(const std::string& input_path, const std::string& output_path,
                   const Size& block_size, const ZoomRatio& zoom_ratio,
                   const FilterMetadata& filter_metadata,
-                  unsigned int max_parallel_workers);
+                  unsigned int max_parallel_workers,
+                  std::size_t max_tile_cache_bytes =
+                        gdal::TileCache::kDefaultMaxCachedBytes,
+                  unsigned int batch_size = 0,
+                  bool prepare_filter_spectra = true,
+                  bool trim_buffer_pool = true);
 
     /**
      * \brief Stream the input image, compute the zoom and stream output data
+     * \tparam T block pixel type, float computes the zoom in single precision
      * \param frequency_zoom requested frequency zoom to apply on stream block
      * \param filter filter to apply on the stream block
+     *
+     * \throw SiriusException if a block could not be read, zoomed or
+     *        written. Zoomed blocks are flushed to the output before.
      */
+    template <typename T = double>
     void Stream(const IFrequencyZoom& frequency_zoom, const Filter& filter);
 
+    /**
+     * \brief Zoom zero filled blocks of each batch shape of the input image
+     *        grid
+     *
+     * Shapes are the distinct read sizes, paddings and batch sizes of the
+     * batches zoomed by Stream, border blocks included. Zooming them requests
+     * the FFTW plans (batched, pruned, 1D and chirp-z transforms), filter
+     * spectra and chirp-z kernels of the stream, which prepares a wisdom file
+     * without writing any image.
+     *
+     * \tparam T block pixel type, float computes the zoom in single precision
+     * \param input_path input image path
+     * \param block_size stream block size
+     * \param zoom_ratio zoom ratio
+     * \param filter_metadata filter metadata
+     * \param batch_size number of blocks of the same size zoomed together, 0
+     *        adapts the batch size to the block size
+     * \param frequency_zoom frequency zoom applied on the stream blocks
+     * \param filter filter applied on the stream blocks
+     *
+     * \throw SiriusException if a computing issue happens
+     */
+    template <typename T = double>
+    static void PrepareZoom(const std::string& input_path,
+                            const Size& block_size, const ZoomRatio& zoom_ratio,
+                            const FilterMetadata& filter_metadata,
+                            unsigned int batch_size,
+                            const IFrequencyZoom& frequency_zoom,
+                            const Filter& filter);
+
   private:
     /**
      * \brief Stream image in monothreading mode
      *
-     * Read a block, compute the zoom and write the output in the output file
+     * Read a batch of blocks, compute their zoom and hand the outputs over to
+     * a coalescing writer which writes them in the output file
      *
+     * \param block_batches batches of blocks to stream
      * \param frequency_zoom frequency zoom to apply on stream block
      * \param filter filter to apply on stream block
+     * \param tile_cache decoded tile cache, nullptr to read blocks directly
+     * \return false if a block could not be read, zoomed or written
      */
-    void RunMonothreadStream(const IFrequencyZoom& frequency_zoom,
-                             const Filter& filter);
+    template <typename T>
+    bool RunMonothreadStream(
+          const std::vector<gdal::StreamBlockBatch>& block_batches,
+          const IFrequencyZoom& frequency_zoom, const Filter& filter,
+          gdal::BasicTileCache<T>* tile_cache);
 
     /**
      * \brief Stream image in multithreading mode
      *
-     * One thread will generate input blocks and feed an input queue
-     * One thread will consume zoomed blocks from an output queue and write them
-     * in the output file
-     * max_parallel_tasks threads will consume input blocks from an input queue,
-     * compute the zoom and feed an output queue
+     * Batches of blocks of the input grid are scheduled on
+     * max_parallel_workers workers with work stealing. Each worker reads its
+     * blocks through its own input dataset handle, computes their zoom and
+     * hands the zoomed blocks over to a coalescing writer which flushes full
+     * width strips in scan order.
+     *
+     * \param block_batches batches of blocks to stream
+     * \param frequency_zoom frequency zoom to apply on stream block
+     * \param filter filter to apply on stream block
+     * \param tile_cache decoded tile cache shared by the workers, nullptr to
+     *        read blocks directly
+     * \return false if a block could not be read, zoomed or written
+     */
+    template <typename T>
+    bool RunMultithreadStream(
+          std::vector<gdal::StreamBlockBatch> block_batches,
+          const IFrequencyZoom& frequency_zoom, const Filter& filter,
+          gdal::BasicTileCache<T>* tile_cache);
+
+    /**
+     * \brief Read, zoom and write a batch of blocks
+     * \param block_batch blocks of the same size and padding
+     * \param input_dataset input dataset handle of the calling thread
+     * \param frequency_zoom frequency zoom to apply on stream block
+     * \param filter filter to apply on stream block
+     * \param tile_cache decoded tile cache, nullptr to read blocks directly
+     * \param block_writer writer of the zoomed blocks
+     * \return false if a block could not be read or written
+     */
+    template <typename T>
+    bool ProcessBlockBatch(const gdal::StreamBlockBatch& block_batch,
+                           GDALDataset* input_dataset,
+                           const IFrequencyZoom& frequency_zoom,
+                           const Filter& filter,
+                           gdal::BasicTileCache<T>* tile_cache,
+                           gdal::CoalescingWriter& block_writer);
+
+    /**
+     * \brief Compute the zoom of all the bands of a batch of blocks
+     *
+     * Band images of the batch share their size and padding: they are zoomed
+     * together with batched FFTs.
      *
      * \param frequency_zoom frequency zoom to apply on stream block
      * \param filter filter to apply on stream block
+     * \param blocks blocks of the same size and padding, band images are
+     *        replaced by their zoom
+     */
+    template <typename T>
+    void ZoomBlocks(const IFrequencyZoom& frequency_zoom, const Filter& filter,
+                    std::vector<gdal::BasicStreamBlock<T>>& blocks) const;
+
+    /**
+     * \brief Group consecutive blocks of the grid with the same size and
+     *        padding into batches
+     * \return batches in scan order
+     */
+    std::vector<gdal::StreamBlockBatch> CreateBlockBatches() const;
+
+    /**
+     * \brief Sizes of the zoomed block FFTs the filter is applied on
+     * \return distinct sizes of the block grid
      */
-    void RunMultithreadStream(const IFrequencyZoom& frequency_zoom,
-                              const Filter& filter);
+    std::vector<Size> ComputeZoomedBlockSizes() const;
 
   private:
     unsigned int max_parallel_workers_;
+    std::size_t max_tile_cache_bytes_;
+    unsigned int batch_size_;
+    bool prepare_filter_spectra_;
+    bool trim_buffer_pool_;
     Size block_size_;
     ZoomRatio zoom_ratio_;
     gdal::InputStream input_stream_;
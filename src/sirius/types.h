@@ -27,9 +27,17 @@
 #include <array>
 #include <vector>
 
+#include "sirius/utils/aligned_allocator.h"
+
 namespace sirius {
 
-using Buffer = std::vector<double>;
+/**
+ * \brief Sample buffer, aligned for SIMD and left uninitialized on resize
+ */
+template <typename T>
+using BasicBuffer = std::vector<T, utils::AlignedAllocator<T>>;
+
+using Buffer = BasicBuffer<double>;
 
 /**
  * \brief Data class that represents the size of an image
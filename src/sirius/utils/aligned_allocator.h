@@ -0,0 +1,103 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIRIUS_UTILS_ALIGNED_ALLOCATOR_H_
+#define SIRIUS_UTILS_ALIGNED_ALLOCATOR_H_
+
+#include <cstddef>
+
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "sirius/utils/buffer_pool.h"
+
+namespace sirius {
+namespace utils {
+
+/**
+ * \brief Allocator of SIMD aligned buffers
+ *
+ * Memory is drawn from the BufferPool and aligned on kBufferAlignment bytes
+ *   so that FFTW can use its SIMD kernels directly on image buffers.
+ * Elements constructed without arguments are default-initialized: resizing a
+ *   buffer of arithmetic values does not fill it with 0.
+ *
+ * \tparam T value type
+ */
+template <typename T>
+class AlignedAllocator {
+  public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U>;
+    };
+
+  public:
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        void* ptr = BufferPool::Instance().Allocate(n * sizeof(T));
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, std::size_t) noexcept {
+        BufferPool::Instance().Release(ptr);
+    }
+
+    template <typename U>
+    void construct(U* ptr) noexcept(
+          std::is_nothrow_default_constructible<U>::value) {
+        ::new (static_cast<void*>(ptr)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* ptr, Args&&... args) {
+        ::new (static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) {
+    return false;
+}
+
+}  // namespace utils
+}  // namespace sirius
+
+#endif  // SIRIUS_UTILS_ALIGNED_ALLOCATOR_H_
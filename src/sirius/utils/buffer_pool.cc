@@ -0,0 +1,259 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sirius/utils/buffer_pool.h"
+
+#include <cstdlib>
+
+#include <limits>
+
+namespace sirius {
+namespace utils {
+
+namespace detail {
+
+/**
+ * \brief Free lists of the current thread
+ *
+ * Cached buffers are given back to the global free lists on thread exit
+ */
+struct LocalFreeLists {
+    ~LocalFreeLists();
+
+    BufferPool::FreeLists lists;
+    std::size_t cached_bytes{0};
+};
+
+}  // namespace detail
+
+namespace {
+
+// trivially destructible: still readable while thread locals are destroyed
+thread_local bool is_local_free_lists_destroyed = false;
+
+detail::LocalFreeLists& GetLocalFreeLists() {
+    static thread_local detail::LocalFreeLists local_lists;
+    return local_lists;
+}
+
+// each buffer is preceded by a header storing its size class
+// (0 for unpooled buffers)
+constexpr std::size_t kHeaderSize = kBufferAlignment;
+
+void* AllocateBlock(std::size_t byte_count, std::size_t size_class) {
+    if (byte_count > std::numeric_limits<std::size_t>::max() - kHeaderSize) {
+        return nullptr;
+    }
+    void* block = nullptr;
+    if (posix_memalign(&block, kBufferAlignment, kHeaderSize + byte_count) !=
+        0) {
+        return nullptr;
+    }
+    *static_cast<std::size_t*>(block) = size_class;
+    return static_cast<char*>(block) + kHeaderSize;
+}
+
+void FreeBlock(void* buffer) {
+    std::free(static_cast<char*>(buffer) - kHeaderSize);
+}
+
+std::size_t GetSizeClass(void* buffer) {
+    return *reinterpret_cast<std::size_t*>(static_cast<char*>(buffer) -
+                                           kHeaderSize);
+}
+
+void* PopBuffer(BufferPool::FreeLists& lists, std::size_t size_class) {
+    auto it = lists.find(size_class);
+    if (it == lists.end() || it->second.empty()) {
+        return nullptr;
+    }
+    void* buffer = it->second.back();
+    it->second.pop_back();
+    return buffer;
+}
+
+std::size_t FreeAll(BufferPool::FreeLists& lists) {
+    std::size_t freed_bytes = 0;
+    for (auto& entry : lists) {
+        for (void* buffer : entry.second) {
+            FreeBlock(buffer);
+        }
+        freed_bytes += entry.first * entry.second.size();
+    }
+    lists.clear();
+    return freed_bytes;
+}
+
+}  // namespace
+
+detail::LocalFreeLists::~LocalFreeLists() {
+    is_local_free_lists_destroyed = true;
+    BufferPool::Instance().MoveToGlobalLists(lists);
+}
+
+constexpr std::size_t BufferPool::kMinPooledSize;
+constexpr std::size_t BufferPool::kMaxLocalCachedSize;
+constexpr std::size_t BufferPool::kMaxCachedSize;
+
+BufferPool& BufferPool::Instance() {
+    static BufferPool instance;
+    return instance;
+}
+
+BufferPool::~BufferPool() { Clear(); }
+
+std::size_t BufferPool::SizeClass(std::size_t byte_count) {
+    if (byte_count <= kMinPooledSize) {
+        return kMinPooledSize;
+    }
+    int msb = 0;
+    for (std::size_t value = byte_count; value > 1; value >>= 1) {
+        ++msb;
+    }
+    std::size_t step = std::size_t{1} << (msb - 3);
+    return (byte_count + step - 1) / step * step;
+}
+
+void* BufferPool::Allocate(std::size_t byte_count) {
+    if (byte_count < kMinPooledSize) {
+        unpooled_count_++;
+        return AllocateBlock(byte_count, 0);
+    }
+
+    return Acquire(SizeClass(byte_count));
+}
+
+void BufferPool::Release(void* buffer) {
+    if (buffer == nullptr) {
+        return;
+    }
+
+    std::size_t size_class = GetSizeClass(buffer);
+    if (size_class == 0) {
+        FreeBlock(buffer);
+        return;
+    }
+    Cache(buffer, size_class);
+}
+
+void BufferPool::Clear() {
+    std::lock_guard<std::mutex> lock(global_mutex_);
+    cached_bytes_ -= FreeAll(global_lists_);
+    global_cached_bytes_ = 0;
+}
+
+void BufferPool::Trim() {
+    if (!is_local_free_lists_destroyed) {
+        auto& local_lists = GetLocalFreeLists();
+        cached_bytes_ -= FreeAll(local_lists.lists);
+        local_lists.cached_bytes = 0;
+    }
+    Clear();
+}
+
+BufferPoolStats BufferPool::GetStats() const {
+    BufferPoolStats stats;
+    stats.hit_count = hit_count_;
+    stats.miss_count = miss_count_;
+    stats.unpooled_count = unpooled_count_;
+    stats.cached_bytes = cached_bytes_;
+    std::lock_guard<std::mutex> lock(global_mutex_);
+    stats.global_cached_bytes = global_cached_bytes_;
+    return stats;
+}
+
+void* BufferPool::Acquire(std::size_t size_class) {
+#ifdef SIRIUS_ENABLE_CACHE_OPTIMIZATION
+    if (!is_local_free_lists_destroyed) {
+        auto& local_lists = GetLocalFreeLists();
+        void* buffer = PopBuffer(local_lists.lists, size_class);
+        if (buffer != nullptr) {
+            local_lists.cached_bytes -= size_class;
+            cached_bytes_ -= size_class;
+            hit_count_++;
+            return buffer;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(global_mutex_);
+        void* buffer = PopBuffer(global_lists_, size_class);
+        if (buffer != nullptr) {
+            global_cached_bytes_ -= size_class;
+            cached_bytes_ -= size_class;
+            hit_count_++;
+            return buffer;
+        }
+    }
+#endif  // SIRIUS_ENABLE_CACHE_OPTIMIZATION
+
+    miss_count_++;
+    return AllocateBlock(size_class, size_class);
+}
+
+void BufferPool::Cache(void* buffer, std::size_t size_class) {
+#ifdef SIRIUS_ENABLE_CACHE_OPTIMIZATION
+    // one budget for all the free lists: idle buffers of many workers cannot
+    // pile up
+    if (ReserveCachedBytes(size_class)) {
+        if (!is_local_free_lists_destroyed) {
+            auto& local_lists = GetLocalFreeLists();
+            if (local_lists.cached_bytes + size_class <= kMaxLocalCachedSize) {
+                local_lists.lists[size_class].push_back(buffer);
+                local_lists.cached_bytes += size_class;
+                return;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(global_mutex_);
+        global_lists_[size_class].push_back(buffer);
+        global_cached_bytes_ += size_class;
+        return;
+    }
+#endif  // SIRIUS_ENABLE_CACHE_OPTIMIZATION
+
+    FreeBlock(buffer);
+}
+
+bool BufferPool::ReserveCachedBytes(std::size_t byte_count) {
+    std::size_t cached_bytes = cached_bytes_;
+    do {
+        if (cached_bytes + byte_count > kMaxCachedSize) {
+            return false;
+        }
+    } while (!cached_bytes_.compare_exchange_weak(cached_bytes,
+                                                  cached_bytes + byte_count));
+    return true;
+}
+
+void BufferPool::MoveToGlobalLists(FreeLists& lists) {
+    std::lock_guard<std::mutex> lock(global_mutex_);
+    for (auto& entry : lists) {
+        auto& global_list = global_lists_[entry.first];
+        global_list.insert(global_list.end(), entry.second.begin(),
+                           entry.second.end());
+        global_cached_bytes_ += entry.first * entry.second.size();
+    }
+    lists.clear();
+}
+
+}  // namespace utils
+}  // namespace sirius
@@ -0,0 +1,186 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIRIUS_UTILS_BUFFER_POOL_H_
+#define SIRIUS_UTILS_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace sirius {
+namespace utils {
+
+namespace detail {
+struct LocalFreeLists;
+}  // namespace detail
+
+/**
+ * \brief Alignment of the pooled buffers (cache line, AVX-512)
+ */
+constexpr std::size_t kBufferAlignment = 64;
+
+/**
+ * \brief Statistics of the buffer pool
+ */
+struct BufferPoolStats {
+    /** allocations served by a cached buffer */
+    std::uint64_t hit_count{0};
+    /** allocations that required a new buffer */
+    std::uint64_t miss_count{0};
+    /** allocations too small to be pooled */
+    std::uint64_t unpooled_count{0};
+    /** bytes cached in the global free lists */
+    std::size_t global_cached_bytes{0};
+    /** bytes cached in the thread and global free lists */
+    std::size_t cached_bytes{0};
+};
+
+/**
+ * \brief Pool of aligned buffers grouped by size class
+ *
+ * Released buffers are kept in a free list of the releasing thread and moved
+ *   to a global free list when the thread cache is full or when the thread
+ *   exits. Buffers are allocated when no cached buffer of the requested size
+ *   class is available. The thread and global free lists share a single byte
+ *   budget (kMaxCachedSize): a released buffer which does not fit is freed.
+ *
+ * Buffers smaller than kMinPooledSize are allocated and freed directly.
+ * Without SIRIUS_ENABLE_CACHE_OPTIMIZATION, no buffer is cached.
+ *
+ * Thread safe
+ */
+class BufferPool {
+  public:
+    /**
+     * \brief Smallest pooled buffer size in bytes
+     */
+    static constexpr std::size_t kMinPooledSize = 64 * 1024;
+    /**
+     * \brief Maximum size in bytes of the buffers cached by a thread
+     */
+    static constexpr std::size_t kMaxLocalCachedSize = 128 * 1024 * 1024;
+    /**
+     * \brief Maximum size in bytes of the buffers cached by all the threads
+     *        and the global free lists
+     */
+    static constexpr std::size_t kMaxCachedSize = 512 * 1024 * 1024;
+
+    using FreeLists = std::map<std::size_t, std::vector<void*>>;
+
+  public:
+    static BufferPool& Instance();
+
+    ~BufferPool();
+
+    // non copyable
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+    // non moveable
+    BufferPool(BufferPool&&) = delete;
+    BufferPool& operator=(BufferPool&&) = delete;
+
+    /**
+     * \brief Get a buffer aligned on kBufferAlignment bytes
+     *
+     * The buffer is not initialized
+     *
+     * \param byte_count requested size in bytes
+     * \return buffer or nullptr if the allocation failed
+     */
+    void* Allocate(std::size_t byte_count);
+
+    /**
+     * \brief Give back a buffer obtained by Allocate
+     * \param buffer buffer to release (nullptr is ignored)
+     */
+    void Release(void* buffer);
+
+    /**
+     * \brief Free the buffers of the global free lists
+     */
+    void Clear();
+
+    /**
+     * \brief Free the buffers cached by the calling thread and the buffers of
+     *        the global free lists
+     *
+     * Call it at the end of a run so that size classes which are not used
+     *   anymore do not stay pinned. Buffers cached by the other living
+     *   threads are kept.
+     */
+    void Trim();
+
+    /**
+     * \brief Get the pool statistics
+     */
+    BufferPoolStats GetStats() const;
+
+    /**
+     * \brief Size class of a buffer size
+     *
+     * Sizes are rounded up on 3 significant bits (at most 12.5% of waste)
+     *
+     * \param byte_count buffer size in bytes
+     * \return size class in bytes
+     */
+    static std::size_t SizeClass(std::size_t byte_count);
+
+  private:
+    friend struct detail::LocalFreeLists;
+
+    BufferPool() = default;
+
+    void* Acquire(std::size_t size_class);
+    void Cache(void* buffer, std::size_t size_class);
+
+    /**
+     * \brief Reserve room for a buffer in the cache budget
+     * \return false if the budget is exhausted
+     */
+    bool ReserveCachedBytes(std::size_t byte_count);
+
+    /**
+     * \brief Move the buffers of an exiting thread to the global free lists
+     *
+     * Buffers are already accounted in the cache budget
+     */
+    void MoveToGlobalLists(FreeLists& lists);
+
+  private:
+    mutable std::mutex global_mutex_;
+    FreeLists global_lists_;
+    std::size_t global_cached_bytes_{0};
+    std::atomic<std::size_t> cached_bytes_{0};
+
+    std::atomic<std::uint64_t> hit_count_{0};
+    std::atomic<std::uint64_t> miss_count_{0};
+    std::atomic<std::uint64_t> unpooled_count_{0};
+};
+
+}  // namespace utils
+}  // namespace sirius
+
+#endif  // SIRIUS_UTILS_BUFFER_POOL_H_
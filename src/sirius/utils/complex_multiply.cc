@@ -0,0 +1,235 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sirius/utils/complex_multiply.h"
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIRIUS_HAS_X86_SIMD_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace sirius {
+namespace utils {
+
+namespace {
+
+// (a+ib)*(a'+ib') = (aa'-bb')+i(ab'+ba')
+template <typename T>
+void MultiplyComplexScalar(T* lhs, const T* rhs, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        T re = lhs[2 * i];
+        T im = lhs[2 * i + 1];
+        lhs[2 * i] = re * rhs[2 * i] - im * rhs[2 * i + 1];
+        lhs[2 * i + 1] = re * rhs[2 * i + 1] + im * rhs[2 * i];
+    }
+}
+
+#ifdef SIRIUS_HAS_X86_SIMD_DISPATCH
+
+// SIMD kernels: rhs real parts are duplicated on both lanes of a complex,
+// lhs lanes are swapped and multiplied by the duplicated rhs imaginary parts
+// then subtracted from (real lane) or added to (imaginary lane) lhs * rhs_re
+
+__attribute__((target("sse2"))) void MultiplyComplexSse2(double* lhs,
+                                                         const double* rhs,
+                                                         std::size_t count) {
+    const __m128d sign = _mm_set_pd(0.0, -0.0);
+    for (std::size_t i = 0; i < count; ++i) {
+        __m128d a = _mm_loadu_pd(lhs + 2 * i);
+        __m128d b = _mm_loadu_pd(rhs + 2 * i);
+        __m128d b_re = _mm_unpacklo_pd(b, b);
+        __m128d b_im = _mm_unpackhi_pd(b, b);
+        __m128d a_swap = _mm_shuffle_pd(a, a, 1);
+        __m128d cross = _mm_xor_pd(_mm_mul_pd(a_swap, b_im), sign);
+        _mm_storeu_pd(lhs + 2 * i, _mm_add_pd(_mm_mul_pd(a, b_re), cross));
+    }
+}
+
+__attribute__((target("sse2"))) void MultiplyComplexSse2(float* lhs,
+                                                         const float* rhs,
+                                                         std::size_t count) {
+    const __m128 sign = _mm_set_ps(0.0f, -0.0f, 0.0f, -0.0f);
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128 a = _mm_loadu_ps(lhs + 2 * i);
+        __m128 b = _mm_loadu_ps(rhs + 2 * i);
+        __m128 b_re = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 b_im = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128 a_swap = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 cross = _mm_xor_ps(_mm_mul_ps(a_swap, b_im), sign);
+        _mm_storeu_ps(lhs + 2 * i, _mm_add_ps(_mm_mul_ps(a, b_re), cross));
+    }
+    MultiplyComplexScalar(lhs + 2 * i, rhs + 2 * i, count - i);
+}
+
+__attribute__((target("avx2,fma"))) void MultiplyComplexAvx2(
+      double* lhs, const double* rhs, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m256d a = _mm256_loadu_pd(lhs + 2 * i);
+        __m256d b = _mm256_loadu_pd(rhs + 2 * i);
+        __m256d b_re = _mm256_movedup_pd(b);
+        __m256d b_im = _mm256_permute_pd(b, 0xF);
+        __m256d a_swap = _mm256_permute_pd(a, 0x5);
+        _mm256_storeu_pd(lhs + 2 * i,
+                         _mm256_fmaddsub_pd(a, b_re,
+                                            _mm256_mul_pd(a_swap, b_im)));
+    }
+    MultiplyComplexScalar(lhs + 2 * i, rhs + 2 * i, count - i);
+}
+
+__attribute__((target("avx2,fma"))) void MultiplyComplexAvx2(
+      float* lhs, const float* rhs, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256 a = _mm256_loadu_ps(lhs + 2 * i);
+        __m256 b = _mm256_loadu_ps(rhs + 2 * i);
+        __m256 b_re = _mm256_moveldup_ps(b);
+        __m256 b_im = _mm256_movehdup_ps(b);
+        __m256 a_swap = _mm256_permute_ps(a, 0xB1);
+        _mm256_storeu_ps(lhs + 2 * i,
+                         _mm256_fmaddsub_ps(a, b_re,
+                                            _mm256_mul_ps(a_swap, b_im)));
+    }
+    MultiplyComplexScalar(lhs + 2 * i, rhs + 2 * i, count - i);
+}
+
+// GCC reports false positives on the undefined masked operands of the
+// AVX-512 intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f"))) void MultiplyComplexAvx512(
+      double* lhs, const double* rhs, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m512d a = _mm512_loadu_pd(lhs + 2 * i);
+        __m512d b = _mm512_loadu_pd(rhs + 2 * i);
+        __m512d b_re = _mm512_movedup_pd(b);
+        __m512d b_im = _mm512_permute_pd(b, 0xFF);
+        __m512d a_swap = _mm512_permute_pd(a, 0x55);
+        _mm512_storeu_pd(lhs + 2 * i,
+                         _mm512_fmaddsub_pd(a, b_re,
+                                            _mm512_mul_pd(a_swap, b_im)));
+    }
+    MultiplyComplexScalar(lhs + 2 * i, rhs + 2 * i, count - i);
+}
+
+__attribute__((target("avx512f"))) void MultiplyComplexAvx512(
+      float* lhs, const float* rhs, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512 a = _mm512_loadu_ps(lhs + 2 * i);
+        __m512 b = _mm512_loadu_ps(rhs + 2 * i);
+        __m512 b_re = _mm512_moveldup_ps(b);
+        __m512 b_im = _mm512_movehdup_ps(b);
+        __m512 a_swap = _mm512_permute_ps(a, 0xB1);
+        _mm512_storeu_ps(lhs + 2 * i,
+                         _mm512_fmaddsub_ps(a, b_re,
+                                            _mm512_mul_ps(a_swap, b_im)));
+    }
+    MultiplyComplexScalar(lhs + 2 * i, rhs + 2 * i, count - i);
+}
+
+#pragma GCC diagnostic pop
+
+SimdLevel DetectSimdLevel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::kAvx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::kAvx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::kSse2;
+    }
+    return SimdLevel::kScalar;
+}
+
+#else
+
+SimdLevel DetectSimdLevel() { return SimdLevel::kScalar; }
+
+#endif  // SIRIUS_HAS_X86_SIMD_DISPATCH
+
+}  // namespace
+
+SimdLevel GetSimdLevel() {
+    static const SimdLevel level = DetectSimdLevel();
+    return level;
+}
+
+const char* SimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::kSse2:
+            return "sse2";
+        case SimdLevel::kAvx2:
+            return "avx2";
+        case SimdLevel::kAvx512:
+            return "avx512";
+        case SimdLevel::kScalar:
+        default:
+            return "scalar";
+    }
+}
+
+template <typename T>
+void MultiplyComplex(T* lhs, const T* rhs, std::size_t count) {
+    MultiplyComplex(GetSimdLevel(), lhs, rhs, count);
+}
+
+template <typename T>
+void MultiplyComplex(SimdLevel level, T* lhs, const T* rhs,
+                     std::size_t count) {
+    level = std::min(level, GetSimdLevel());
+    switch (level) {
+#ifdef SIRIUS_HAS_X86_SIMD_DISPATCH
+        case SimdLevel::kAvx512:
+            MultiplyComplexAvx512(lhs, rhs, count);
+            break;
+        case SimdLevel::kAvx2:
+            MultiplyComplexAvx2(lhs, rhs, count);
+            break;
+        case SimdLevel::kSse2:
+            MultiplyComplexSse2(lhs, rhs, count);
+            break;
+#endif  // SIRIUS_HAS_X86_SIMD_DISPATCH
+        case SimdLevel::kScalar:
+        default:
+            MultiplyComplexScalar(lhs, rhs, count);
+            break;
+    }
+}
+
+template void MultiplyComplex<double>(double* lhs, const double* rhs,
+                                      std::size_t count);
+template void MultiplyComplex<float>(float* lhs, const float* rhs,
+                                     std::size_t count);
+template void MultiplyComplex<double>(SimdLevel level, double* lhs,
+                                      const double* rhs, std::size_t count);
+template void MultiplyComplex<float>(SimdLevel level, float* lhs,
+                                     const float* rhs, std::size_t count);
+
+}  // namespace utils
+}  // namespace sirius
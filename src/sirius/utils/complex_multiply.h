@@ -0,0 +1,82 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIRIUS_UTILS_COMPLEX_MULTIPLY_H_
+#define SIRIUS_UTILS_COMPLEX_MULTIPLY_H_
+
+#include <cstddef>
+
+namespace sirius {
+namespace utils {
+
+/**
+ * \brief SIMD instruction set of a complex multiply kernel
+ */
+enum class SimdLevel {
+    kScalar = 0, /**< portable scalar loop */
+    kSse2,       /**< SSE2 (x86) */
+    kAvx2,       /**< AVX2 + FMA (x86) */
+    kAvx512      /**< AVX-512F (x86) */
+};
+
+/**
+ * \brief Get the best SIMD level supported by the CPU
+ *
+ * Detected once at runtime
+ */
+SimdLevel GetSimdLevel();
+
+/**
+ * \brief Get the name of a SIMD level
+ */
+const char* SimdLevelName(SimdLevel level);
+
+/**
+ * \brief Pointwise product of interleaved complex arrays: lhs[i] *= rhs[i]
+ *
+ * Uses the best kernel supported by the CPU (see GetSimdLevel)
+ *
+ * \param lhs complex array (re, im pairs) multiplied in place
+ * \param rhs complex array (re, im pairs)
+ * \param count complex count
+ */
+template <typename T>
+void MultiplyComplex(T* lhs, const T* rhs, std::size_t count);
+
+/**
+ * \brief Pointwise product of interleaved complex arrays with a given kernel
+ *
+ * Levels not supported by the CPU or by the build fall back to the best
+ * supported lower level
+ *
+ * \param level SIMD level of the kernel
+ * \param lhs complex array (re, im pairs) multiplied in place
+ * \param rhs complex array (re, im pairs)
+ * \param count complex count
+ */
+template <typename T>
+void MultiplyComplex(SimdLevel level, T* lhs, const T* rhs,
+                     std::size_t count);
+
+}  // namespace utils
+}  // namespace sirius
+
+#endif  // SIRIUS_UTILS_COMPLEX_MULTIPLY_H_
@@ -65,6 +65,42 @@ class LRUCache {
         return {};
     }
 
+    /**
+     * \brief Get a cache element or insert a new one
+     *
+     * Lookup and insertion are atomic: concurrent callers requesting a
+     * missing key get the element created by the first one.
+     *
+     * \param key key of the requested element
+     * \param create_element function returning the element to insert,
+     *        called under the cache lock. If it throws, the exception is
+     *        propagated and nothing is inserted
+     * \return cache element
+     */
+    template <typename Function>
+    Value GetOrInsert(const Key& key, Function create_element) {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        if (elements_.count(key) > 0) {
+            ordered_keys_.remove(key);
+            ordered_keys_.push_front(key);
+            return elements_[key];
+        }
+
+        // key is only recorded once the element exists: a throwing
+        // create_element leaves the cache unchanged
+        Value element = create_element();
+        elements_[key] = element;
+        ordered_keys_.push_front(key);
+
+        if (elements_.size() > CacheSize) {
+            // too many entries, remove the last recently used value
+            auto lru_key = ordered_keys_.back();
+            ordered_keys_.pop_back();
+            elements_.erase(lru_key);
+        }
+        return element;
+    }
+
     /**
      * \brief Insert an element in the cache
      *
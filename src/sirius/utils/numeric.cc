@@ -43,7 +43,8 @@ int Gcd(int a, int b) {
     return a;
 }
 
-void FFTShift2D(const double* data, const Size& size, double* shifted_data) {
+template <typename T>
+void FFTShift2D(const T* data, const Size& size, T* shifted_data) {
     int row_shift = size.row / 2;
     int col_shift = size.col / 2;
 
@@ -57,7 +58,8 @@ void FFTShift2D(const double* data, const Size& size, double* shifted_data) {
     }
 }
 
-void IFFTShift2D(const double* data, const Size& size, double* shifted_data) {
+template <typename T>
+void IFFTShift2D(const T* data, const Size& size, T* shifted_data) {
     int row_shift = std::ceil(static_cast<double>(size.row) / 2);
     int col_shift = std::ceil(static_cast<double>(size.col) / 2);
 
@@ -71,6 +73,15 @@ void IFFTShift2D(const double* data, const Size& size, double* shifted_data) {
     }
 }
 
+template void FFTShift2D<double>(const double* data, const Size& size,
+                                 double* shifted_data);
+template void FFTShift2D<float>(const float* data, const Size& size,
+                                float* shifted_data);
+template void IFFTShift2D<double>(const double* data, const Size& size,
+                                  double* shifted_data);
+template void IFFTShift2D<float>(const float* data, const Size& size,
+                                 float* shifted_data);
+
 Size GenerateDyadicSize(const Size& size, const int res_in,
                         const Size& padding_size) {
     int h = size.row;
@@ -145,6 +156,103 @@ Size GenerateZoomCompliantSize(const Size& size, const ZoomRatio& zoom_r) {
     return {h, w};
 }
 
+Size GenerateTileAlignedSize(const Size& size, const Size& tile_size,
+                             const Size& max_size) {
+    auto align = [](int length, int tile_length, int max_length) {
+        if (tile_length <= 1 || tile_length > max_length) {
+            return length;
+        }
+        int tile_count = static_cast<int>(
+              std::lround(length / static_cast<double>(tile_length)));
+        tile_count =
+              std::min(std::max(tile_count, 1), max_length / tile_length);
+        return tile_count * tile_length;
+    };
+
+    Size aligned_size(align(size.row, tile_size.row, max_size.row),
+                      align(size.col, tile_size.col, max_size.col));
+    if (!(aligned_size == size)) {
+        LOG("numeric", debug, "block aligned to {}x{}", aligned_size.row,
+            aligned_size.col);
+    }
+    return aligned_size;
+}
+
+bool IsSmoothSize(int length) {
+    if (length <= 0) {
+        return false;
+    }
+    for (int factor : {2, 3, 5, 7}) {
+        while (length % factor == 0) {
+            length /= factor;
+        }
+    }
+    return length == 1;
+}
+
+Size GenerateSmoothSize(const Size& size, const Size& tile_size,
+                        const Size& max_size, const Size& padding_size,
+                        int res_in, const Size& step) {
+    // zoomed size can only be smooth if the zoom coefficient is
+    bool is_smooth_zoom = IsSmoothSize(res_in);
+    auto is_smooth = [is_smooth_zoom, res_in](int padded_length) {
+        return IsSmoothSize(padded_length) &&
+               (!is_smooth_zoom || IsSmoothSize(padded_length * res_in));
+    };
+
+    auto smooth = [&is_smooth](int length, int tile_length, int max_length,
+                               int padding_length, int step_length) {
+        if (length <= 0 || is_smooth(length + 2 * padding_length)) {
+            return length;
+        }
+
+        // adjacent tile multiples
+        if (tile_length > 1 && tile_length <= max_length &&
+            length % tile_length == 0) {
+            int tile_count = length / tile_length;
+            int max_tile_count = max_length / tile_length;
+            for (int candidate_count : {tile_count - 1, tile_count + 1}) {
+                if (candidate_count < 1 || candidate_count > max_tile_count) {
+                    continue;
+                }
+                int candidate = candidate_count * tile_length;
+                if (is_smooth(candidate + 2 * padding_length)) {
+                    return candidate;
+                }
+            }
+        }
+
+        // nearest smooth padded size, larger first
+        step_length = std::max(step_length, 1);
+        for (int candidate = length + step_length; candidate <= max_length;
+             candidate += step_length) {
+            if (is_smooth(candidate + 2 * padding_length)) {
+                return candidate;
+            }
+        }
+        for (int candidate = length - step_length; candidate > 0;
+             candidate -= step_length) {
+            if (is_smooth(candidate + 2 * padding_length)) {
+                return candidate;
+            }
+        }
+        return length;
+    };
+
+    Size smooth_size(
+          smooth(size.row, tile_size.row, max_size.row, padding_size.row,
+                 step.row),
+          smooth(size.col, tile_size.col, max_size.col, padding_size.col,
+                 step.col));
+    if (!(smooth_size == size)) {
+        LOG("numeric", debug, "block resized to {}x{} (padded size {}x{})",
+            smooth_size.row, smooth_size.col,
+            smooth_size.row + 2 * padding_size.row,
+            smooth_size.col + 2 * padding_size.col);
+    }
+    return smooth_size;
+}
+
 std::vector<double> ComputeFFTFreq(const int n_samples, const bool half) {
     std::vector<double> freq;
 
@@ -36,12 +36,14 @@ int Gcd(int a, int b);
 /**
  * \brief FFTShift 2D matrix
  */
-void FFTShift2D(const double* data, const Size& size, double* shifted_data);
+template <typename T>
+void FFTShift2D(const T* data, const Size& size, T* shifted_data);
 
 /**
  * \brief IFFTShift 2D matrix
  */
-void IFFTShift2D(const double* data, const Size& size, double* shifted_data);
+template <typename T>
+void IFFTShift2D(const T* data, const Size& size, T* shifted_data);
 
 /**
  * \brief Compute frequencies for which fft will be calculated
@@ -69,6 +71,54 @@ Size GenerateDyadicSize(const Size& size, const int res_in,
  */
 Size GenerateZoomCompliantSize(const Size& size, const ZoomRatio& zoom_r);
 
+/**
+ * \brief Align a block size on the native block layout of an image
+ *
+ * Each dimension is rounded to the nearest multiple of the native block
+ * dimension (at least one native block). Dimensions in which the image is
+ * not tiled (native block of one pixel or larger than max_size) are left
+ * unchanged.
+ *
+ * \param size size to be aligned
+ * \param tile_size native block size (tile or strip) of the image
+ * \param max_size largest allowed size
+ * \return aligned size
+ */
+Size GenerateTileAlignedSize(const Size& size, const Size& tile_size,
+                             const Size& max_size);
+
+/**
+ * \brief Check that a length only has 2, 3, 5 and 7 as prime factors
+ *
+ * FFTW is the most efficient on such lengths.
+ *
+ * \param length length to check
+ * \return true if length is 2-3-5-7 smooth
+ */
+bool IsSmoothSize(int length);
+
+/**
+ * \brief Resize a block so that its padded and zoomed FFT sizes are 2-3-5-7
+ *        smooth
+ *
+ * The padded size of a block is size + 2 * padding_size and its zoomed size
+ * is res_in times the padded size. The adjacent tile multiples are tried
+ * first. If none of them is smooth, the next size whose padded size is
+ * smooth is used (the previous one if it exceeds max_size): the block is then
+ * a few pixels off the tile grid. Dimensions are kept multiple of step.
+ *
+ * \param size size to be resized (e.g. output of GenerateTileAlignedSize)
+ * \param tile_size native block size (tile or strip) of the image
+ * \param max_size largest allowed size
+ * \param padding_size size of the margins
+ * \param res_in zoom coefficient that will be applied to the fft
+ * \param step block dimensions must be multiple of step
+ * \return new size
+ */
+Size GenerateSmoothSize(const Size& size, const Size& tile_size,
+                        const Size& max_size, const Size& padding_size,
+                        int res_in, const Size& step = {1, 1});
+
 /**
  * \brief Create coordinates vector
  * \param x_min beginning of x axis
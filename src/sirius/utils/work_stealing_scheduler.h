@@ -0,0 +1,118 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIRIUS_UTILS_WORK_STEALING_SCHEDULER_H_
+#define SIRIUS_UTILS_WORK_STEALING_SCHEDULER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sirius {
+namespace utils {
+
+/**
+ * \brief Work stealing scheduler
+ *
+ * Each worker owns a deque of tasks. Tasks are dealt round-robin between the
+ * deques so that workers start in scan order. A worker pops tasks from the
+ * front of its own deque and, when it is empty, steals tasks from the back of
+ * the other deques. Every deque has its own lock: workers only contend when
+ * they steal.
+ *
+ * No task can be added while the scheduler is running, so a worker stops as
+ * soon as it cannot find any task to steal.
+ */
+template <typename Task>
+class WorkStealingScheduler {
+  public:
+    /**
+     * \brief Instanciate a scheduler
+     * \param worker_count number of worker threads (at least 1)
+     */
+    explicit WorkStealingScheduler(unsigned int worker_count);
+
+    ~WorkStealingScheduler() = default;
+
+    WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+    WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+    WorkStealingScheduler(WorkStealingScheduler&&) = delete;
+    WorkStealingScheduler& operator=(WorkStealingScheduler&&) = delete;
+
+    /**
+     * \brief Process tasks on the workers and wait for their completion
+     *
+     * function is called as function(worker_index, task) and returns false
+     * to cancel the remaining tasks.
+     *
+     * \param tasks tasks to process
+     * \param function task function, called concurrently
+     *
+     * \throw the first exception thrown by function. Remaining tasks are
+     *        cancelled.
+     */
+    template <typename Function>
+    void Run(std::vector<Task> tasks, Function function);
+
+    /**
+     * \brief Number of worker threads
+     */
+    unsigned int worker_count() const { return worker_count_; }
+
+    /**
+     * \brief Number of tasks stolen during the last run
+     */
+    std::size_t steal_count() const { return steal_count_; }
+
+  private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    /**
+     * \brief Pop a task from the front of the worker deque
+     * \return true if a task was popped
+     */
+    bool PopTask(unsigned int worker_index, Task& task);
+
+    /**
+     * \brief Steal a task from the back of another worker deque
+     * \return true if a task was stolen
+     */
+    bool StealTask(unsigned int worker_index, Task& task);
+
+  private:
+    unsigned int worker_count_;
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::atomic<bool> is_cancelled_{false};
+    std::atomic<std::size_t> steal_count_{0};
+};
+
+}  // namespace utils
+}  // namespace sirius
+
+#include "sirius/utils/work_stealing_scheduler.txx"
+
+#endif  // SIRIUS_UTILS_WORK_STEALING_SCHEDULER_H_
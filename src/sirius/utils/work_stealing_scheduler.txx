@@ -0,0 +1,124 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIRIUS_UTILS_WORK_STEALING_SCHEDULER_TXX_
+#define SIRIUS_UTILS_WORK_STEALING_SCHEDULER_TXX_
+
+#include <algorithm>
+#include <exception>
+#include <future>
+
+namespace sirius {
+namespace utils {
+
+template <typename Task>
+WorkStealingScheduler<Task>::WorkStealingScheduler(unsigned int worker_count)
+    : worker_count_(std::max(worker_count, 1u)) {
+    for (unsigned int i = 0; i < worker_count_; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+}
+
+template <typename Task>
+template <typename Function>
+void WorkStealingScheduler<Task>::Run(std::vector<Task> tasks,
+                                      Function function) {
+    is_cancelled_ = false;
+    steal_count_ = 0;
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        queues_[i % worker_count_]->tasks.push_back(std::move(tasks[i]));
+    }
+
+    auto worker_task = [this, &function](unsigned int worker_index) {
+        Task task;
+        try {
+            while (!is_cancelled_ && (PopTask(worker_index, task) ||
+                                      StealTask(worker_index, task))) {
+                if (!function(worker_index, task)) {
+                    is_cancelled_ = true;
+                }
+            }
+        } catch (...) {
+            is_cancelled_ = true;
+            throw;
+        }
+    };
+
+    std::vector<std::future<void>> worker_futures;
+    for (unsigned int i = 0; i < worker_count_; ++i) {
+        worker_futures.push_back(
+              std::async(std::launch::async, worker_task, i));
+    }
+
+    std::exception_ptr first_exception;
+    for (auto& worker_future : worker_futures) {
+        try {
+            worker_future.get();
+        } catch (...) {
+            if (!first_exception) {
+                first_exception = std::current_exception();
+            }
+        }
+    }
+
+    // drop cancelled tasks
+    for (auto& queue : queues_) {
+        queue->tasks.clear();
+    }
+
+    if (first_exception) {
+        std::rethrow_exception(first_exception);
+    }
+}
+
+template <typename Task>
+bool WorkStealingScheduler<Task>::PopTask(unsigned int worker_index,
+                                          Task& task) {
+    auto& queue = *queues_[worker_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+template <typename Task>
+bool WorkStealingScheduler<Task>::StealTask(unsigned int worker_index,
+                                            Task& task) {
+    for (unsigned int i = 1; i < worker_count_; ++i) {
+        auto& queue = *queues_[(worker_index + i) % worker_count_];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            ++steal_count_;
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace utils
+}  // namespace sirius
+
+#endif  // SIRIUS_UTILS_WORK_STEALING_SCHEDULER_TXX_
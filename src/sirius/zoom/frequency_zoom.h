@@ -22,6 +22,8 @@
 #ifndef SIRIUS_ZOOM_FREQUENCY_ZOOM_BASE_H_
 #define SIRIUS_ZOOM_FREQUENCY_ZOOM_BASE_H_
 
+#include <vector>
+
 #include "sirius/i_frequency_zoom.h"
 #include "sirius/image.h"
 
@@ -53,13 +55,61 @@ class FrequencyZoom final : public IFrequencyZoom,
                   const Padding& image_padding,
                   const Filter& filter = {}) const override;
 
+    FloatImage Compute(const ZoomRatio& ratio, const FloatImage& input,
+                       const Padding& image_padding,
+                       const Filter& filter = {}) const override;
+
+    std::vector<Image> Compute(const ZoomRatio& ratio,
+                               const std::vector<Image>& inputs,
+                               const Padding& image_padding,
+                               const Filter& filter = {}) const override;
+
+    std::vector<FloatImage> Compute(const ZoomRatio& ratio,
+                                    const std::vector<FloatImage>& inputs,
+                                    const Padding& image_padding,
+                                    const Filter& filter = {}) const override;
+
+    std::vector<Size> FilterSpectrumSizes(
+          const ZoomRatio& zoom_ratio, const std::vector<Size>& zoomed_sizes,
+          const Filter& filter) const override;
+
   private:
-    Image UnpadImage(const ZoomRatio& zoom_ratio, const Image& original_image,
-                     const Image& zoomed_image, const Padding& image_padding,
-                     const Filter& filter) const;
+    template <typename T>
+    BasicImage<T> ComputeImpl(const ZoomRatio& ratio,
+                              const BasicImage<T>& input,
+                              const Padding& image_padding,
+                              const Filter& filter) const;
+
+    template <typename T>
+    std::vector<BasicImage<T>> ComputeBatchImpl(
+          const ZoomRatio& ratio, const std::vector<BasicImage<T>>& inputs,
+          const Padding& image_padding, const Filter& filter) const;
+
+    template <typename T>
+    BasicImage<T> UnpadImage(const ZoomRatio& zoom_ratio,
+                             const BasicImage<T>& original_image,
+                             const BasicImage<T>& zoomed_image,
+                             const Padding& image_padding,
+                             const Filter& filter) const;
 
-    Image DecimateImage(const Image& zoomed_image,
-                        const ZoomRatio& zoom_ratio) const;
+    /**
+     * \brief Compute the grid of the output pixels in the zoomed padded
+     *        image
+     *
+     * Output pixels are the zoomed image pixels without padding, decimated
+     * by step.
+     *
+     * \param zoom_ratio zoom ratio
+     * \param original_size size of the image before padding
+     * \param image_padding padding of the image
+     * \param filter filter applied on the zoomed image
+     * \param step decimation step
+     * \return output grid
+     */
+    SamplingGrid ComputeOutputGrid(const ZoomRatio& zoom_ratio,
+                                   const Size& original_size,
+                                   const Padding& image_padding,
+                                   const Filter& filter, int step) const;
 };
 
 }  // namespace zoom
@@ -41,6 +41,58 @@ template <template <class> class ImageDecompositionPolicy, class ZoomStrategy>
 Image FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::Compute(
       const ZoomRatio& zoom_ratio, const Image& input_image,
       const Padding& image_padding, const Filter& filter) const {
+    return ComputeImpl(zoom_ratio, input_image, image_padding, filter);
+}
+
+template <template <class> class ImageDecompositionPolicy, class ZoomStrategy>
+FloatImage FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::Compute(
+      const ZoomRatio& zoom_ratio, const FloatImage& input_image,
+      const Padding& image_padding, const Filter& filter) const {
+    return ComputeImpl(zoom_ratio, input_image, image_padding, filter);
+}
+
+template <template <class> class ImageDecompositionPolicy, class ZoomStrategy>
+std::vector<Image>
+FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::Compute(
+      const ZoomRatio& zoom_ratio, const std::vector<Image>& input_images,
+      const Padding& image_padding, const Filter& filter) const {
+    return ComputeBatchImpl(zoom_ratio, input_images, image_padding, filter);
+}
+
+template <template <class> class ImageDecompositionPolicy, class ZoomStrategy>
+std::vector<FloatImage>
+FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::Compute(
+      const ZoomRatio& zoom_ratio, const std::vector<FloatImage>& input_images,
+      const Padding& image_padding, const Filter& filter) const {
+    return ComputeBatchImpl(zoom_ratio, input_images, image_padding, filter);
+}
+
+template <template <class> class ImageDecompositionPolicy, class ZoomStrategy>
+std::vector<Size>
+FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::FilterSpectrumSizes(
+      const ZoomRatio& zoom_ratio, const std::vector<Size>& zoomed_sizes,
+      const Filter& filter) const {
+    std::vector<Size> spectrum_sizes;
+    if (!filter.IsLoaded() || zoom_ratio.IsRealZoom()) {
+        // real zooms filter the sampled spectrum rows, cf. ZoomSampled
+        return spectrum_sizes;
+    }
+    for (const auto& zoomed_size : zoomed_sizes) {
+        // method inherited from ZoomStrategy
+        if (!this->UseDirectFilter(zoom_ratio.input_resolution(), zoomed_size,
+                                   filter)) {
+            spectrum_sizes.push_back(zoomed_size);
+        }
+    }
+    return spectrum_sizes;
+}
+
+template <template <class> class ImageDecompositionPolicy, class ZoomStrategy>
+template <typename T>
+BasicImage<T>
+FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::ComputeImpl(
+      const ZoomRatio& zoom_ratio, const BasicImage<T>& input_image,
+      const Padding& image_padding, const Filter& filter) const {
     LOG("frequency_zoom", trace, "compute {}/{} zoom of the image",
         zoom_ratio.input_resolution(), zoom_ratio.output_resolution());
 
@@ -52,34 +104,125 @@ Image FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::Compute(
     }
 
     LOG("frequency_zoom", trace, "pad image");
-    auto padded_image = input_image.CreatePaddedImage(image_padding);
+    // padded image is the FFT input and must have even dimensions
+    auto padded_image = input_image.CreatePaddedEvenImage(image_padding);
 
-    if (padded_image.size.col % 2 != 0 || padded_image.size.row % 2 != 0) {
-        padded_image.CreateEvenImage();
+    if (zoom_ratio.IsRealZoom()) {
+        // only the output pixels of the zoomed image are computed
+        LOG("frequency_zoom", trace, "decompose and zoom image samples");
+        auto grid =
+              ComputeOutputGrid(zoom_ratio, input_image.size, image_padding,
+                                filter, zoom_ratio.output_resolution());
+        // method inherited from ImageDecompositionPolicy
+        return this->DecomposeAndZoomSampled(zoom_ratio.input_resolution(),
+                                             padded_image, filter, grid);
     }
 
     LOG("frequency_zoom", trace, "decompose and zoom image");
     // method inherited from ImageDecompositionPolicy
-    Image result_image = this->DecomposeAndZoom(zoom_ratio.input_resolution(),
-                                                padded_image, filter);
+    BasicImage<T> result_image = this->DecomposeAndZoom(
+          zoom_ratio.input_resolution(), padded_image, filter);
 
     LOG("frequency_zoom", trace, "unpad zoomed image");
-    auto result = UnpadImage(zoom_ratio, input_image, result_image,
-                             image_padding, filter);
+    return UnpadImage(zoom_ratio, input_image, result_image, image_padding,
+                      filter);
+}
+
+template <template <class> class ImageDecompositionPolicy, class ZoomStrategy>
+template <typename T>
+std::vector<BasicImage<T>>
+FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::ComputeBatchImpl(
+      const ZoomRatio& zoom_ratio,
+      const std::vector<BasicImage<T>>& input_images,
+      const Padding& image_padding, const Filter& filter) const {
+    LOG("frequency_zoom", trace, "compute {}/{} zoom of {} images",
+        zoom_ratio.input_resolution(), zoom_ratio.output_resolution(),
+        input_images.size());
+
+    // basic checks
+    if (filter.IsLoaded() && !filter.CanBeApplied(zoom_ratio)) {
+        LOG("frequency_zoom", error,
+            "cannot apply this filter on this zoom ratio");
+        throw SiriusException("cannot apply this filter on this zoom ratio");
+    }
+
+    if (input_images.empty()) {
+        return {};
+    }
+
+    LOG("frequency_zoom", trace, "pad images");
+    std::vector<BasicImage<T>> padded_images;
+    padded_images.reserve(input_images.size());
+    bool is_same_size = true;
+    for (const auto& input_image : input_images) {
+        padded_images.push_back(
+              input_image.CreatePaddedEvenImage(image_padding));
+        is_same_size =
+              is_same_size &&
+              (padded_images.back().size == padded_images.front().size);
+    }
 
     if (zoom_ratio.IsRealZoom()) {
-        result = DecimateImage(result, zoom_ratio);
+        // only the output pixels of the zoomed images are computed
+        LOG("frequency_zoom", trace, "decompose and zoom images samples");
+        std::vector<BasicImage<T>> results;
+        results.reserve(input_images.size());
+        for (std::size_t i = 0; i < input_images.size(); ++i) {
+            auto grid = ComputeOutputGrid(
+                  zoom_ratio, input_images[i].size, image_padding, filter,
+                  zoom_ratio.output_resolution());
+            // method inherited from ImageDecompositionPolicy
+            results.push_back(this->DecomposeAndZoomSampled(
+                  zoom_ratio.input_resolution(), padded_images[i], filter,
+                  grid));
+        }
+        return results;
+    }
+
+    LOG("frequency_zoom", trace, "decompose and zoom images");
+    std::vector<BasicImage<T>> zoomed_images;
+    if (is_same_size) {
+        // methods inherited from ImageDecompositionPolicy
+        zoomed_images = this->DecomposeAndZoomBatch(
+              zoom_ratio.input_resolution(), padded_images, filter);
+    } else {
+        // FFTs of different sizes cannot be batched
+        for (const auto& padded_image : padded_images) {
+            zoomed_images.push_back(this->DecomposeAndZoom(
+                  zoom_ratio.input_resolution(), padded_image, filter));
+        }
     }
 
-    return result;
+    LOG("frequency_zoom", trace, "unpad zoomed images");
+    std::vector<BasicImage<T>> results;
+    results.reserve(input_images.size());
+    for (std::size_t i = 0; i < input_images.size(); ++i) {
+        results.push_back(UnpadImage(zoom_ratio, input_images[i],
+                                     zoomed_images[i], image_padding,
+                                     filter));
+    }
+
+    return results;
 }
 
 template <template <class> class ImageDecompositionPolicy, class ZoomStrategy>
-Image FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::UnpadImage(
-      const ZoomRatio& zoom_ratio, const Image& original_image,
-      const Image& zoomed_image, const Padding& padding,
+template <typename T>
+BasicImage<T> FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::UnpadImage(
+      const ZoomRatio& zoom_ratio, const BasicImage<T>& original_image,
+      const BasicImage<T>& zoomed_image, const Padding& padding,
       const Filter& filter) const {
-    auto input_size = original_image.size;
+    // remove padding from processed image
+    return zoomed_image.Sample(
+          ComputeOutputGrid(zoom_ratio, original_image.size, padding, filter,
+                            1));
+}
+
+template <template <class> class ImageDecompositionPolicy, class ZoomStrategy>
+SamplingGrid
+FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::ComputeOutputGrid(
+      const ZoomRatio& zoom_ratio, const Size& original_size,
+      const Padding& padding, const Filter& filter, int step) const {
+    auto input_size = original_size;
 
     auto filter_padding_size = filter.padding_size();
 
@@ -104,11 +247,6 @@ Image FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::UnpadImage(
         input_size.col -= filter_padding_size.col;
     }
 
-    // expected result size
-    auto result_size = input_size * zoom_ratio.input_resolution();
-
-    Image result(result_size);
-
     int top_filter_margin = filter_padding_size.row;
     int left_filter_margin = filter_padding_size.col;
     if (padding.type == PaddingType::kNone && padding.top != 0) {
@@ -120,57 +258,16 @@ Image FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::UnpadImage(
         left_filter_margin = 0;
     }
 
-    int zoomed_col_length = input_size.col * zoom_ratio.input_resolution();
-    int zoomed_left_padding_size =
-          left_filter_margin * zoom_ratio.input_resolution();
-
-    // remove padding from processed image
-    int begin_row_data = top_filter_margin * zoom_ratio.input_resolution();
-    int end_row_data =
-          (input_size.row + top_filter_margin) * zoom_ratio.input_resolution();
-    for (int row = begin_row_data; row < end_row_data; ++row) {
-        // data starts after left padding and col length is zoomed_col_length
-        auto data_row_begin_it = zoomed_image.data.cbegin() +
-                                 (row * zoomed_image.size.col) +
-                                 zoomed_left_padding_size;
-        auto data_row_end_it = data_row_begin_it + zoomed_col_length;
-
-        auto result_row_begin_it =
-              result.data.begin() + (row - begin_row_data) * result.size.col;
-
-        std::copy(data_row_begin_it, data_row_end_it, result_row_begin_it);
-    }
-
-    return result;
-}
-
-template <template <class> class ImageDecompositionPolicy, class ZoomStrategy>
-Image FrequencyZoom<ImageDecompositionPolicy, ZoomStrategy>::DecimateImage(
-      const Image& zoomed_image, const ZoomRatio& zoom_ratio) const {
-    LOG("frequency_zoom", trace, "decimate zoomed image by {}",
-        zoom_ratio.output_resolution());
-
-    Image decimated_image(
-          {static_cast<int>(std::ceil(
-                 zoomed_image.size.row /
-                 static_cast<double>(zoom_ratio.output_resolution()))),
-           static_cast<int>(std::ceil(
-                 zoomed_image.size.col /
-                 static_cast<double>(zoom_ratio.output_resolution())))});
-
-    int result_row = 0;
-    for (int i = 0; i < zoomed_image.size.row;
-         i += zoom_ratio.output_resolution()) {
-        int result_col = 0;
-        for (int j = 0; j < zoomed_image.size.col;
-             j += zoom_ratio.output_resolution()) {
-            decimated_image.Set(result_row, result_col, zoomed_image.Get(i, j));
-            ++result_col;
-        }
-        ++result_row;
-    }
+    // expected result size, decimated by step
+    auto zoomed_size = input_size * zoom_ratio.input_resolution();
 
-    return decimated_image;
+    SamplingGrid grid;
+    grid.row_begin = top_filter_margin * zoom_ratio.input_resolution();
+    grid.col_begin = left_filter_margin * zoom_ratio.input_resolution();
+    grid.step = step;
+    grid.size = {(zoomed_size.row + step - 1) / step,
+                 (zoomed_size.col + step - 1) / step};
+    return grid;
 }
 
 }  // namespace zoom
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2018 CS - Systeme d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sirius/zoom/image_decomposition/periodic_smooth_coefficients.h"
+
+#include <cmath>
+
+#include "sirius/utils/log.h"
+#include "sirius/utils/lru_cache.h"
+
+namespace sirius {
+namespace zoom {
+
+namespace {
+
+constexpr std::size_t kCacheSize = 10;
+
+PeriodicSmoothCoefficientsSPtr CreatePeriodicSmoothCoefficients(
+      const Size& image_size) {
+    LOG("periodic_smooth_decomposition", trace,
+        "compute periodic plus smooth coefficients {}x{}", image_size.row,
+        image_size.col);
+    Size fft_size(image_size.row, image_size.col / 2 + 1);
+    auto coefficients = std::make_shared<PeriodicSmoothCoefficients>();
+
+    std::vector<double> row_cos(fft_size.row);
+    coefficients->row_factors.resize(fft_size.row);
+    for (int row = 0; row < fft_size.row; ++row) {
+        double angle = 2 * M_PI * row / static_cast<double>(image_size.row);
+        row_cos[row] = 2.0 * std::cos(angle);
+        coefficients->row_factors[row] = 1.0 - std::polar(1.0, angle);
+    }
+
+    std::vector<double> col_cos(fft_size.col);
+    coefficients->col_factors.resize(fft_size.col);
+    for (int col = 0; col < fft_size.col; ++col) {
+        double angle = 2 * M_PI * col / static_cast<double>(image_size.col);
+        col_cos[col] = 2.0 * std::cos(angle);
+        coefficients->col_factors[col] = 1.0 - std::polar(1.0, angle);
+    }
+
+    coefficients->denominators.resize(fft_size.CellCount());
+    for (int row = 0; row < fft_size.row; ++row) {
+        for (int col = 0; col < fft_size.col; ++col) {
+            coefficients->denominators[row * fft_size.col + col] =
+                  col_cos[col] + row_cos[row] - 4.0;
+        }
+    }
+    return coefficients;
+}
+
+}  // namespace
+
+PeriodicSmoothCoefficientsSPtr GetPeriodicSmoothCoefficients(
+      const Size& image_size) {
+#ifdef SIRIUS_ENABLE_CACHE_OPTIMIZATION
+    static utils::LRUCache<Size, PeriodicSmoothCoefficientsSPtr, kCacheSize>
+          coefficients_cache;
+    return coefficients_cache.GetOrInsert(image_size, [&image_size]() {
+        return CreatePeriodicSmoothCoefficients(image_size);
+    });
+#else
+    return CreatePeriodicSmoothCoefficients(image_size);
+#endif  // SIRIUS_ENABLE_CACHE_OPTIMIZATION
+}
+
+}  // namespace zoom
+}  // namespace sirius
@@ -0,0 +1,73 @@
+/**
+ * Copyright (C) 2018 CS - Systeme d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIRIUS_ZOOM_IMAGE_DECOMPOSITION_PERIODIC_SMOOTH_COEFFICIENTS_H_
+#define SIRIUS_ZOOM_IMAGE_DECOMPOSITION_PERIODIC_SMOOTH_COEFFICIENTS_H_
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include "sirius/types.h"
+
+namespace sirius {
+namespace zoom {
+
+/**
+ * \brief Coefficients of the periodic plus smooth decomposition which only
+ *        depend on the image size
+ *
+ * The FFT of the border intensity changes is
+ * row_factors[row] * first_row_fft[col] + first_col_fft[row] * col_factors[col]
+ * where first_row_fft (resp. first_col_fft) is the 1D FFT of the first row
+ * (resp. col) of the intensity changes. The smooth part FFT is this FFT
+ * divided by the Poisson denominators.
+ */
+struct PeriodicSmoothCoefficients {
+    // 2cos(2.pi.col/col_count) + 2cos(2.pi.row/row_count) - 4 on the image
+    // FFT grid (row_count x (col_count / 2 + 1))
+    std::vector<double> denominators;
+    // 1 - exp(2i.pi.row/row_count)
+    std::vector<std::complex<double>> row_factors;
+    // 1 - exp(2i.pi.col/col_count), col in [0, col_count / 2]
+    std::vector<std::complex<double>> col_factors;
+};
+
+using PeriodicSmoothCoefficientsSPtr =
+      std::shared_ptr<const PeriodicSmoothCoefficients>;
+
+/**
+ * \brief Get the periodic plus smooth coefficients of an image size
+ *
+ * Coefficients are cached by image size.
+ *
+ * \remark This function is thread safe
+ *
+ * \param image_size size of the image (even)
+ * \return coefficients
+ */
+PeriodicSmoothCoefficientsSPtr GetPeriodicSmoothCoefficients(
+      const Size& image_size);
+
+}  // namespace zoom
+}  // namespace sirius
+
+#endif  // SIRIUS_ZOOM_IMAGE_DECOMPOSITION_PERIODIC_SMOOTH_COEFFICIENTS_H_
@@ -22,9 +22,13 @@
 #ifndef SIRIUS_ZOOM_IMAGE_DECOMPOSITION_PERIODIC_SMOOTH_POLICY_H_
 #define SIRIUS_ZOOM_IMAGE_DECOMPOSITION_PERIODIC_SMOOTH_POLICY_H_
 
+#include <vector>
+
 #include "sirius/filter.h"
 #include "sirius/image.h"
 
+#include "sirius/fftw/types.h"
+
 namespace sirius {
 namespace zoom {
 
@@ -36,11 +40,99 @@ namespace zoom {
 template <class ZoomStrategy>
 class ImageDecompositionPeriodicSmoothPolicy : private ZoomStrategy {
   public:
-    Image DecomposeAndZoom(int zoom, const Image& even_image,
-                           const Filter& filter) const;
+    // engine selection of the zoom strategy, cf. FilterSpectrumSizes
+    using ZoomStrategy::UseDirectFilter;
+
+    template <typename T>
+    BasicImage<T> DecomposeAndZoom(int zoom, const BasicImage<T>& even_image,
+                                   const Filter& filter) const;
+
+    /**
+     * \brief Decompose and zoom a batch of images of the same size
+     *
+     * Periodic and smooth components are computed image by image.
+     */
+    template <typename T>
+    std::vector<BasicImage<T>> DecomposeAndZoomBatch(
+          int zoom, const std::vector<BasicImage<T>>& even_images,
+          const Filter& filter) const;
+
+    /**
+     * \brief Decompose and zoom an image and only compute a grid of samples
+     *        of the zoomed image
+     *
+     * The periodic component is zoomed with ZoomStrategy::ZoomSampled and the
+     * smooth component is only interpolated on the grid.
+     */
+    template <typename T>
+    BasicImage<T> DecomposeAndZoomSampled(int zoom,
+                                          const BasicImage<T>& even_image,
+                                          const Filter& filter,
+                                          const SamplingGrid& grid) const;
+
+    /**
+     * \brief Zoom the smooth component with a bilinear interpolation
+     * \param zoom zoom factor
+     * \param even_image smooth component of the image (even size)
+     * \return interpolated image
+     */
+    template <typename T>
+    BasicImage<T> Interpolate2D(int zoom,
+                                const BasicImage<T>& even_image) const;
+
+    /**
+     * \brief Add the bilinear interpolation of the smooth component to a
+     *        zoomed image
+     *
+     * The interpolation is separable: each zoomed row is interpolated between
+     * two image rows, then between two cols, one phase at a time.
+     *
+     * \param zoom zoom factor
+     * \param even_image smooth component of the image (even size)
+     * \param zoomed_image image of size even_image.size * zoom, updated in
+     *        place
+     */
+    template <typename T>
+    void AddInterpolation2D(int zoom, const BasicImage<T>& even_image,
+                            BasicImage<T>& zoomed_image) const;
+
+    /**
+     * \brief Add a grid of samples of the bilinear interpolation of the
+     *        smooth component to samples of a zoomed image
+     * \param zoom zoom factor
+     * \param even_image smooth component of the image (even size)
+     * \param grid samples of the interpolated image to add
+     * \param samples samples of grid size, updated in place
+     */
+    template <typename T>
+    void AddInterpolation2D(int zoom, const BasicImage<T>& even_image,
+                            const SamplingGrid& grid,
+                            BasicImage<T>& samples) const;
 
   private:
-    Image Interpolate2D(int zoom, const Image& even_image) const;
+    /**
+     * \brief Periodic and smooth components of an image
+     */
+    template <typename T>
+    struct Components {
+        // FFT of the periodic component
+        fftw::BasicComplexUPtr<T> periodic_part_fft;
+        // smooth component
+        BasicImage<T> smooth_part;
+    };
+
+    /**
+     * \brief Decompose an image in periodic and smooth components
+     *
+     * The periodic component stays in the spectral domain for the zoom
+     * strategy. Only the borders of the intensity changes image are non-zero:
+     * its FFT is computed from 1D FFTs of its first row and col.
+     *
+     * \param even_image image (even size)
+     * \return components of the image
+     */
+    template <typename T>
+    Components<T> Decompose(const BasicImage<T>& even_image) const;
 };
 
 }  // namespace zoom
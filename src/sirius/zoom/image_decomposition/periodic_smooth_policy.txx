@@ -24,227 +24,264 @@
 
 #include "sirius/zoom/image_decomposition/periodic_smooth_policy.h"
 
+#include <algorithm>
+#include <complex>
+
 #include "sirius/fftw/fftw.h"
 #include "sirius/fftw/types.h"
 #include "sirius/fftw/wrapper.h"
 
+#include "sirius/zoom/image_decomposition/periodic_smooth_coefficients.h"
+
 #include "sirius/utils/gsl.h"
 
 namespace sirius {
 namespace zoom {
 
 template <class ZoomStrategy>
-Image ImageDecompositionPeriodicSmoothPolicy<ZoomStrategy>::DecomposeAndZoom(
-      int zoom, const Image& image, const Filter& filter) const {
-    // 1) compute intensity changes between two opposite borders
+template <typename T>
+BasicImage<T>
+ImageDecompositionPeriodicSmoothPolicy<ZoomStrategy>::DecomposeAndZoom(
+      int zoom, const BasicImage<T>& image, const Filter& filter) const {
+    auto components = Decompose(image);
+
+    // 7) apply zoom on periodic part
+    LOG("periodic_smooth_decomposition", trace, "zoom periodic part");
+    // method inherited from ZoomStrategy
+    auto zoomed_image = this->ZoomSpectrum(
+          zoom, image.size, std::move(components.periodic_part_fft), filter);
+
+    // 8) interpolate 2d smooth part image and sum it with the zoomed periodic
+    //    part
+    LOG("periodic_smooth_decomposition", trace,
+        "interpolate and add smooth image part");
+    AddInterpolation2D(zoom, components.smooth_part, zoomed_image);
+
+    return zoomed_image;
+}
+
+template <class ZoomStrategy>
+template <typename T>
+BasicImage<T>
+ImageDecompositionPeriodicSmoothPolicy<ZoomStrategy>::DecomposeAndZoomSampled(
+      int zoom, const BasicImage<T>& image, const Filter& filter,
+      const SamplingGrid& grid) const {
+    auto components = Decompose(image);
+
+    LOG("periodic_smooth_decomposition", trace,
+        "zoom periodic part samples");
+    // method inherited from ZoomStrategy
+    auto samples = this->ZoomSpectrumSampled(
+          zoom, image.size, std::move(components.periodic_part_fft), filter,
+          grid);
+
+    LOG("periodic_smooth_decomposition", trace,
+        "interpolate and add smooth image part samples");
+    AddInterpolation2D(zoom, components.smooth_part, grid, samples);
+
+    return samples;
+}
+
+template <class ZoomStrategy>
+template <typename T>
+typename ImageDecompositionPeriodicSmoothPolicy<
+      ZoomStrategy>::template Components<T>
+ImageDecompositionPeriodicSmoothPolicy<ZoomStrategy>::Decompose(
+      const BasicImage<T>& image) const {
+    using Complex = std::complex<double>;
+    int row_count = image.size.row;
+    int col_count = image.size.col;
+    Size fft_size(row_count, col_count / 2 + 1);
+
+    // 1) compute intensity changes between two opposite borders. Only the
+    //    first and last rows and cols of the intensity changes image are
+    //    non-zero, and the last ones are the opposite of the first ones
     LOG("periodic_smooth_decomposition", trace, "compute intensity changes");
-    Image border_intensity_changes(image.size);
-    auto border_intensity_changes_span =
-          gsl::as_multi_span(border_intensity_changes.data);
-    // last line - first line, first line - last line
-    for (int j = 0; j < image.size.col; j++) {
-        // (last line - first line) placed in the first line of
-        // border_intensity_changes
-        border_intensity_changes_span[j] +=
-              image.data[(image.size.row - 1) * image.size.col + j] -
-              image.data[j];
-        // (first line - last line) placed the last line of
-        // border_intensity_changes
-        border_intensity_changes_span[(image.size.row - 1) * image.size.col +
-                                      j] +=
-              image.data[j] -
-              image.data[(image.size.row - 1) * image.size.col + j];
+    // last line - first line
+    BasicImage<T> row_changes({1, col_count});
+    for (int j = 0; j < col_count; j++) {
+        row_changes.data[j] =
+              image.data[(row_count - 1) * col_count + j] - image.data[j];
     }
-
-    for (int i = 0; i < image.size.row; i++) {
-        // (last col - first col) placed in the first col of
-        // border_intensity_changes
-        border_intensity_changes_span[i * image.size.col] +=
-              image.data[(i + 1) * image.size.col - 1] -
-              image.data[i * image.size.col];
-        // (first col - last col) placed in the last col of
-        // border_intensity_changes
-        border_intensity_changes_span[(i + 1) * image.size.col - 1] +=
-              image.data[i * image.size.col] -
-              image.data[(i + 1) * image.size.col - 1];
+    // last col - first col
+    BasicImage<T> col_changes({1, row_count});
+    for (int i = 0; i < row_count; i++) {
+        col_changes.data[i] = image.data[(i + 1) * col_count - 1] -
+                              image.data[i * col_count];
     }
 
-    Size fft_size(image.size.row, image.size.col / 2 + 1);
-
-    // 2) fft of intensity changes
+    // 2) fft of intensity changes, from the 1D ffts of the first row and col
     LOG("periodic_smooth_decomposition", trace,
         "compute intensity changes FFT");
-    auto intensity_fft = fftw::FFT(border_intensity_changes);
-    auto intensity_fft_span =
-          utils::MakeSmartPtrArraySpan(intensity_fft, fft_size);
-
-    // 3) compute smooth part of the image
-    LOG("periodic_smooth_decomposition", trace, "compute smooth part");
-    std::vector<double> cosx(fft_size.CellCount(), 0);
-    std::vector<double> cosy(fft_size.CellCount(), 0);
-    for (int i = 0; i < fft_size.row; i++) {
-        for (int j = 0; j < fft_size.col; j++) {
-            cosx[i * fft_size.col + j] =
-                  2.0 * cos(2 * M_PI * j / static_cast<double>(image.size.col));
-            cosy[i * fft_size.col + j] =
-                  2.0 * cos(2 * M_PI * i / static_cast<double>(image.size.row));
-        }
-    }
+    auto row_changes_fft = fftw::FFT(row_changes);
+    auto col_changes_fft = fftw::FFT(col_changes);
+    auto coefficients = GetPeriodicSmoothCoefficients(image.size);
+
+    // 3) fft input image
+    LOG("periodic_smooth_decomposition", trace, "compute image FFT");
+    Components<T> components;
+    components.periodic_part_fft = fftw::FFT(image);
+    auto periodic_part_fft_span = utils::MakeSmartPtrArraySpan(
+          components.periodic_part_fft, fft_size);
 
-    auto smooth_part_fft = fftw::CreateComplex(fft_size);
+    // 4) compute smooth part of the image, then periodic part as the image
+    //    minus its smooth part
+    LOG("periodic_smooth_decomposition", trace,
+        "compute smooth and periodic parts");
+    auto smooth_part_fft = fftw::CreateComplex<T>(fft_size);
     auto smooth_part_fft_span =
           utils::MakeSmartPtrArraySpan(smooth_part_fft, fft_size);
-    smooth_part_fft_span[0][0] = 0;
-    smooth_part_fft_span[0][1] = 0;
-    for (int i = 1; i < fft_size.row; i++) {
+    for (int i = 0; i < fft_size.row; i++) {
+        // col fft of a real signal: hermitian symmetry for the upper half
+        int col_fft_row = (i <= row_count / 2) ? i : row_count - i;
+        Complex col_change(col_changes_fft.get()[col_fft_row][0],
+                           col_changes_fft.get()[col_fft_row][1]);
+        if (col_fft_row != i) {
+            col_change = std::conj(col_change);
+        }
         for (int j = 0; j < fft_size.col; j++) {
             int fft_index = i * fft_size.col + j;
+            if (fft_index == 0) {
+                // mean of the smooth part is 0
+                continue;
+            }
+            Complex row_change(row_changes_fft.get()[j][0],
+                               row_changes_fft.get()[j][1]);
+            Complex smooth_part =
+                  (coefficients->row_factors[i] * row_change +
+                   col_change * coefficients->col_factors[j]) /
+                  coefficients->denominators[fft_index];
             smooth_part_fft_span[fft_index][0] =
-                  intensity_fft_span[fft_index][0] /
-                  (cosx[fft_index] + cosy[fft_index] - 4.0);
+                  static_cast<T>(smooth_part.real());
             smooth_part_fft_span[fft_index][1] =
-                  intensity_fft_span[fft_index][1] /
-                  (cosx[fft_index] + cosy[fft_index] - 4.0);
+                  static_cast<T>(smooth_part.imag());
+            periodic_part_fft_span[fft_index][0] -=
+                  smooth_part_fft_span[fft_index][0];
+            periodic_part_fft_span[fft_index][1] -=
+                  smooth_part_fft_span[fft_index][1];
         }
     }
 
-    for (int j = 1; j < fft_size.col; j++) {
-        smooth_part_fft_span[j][0] =
-              intensity_fft_span[j][0] / (cosx[j] + cosy[j] - 4.0);
-        smooth_part_fft_span[j][1] =
-              intensity_fft_span[j][1] / (cosx[j] + cosy[j] - 4.0);
-    }
-
-    // 4) fft input image
-    LOG("periodic_smooth_decomposition", trace, "compute image FFT");
-    auto image_fft = fftw::FFT(image);
-    auto image_fft_span = utils::MakeSmartPtrArraySpan(image_fft, fft_size);
-
-    // 5) compute periodic part of the image
-    LOG("periodic_smooth_decomposition", trace, "compute periodic part");
-    auto periodic_part_fft = fftw::CreateComplex(fft_size);
-    auto periodic_part_fft_span =
-          utils::MakeSmartPtrArraySpan(periodic_part_fft, fft_size);
-    auto fft_count = fft_size.CellCount();
-    for (int i = 0; i < fft_count; ++i) {
-        periodic_part_fft_span[i][0] =
-              image_fft_span[i][0] - smooth_part_fft_span[i][0];
-        periodic_part_fft_span[i][1] =
-              image_fft_span[i][1] - smooth_part_fft_span[i][1];
-    }
-
-    // 6) ifft periodic part
-    LOG("periodic_smooth_decomposition", trace, "compute periodic part IFFT");
-    auto periodic_part_image =
-          fftw::IFFT(image.size, std::move(periodic_part_fft));
-
-    // 7) apply zoom on periodic part
-    LOG("periodic_smooth_decomposition", trace, "zoom periodic part");
-    // method inherited from ZoomStrategy
-    auto zoomed_image = this->Zoom(zoom, periodic_part_image, filter);
-
-    // 7) ifft smooth part
+    // 5) ifft smooth part
     LOG("periodic_smooth_decomposition", trace, "smooth part IFFT");
-    auto smooth_part_image = fftw::IFFT(image.size, std::move(smooth_part_fft));
+    components.smooth_part = fftw::IFFT(image.size, std::move(smooth_part_fft));
 
-    // 8) normalize smooth_part_image
+    // 6) normalize smooth_part_image
     LOG("periodic_smooth_decomposition", trace, "normalize smooth image part");
     int image_cell_count = image.CellCount();
     std::for_each(
-          smooth_part_image.data.begin(), smooth_part_image.data.end(),
-          [image_cell_count](double& cell) { cell /= image_cell_count; });
-
-    // 9) interpolate 2d smooth part image
-    LOG("periodic_smooth_decomposition", trace,
-        "interpolate smooth image part");
-    auto interpolated_smooth_image = Interpolate2D(zoom, smooth_part_image);
+          components.smooth_part.data.begin(),
+          components.smooth_part.data.end(),
+          [image_cell_count](T& cell) { cell /= image_cell_count; });
 
-    // 10) normalize periodic_part_image
-    LOG("periodic_smooth_decomposition", trace,
-        "normalize periodic image part");
-    std::for_each(
-          zoomed_image.data.begin(), zoomed_image.data.end(),
-          [image_cell_count](double& cell) { cell /= image_cell_count; });
+    return components;
+}
 
-    // 11) sum periodic and smooth parts
-    LOG("periodic_smooth_decomposition", trace,
-        "sum periodic and smooth image parts");
-    Image output_image(zoomed_image.size);
-    for (int i = 0; i < zoomed_image.size.row; i++) {
-        for (int j = 0; j < zoomed_image.size.col; j++) {
-            output_image.Set(i, j, zoomed_image.Get(i, j) +
-                                         interpolated_smooth_image.Get(i, j));
-        }
+template <class ZoomStrategy>
+template <typename T>
+std::vector<BasicImage<T>>
+ImageDecompositionPeriodicSmoothPolicy<ZoomStrategy>::DecomposeAndZoomBatch(
+      int zoom, const std::vector<BasicImage<T>>& even_images,
+      const Filter& filter) const {
+    std::vector<BasicImage<T>> zoomed_images;
+    zoomed_images.reserve(even_images.size());
+    for (const auto& even_image : even_images) {
+        zoomed_images.push_back(DecomposeAndZoom(zoom, even_image, filter));
     }
+    return zoomed_images;
+}
 
-    return output_image;
+template <class ZoomStrategy>
+template <typename T>
+BasicImage<T>
+ImageDecompositionPeriodicSmoothPolicy<ZoomStrategy>::Interpolate2D(
+      int zoom, const BasicImage<T>& image) const {
+    BasicImage<T> interpolated_im(image.size * zoom);
+    AddInterpolation2D(zoom, image, interpolated_im);
+    return interpolated_im;
 }
 
 template <class ZoomStrategy>
-Image ImageDecompositionPeriodicSmoothPolicy<ZoomStrategy>::Interpolate2D(
-      int zoom, const Image& image) const {
-    Image interpolated_im(image.size * zoom);
-
-    std::vector<double> BLN_kernel(4, 0);
-    Size img_mirror_size(image.size.row + 1, image.size.col + 1);
-
-    std::vector<double> img_mirror(img_mirror_size.CellCount(), 0);
-    auto img_mirror_span = gsl::as_multi_span(img_mirror);
-    for (int i = 0; i < image.size.row; i++) {
-        for (int j = 0; j < image.size.col; j++) {
-            img_mirror_span[i * (image.size.col + 1) + j] = image.Get(i, j);
-        }
+template <typename T>
+void ImageDecompositionPeriodicSmoothPolicy<ZoomStrategy>::AddInterpolation2D(
+      int zoom, const BasicImage<T>& image,
+      BasicImage<T>& zoomed_image) const {
+    int col_count = image.size.col;
+    int zoomed_col_count = col_count * zoom;
+
+    // bilinear weights of the current and next samples for each phase,
+    // computed in the image precision
+    std::vector<T> weights(zoom);
+    std::vector<T> next_weights(zoom);
+    for (int phase = 0; phase < zoom; ++phase) {
+        double next_weight = phase / static_cast<double>(zoom);
+        weights[phase] = static_cast<T>(1 - next_weight);
+        next_weights[phase] = static_cast<T>(next_weight);
     }
 
-    // duplicate last row
-    for (int j = 0; j < image.size.col + 1; j++) {
-        img_mirror_span[image.size.row * (image.size.col + 1) + j] =
-              img_mirror_span[(image.size.row - 1) * (image.size.col + 1) + j];
-    }
+    // row interpolated between two image rows, last col duplicated as the
+    // mirror of the bottom right border
+    std::vector<T> interpolated_row(col_count + 1);
+    // interpolated row zoomed on columns, built contiguously
+    std::vector<T> smooth_row(zoomed_col_count);
+    for (int i = 0; i < zoomed_image.size.row; ++i) {
+        // last row is duplicated as well
+        int top_row = i / zoom;
+        int bottom_row = std::min(top_row + 1, image.size.row - 1);
+        T row_weight = weights[i % zoom];
+        T next_row_weight = next_weights[i % zoom];
+        const T* top = image.data.data() + top_row * col_count;
+        const T* bottom = image.data.data() + bottom_row * col_count;
+        // 1) vertical pass on image cols
+        for (int j = 0; j < col_count; ++j) {
+            interpolated_row[j] =
+                  row_weight * top[j] + next_row_weight * bottom[j];
+        }
+        interpolated_row[col_count] = interpolated_row[col_count - 1];
+
+        // 2) horizontal pass, all the phases of a col before the next col
+        T* smooth = smooth_row.data();
+        for (int j = 0; j < col_count; ++j) {
+            T left = interpolated_row[j];
+            T right = interpolated_row[j + 1];
+            for (int phase = 0; phase < zoom; ++phase) {
+                smooth[j * zoom + phase] =
+                      weights[phase] * left + next_weights[phase] * right;
+            }
+        }
 
-    // duplicate last col
-    for (int i = 0; i < image.size.row + 1; i++) {
-        img_mirror_span[(i + 1) * (image.size.col + 1) - 1] =
-              img_mirror_span[(i + 1) * (image.size.col + 1) - 2];
+        // 3) unit stride addition to the zoomed row
+        T* zoomed_row = zoomed_image.data.data() + i * zoomed_col_count;
+        for (int col = 0; col < zoomed_col_count; ++col) {
+            zoomed_row[col] += smooth[col];
+        }
     }
+}
 
-    for (int fx = 0; fx < zoom; fx++) {
-        for (int fy = 0; fy < zoom; fy++) {
-            BLN_kernel[0] = (1 - fx / static_cast<double>(zoom)) *
-                            (1 - fy / static_cast<double>(zoom));
-            BLN_kernel[1] = (1 - fx / static_cast<double>(zoom)) *
-                            (fy / static_cast<double>(zoom));
-            BLN_kernel[2] = (fx / static_cast<double>(zoom)) *
-                            (1 - fy / static_cast<double>(zoom));
-            BLN_kernel[3] = (fx / static_cast<double>(zoom)) *
-                            (fy / static_cast<double>(zoom));
-
-            // convolve. BLN_kernel is already flipped
-            for (int i = fx; i < image.size.row * zoom; i += zoom) {
-                for (int j = fy; j < image.size.col * zoom; j += zoom) {
-                    interpolated_im.Set(
-                          i, j,
-                          img_mirror_span[(i / zoom) * (image.size.col + 1) +
-                                          (j / zoom)] *
-                                      BLN_kernel[0] +
-                                img_mirror_span[(i / zoom + 1) *
-                                                      (image.size.col + 1) +
-                                                (j / zoom)] *
-                                      BLN_kernel[2] +
-                                img_mirror_span[(i / zoom) *
-                                                      (image.size.col + 1) +
-                                                (j / zoom + 1)] *
-                                      BLN_kernel[1] +
-                                img_mirror_span[(i / zoom + 1) *
-                                                      (image.size.col + 1) +
-                                                (j / zoom + 1)] *
-                                      BLN_kernel[3]);
-                }
-            }
+template <class ZoomStrategy>
+template <typename T>
+void ImageDecompositionPeriodicSmoothPolicy<ZoomStrategy>::AddInterpolation2D(
+      int zoom, const BasicImage<T>& image, const SamplingGrid& grid,
+      BasicImage<T>& samples) const {
+    for (int row = 0; row < grid.size.row; ++row) {
+        int i = grid.row_begin + row * grid.step;
+        double fx = (i % zoom) / static_cast<double>(zoom);
+        // last row is duplicated as in AddInterpolation2D
+        int top_row = i / zoom;
+        int bottom_row = std::min(top_row + 1, image.size.row - 1);
+        for (int col = 0; col < grid.size.col; ++col) {
+            int j = grid.col_begin + col * grid.step;
+            double fy = (j % zoom) / static_cast<double>(zoom);
+            int left_col = j / zoom;
+            int right_col = std::min(left_col + 1, image.size.col - 1);
+            double top = (1 - fy) * image.Get(top_row, left_col) +
+                         fy * image.Get(top_row, right_col);
+            double bottom = (1 - fy) * image.Get(bottom_row, left_col) +
+                            fy * image.Get(bottom_row, right_col);
+            samples.data[row * grid.size.col + col] +=
+                  static_cast<T>((1 - fx) * top + fx * bottom);
         }
     }
-
-    return interpolated_im;
 }
 
 }  // namespace zoom
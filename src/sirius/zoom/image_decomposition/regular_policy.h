@@ -22,6 +22,8 @@
 #ifndef SIRIUS_ZOOM_IMAGE_DECOMPOSITION_REGULAR_POLICY_H_
 #define SIRIUS_ZOOM_IMAGE_DECOMPOSITION_REGULAR_POLICY_H_
 
+#include <vector>
+
 #include "sirius/filter.h"
 #include "sirius/image.h"
 
@@ -34,8 +36,27 @@ namespace zoom {
 template <class ZoomStrategy>
 class ImageDecompositionRegularPolicy : private ZoomStrategy {
   public:
-    Image DecomposeAndZoom(int zoom, const Image& padded_image,
-                           const Filter& filter) const;
+    // engine selection of the zoom strategy, cf. FilterSpectrumSizes
+    using ZoomStrategy::UseDirectFilter;
+
+    template <typename T>
+    BasicImage<T> DecomposeAndZoom(int zoom, const BasicImage<T>& padded_image,
+                                   const Filter& filter) const;
+
+    template <typename T>
+    std::vector<BasicImage<T>> DecomposeAndZoomBatch(
+          int zoom, const std::vector<BasicImage<T>>& padded_images,
+          const Filter& filter) const;
+
+    /**
+     * \brief Zoom an image and only compute a grid of samples of the zoomed
+     *        image
+     */
+    template <typename T>
+    BasicImage<T> DecomposeAndZoomSampled(int zoom,
+                                          const BasicImage<T>& padded_image,
+                                          const Filter& filter,
+                                          const SamplingGrid& grid) const;
 };
 
 }  // namespace zoom
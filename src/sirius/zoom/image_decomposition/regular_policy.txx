@@ -28,13 +28,36 @@ namespace sirius {
 namespace zoom {
 
 template <class ZoomStrategy>
-Image ImageDecompositionRegularPolicy<ZoomStrategy>::DecomposeAndZoom(
-      int zoom, const Image& padded_image, const Filter& filter) const {
+template <typename T>
+BasicImage<T> ImageDecompositionRegularPolicy<ZoomStrategy>::DecomposeAndZoom(
+      int zoom, const BasicImage<T>& padded_image, const Filter& filter) const {
     // method inherited from ZoomStrategy
     LOG("regular_decomposition", trace, "zoom image");
     return this->Zoom(zoom, padded_image, filter);
 }
 
+template <class ZoomStrategy>
+template <typename T>
+std::vector<BasicImage<T>>
+ImageDecompositionRegularPolicy<ZoomStrategy>::DecomposeAndZoomBatch(
+      int zoom, const std::vector<BasicImage<T>>& padded_images,
+      const Filter& filter) const {
+    // method inherited from ZoomStrategy
+    LOG("regular_decomposition", trace, "zoom {} images", padded_images.size());
+    return this->ZoomBatch(zoom, padded_images, filter);
+}
+
+template <class ZoomStrategy>
+template <typename T>
+BasicImage<T>
+ImageDecompositionRegularPolicy<ZoomStrategy>::DecomposeAndZoomSampled(
+      int zoom, const BasicImage<T>& padded_image, const Filter& filter,
+      const SamplingGrid& grid) const {
+    // method inherited from ZoomStrategy
+    LOG("regular_decomposition", trace, "zoom image samples");
+    return this->ZoomSampled(zoom, padded_image, filter, grid);
+}
+
 }  // namespace zoom
 }  // namespace sirius
 
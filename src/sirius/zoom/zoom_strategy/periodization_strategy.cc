@@ -22,6 +22,8 @@
 #include "sirius/zoom/zoom_strategy/periodization_strategy.h"
 
 #include <algorithm>
+#include <cstring>
+#include <vector>
 
 #include "sirius/exception.h"
 
@@ -29,27 +31,51 @@
 #include "sirius/fftw/types.h"
 #include "sirius/fftw/wrapper.h"
 
-#include "sirius/utils/gsl.h"
 #include "sirius/utils/log.h"
 
+#include "sirius/zoom/zoom_strategy/spectrum_sampling.h"
+
 namespace sirius {
 namespace zoom {
 
-Image PeriodizationZoomStrategy::Zoom(int zoom, const Image& padded_image,
-                                      const Filter& filter) const {
+bool PeriodizationZoomStrategy::UseDirectFilter(int,
+                                                const Size& zoomed_size,
+                                                const Filter& filter) const {
+    // the periodized FFT is fully IFFTed on both paths
+    return filter.UseDirectConvolution(zoomed_size);
+}
+
+template <typename T>
+BasicImage<T> PeriodizationZoomStrategy::Zoom(
+      int zoom, const BasicImage<T>& padded_image, const Filter& filter) const {
     // 1) FFT image
     LOG("periodization_zoom", trace, "compute image FFT");
     auto fft_image = fftw::FFT(padded_image);
 
-    fftw::ComplexUPtr zoomed_fft;
+    return ZoomSpectrum(zoom, padded_image.size, std::move(fft_image), filter);
+}
+
+template <typename T>
+BasicImage<T> PeriodizationZoomStrategy::ZoomSpectrum(
+      int zoom, const Size& image_size, fftw::BasicComplexUPtr<T> image_fft,
+      const Filter& filter) const {
+    Size zoomed_size{image_size.row * zoom, image_size.col * zoom};
+
     // 2) zoom FFT
-    LOG("periodization_zoom", trace, "periodize FFT");
-    zoomed_fft = PeriodizeFFT(zoom, padded_image, std::move(fft_image));
+    fftw::BasicComplexUPtr<T> zoomed_fft;
+    if (zoom > 1) {
+        LOG("periodization_zoom", trace, "periodize FFT");
+        zoomed_fft = fftw::AllocateComplex<T>(
+              {zoomed_size.row, zoomed_size.col / 2 + 1});
+        PeriodizeSpectrum<T>(zoom, image_size, image_fft.get(),
+                             zoomed_fft.get());
+    } else {
+        zoomed_fft = std::move(image_fft);
+    }
 
-    Size zoomed_size{padded_image.size.row * zoom,
-                     padded_image.size.col * zoom};
+    bool is_direct_filter = UseDirectFilter(zoom, zoomed_size, filter);
 
-    if (filter.IsLoaded()) {
+    if (filter.IsLoaded() && !is_direct_filter) {
         // 3) Filter zoomed FFT
         LOG("periodization_zoom", trace, "apply filter");
         zoomed_fft = filter.Process(zoomed_size, std::move(zoomed_fft));
@@ -61,125 +87,293 @@ Image PeriodizationZoomStrategy::Zoom(int zoom, const Image& padded_image,
 
     // 5) Normalize zoomed image
     LOG("periodization_zoom", trace, "normalize image");
-    int pixel_count = padded_image.CellCount();
+    int pixel_count = image_size.CellCount();
     std::for_each(zoomed_image.data.begin(), zoomed_image.data.end(),
-                  [pixel_count](double& pixel) { pixel /= pixel_count; });
+                  [pixel_count](T& pixel) { pixel /= pixel_count; });
+
+    if (is_direct_filter) {
+        // 6) Filter zoomed image
+        LOG("periodization_zoom", trace, "convolve image with filter");
+        filter.Convolve(zoomed_image);
+    }
     return zoomed_image;
 }
 
-fftw::ComplexUPtr PeriodizationZoomStrategy::PeriodizeFFT(
-      int zoom, const Image& image, fftw::ComplexUPtr image_fft) const {
+template <typename T>
+std::vector<BasicImage<T>> PeriodizationZoomStrategy::ZoomBatch(
+      int zoom, const std::vector<BasicImage<T>>& padded_images,
+      const Filter& filter) const {
+    const Size& image_size = padded_images.front().size;
+    int batch_count = padded_images.size();
+
+    // 1) FFT images
+    LOG("periodization_zoom", trace, "compute {} image FFTs", batch_count);
+    auto batch_fft = fftw::BatchFFT(padded_images);
+
+    Size zoomed_size{image_size.row * zoom, image_size.col * zoom};
+    bool is_direct_filter = UseDirectFilter(zoom, zoomed_size, filter);
+
+    // 2) zoom FFTs
+    fftw::BasicComplexUPtr<T> zoomed_batch_fft;
+    if (zoom > 1) {
+        LOG("periodization_zoom", trace, "periodize FFTs");
+        int fft_count = image_size.row * (image_size.col / 2 + 1);
+        int zoomed_fft_count = zoomed_size.row * (zoomed_size.col / 2 + 1);
+        zoomed_batch_fft = fftw::AllocateComplex<T>(
+              {zoomed_size.row * batch_count, zoomed_size.col / 2 + 1});
+        for (int i = 0; i < batch_count; ++i) {
+            PeriodizeSpectrum<T>(zoom, image_size,
+                                 batch_fft.get() + i * fft_count,
+                                 zoomed_batch_fft.get() + i * zoomed_fft_count);
+        }
+    } else {
+        zoomed_batch_fft = std::move(batch_fft);
+    }
+
+    if (!is_direct_filter) {
+        // 3) Filter zoomed FFTs
+        LOG("periodization_zoom", trace, "apply filter");
+        filter.ProcessBatch<T>(zoomed_size, batch_count,
+                               zoomed_batch_fft.get());
+    }
+
+    // 4) IFFT zoomed FFTs
+    LOG("periodization_zoom", trace, "compute image IFFTs");
+    auto zoomed_images = fftw::BatchIFFT(zoomed_size, batch_count,
+                                         std::move(zoomed_batch_fft));
+
+    // 5) Normalize zoomed images
+    LOG("periodization_zoom", trace, "normalize images");
+    int pixel_count = image_size.CellCount();
+    for (auto& zoomed_image : zoomed_images) {
+        std::for_each(zoomed_image.data.begin(), zoomed_image.data.end(),
+                      [pixel_count](T& pixel) { pixel /= pixel_count; });
+    }
+
+    if (is_direct_filter) {
+        // 6) Filter zoomed images
+        LOG("periodization_zoom", trace, "convolve images with filter");
+        for (auto& zoomed_image : zoomed_images) {
+            filter.Convolve(zoomed_image);
+        }
+    }
+    return zoomed_images;
+}
+
+template <typename T>
+BasicImage<T> PeriodizationZoomStrategy::ZoomSampled(
+      int zoom, const BasicImage<T>& padded_image, const Filter& filter,
+      const SamplingGrid& grid) const {
+    // 1) FFT image
+    LOG("periodization_zoom", trace, "compute image FFT");
+    auto fft_image = fftw::FFT(padded_image);
+
+    return ZoomSpectrumSampled(zoom, padded_image.size, std::move(fft_image),
+                               filter, grid);
+}
+
+template <typename T>
+BasicImage<T> PeriodizationZoomStrategy::ZoomSpectrumSampled(
+      int zoom, const Size& image_size, fftw::BasicComplexUPtr<T> image_fft,
+      const Filter& filter, const SamplingGrid& grid) const {
+    Size zoomed_size{image_size.row * zoom, image_size.col * zoom};
+    int fft_col_count = (image_size.col / 2) + 1;
+    int fft_zoomed_col_count = zoomed_size.col / 2 + 1;
+
+    // 2) window of the periodized spectrum: spectrum copies and their
+    //    mirrors span consecutive frequencies and the first columns
+    auto frequency = [&zoomed_size](int zoomed_row) {
+        return (2 * zoomed_row < zoomed_size.row)
+                     ? zoomed_row
+                     : zoomed_row - zoomed_size.row;
+    };
+    int first_frequency = zoomed_size.row;
+    int last_frequency = -zoomed_size.row;
+    int first_mirrored_col = 0;
+    for (int zoomed_row = 0; zoomed_row < zoomed_size.row; ++zoomed_row) {
+        if (PeriodizedRowSource(zoom, image_size, zoomed_row,
+                                first_mirrored_col) >= 0) {
+            first_frequency = std::min(first_frequency, frequency(zoomed_row));
+            last_frequency = std::max(last_frequency, frequency(zoomed_row));
+        }
+    }
+    Size window_size(last_frequency - first_frequency + 1,
+                     std::min(2 * fft_col_count, fft_zoomed_col_count));
+
+    LOG("periodization_zoom", trace, "periodize FFT rows in a {}x{} window",
+        window_size.row, window_size.col);
+    std::vector<int> zoomed_rows(window_size.row);
+    auto spectrum = fftw::CreateComplex<T>(
+          {window_size.row, 2 * (window_size.col - 1)});
+    for (int i = 0; i < window_size.row; ++i) {
+        int zoomed_row = (first_frequency + i + zoomed_size.row) %
+                         zoomed_size.row;
+        zoomed_rows[i] = zoomed_row;
+        int row = PeriodizedRowSource(zoom, image_size, zoomed_row,
+                                      first_mirrored_col);
+        if (row >= 0) {
+            PeriodizeRow<T>(fft_col_count,
+                            image_fft.get() + row * fft_col_count,
+                            first_mirrored_col, window_size.col,
+                            spectrum.get() + i * window_size.col);
+        }
+    }
+
+    if (filter.IsLoaded()) {
+        // 3) Filter zoomed FFT coefficients
+        LOG("periodization_zoom", trace, "apply filter");
+        filter.ProcessRows<T>(zoomed_size, zoomed_rows, window_size.col,
+                              spectrum.get());
+    }
+
+    // 4-6) IFFT on the sampled rows and cols, normalized
+    LOG("periodization_zoom", trace, "sample {}x{} pixels", grid.size.row,
+        grid.size.col);
+    return SampleSpectrum<T>(spectrum.get(), window_size, first_frequency,
+                             zoomed_size, grid, image_size.CellCount());
+}
+
+template <typename T>
+fftw::BasicComplexUPtr<T> PeriodizationZoomStrategy::PeriodizeFFT(
+      int zoom, const BasicImage<T>& image,
+      fftw::BasicComplexUPtr<T> image_fft) const {
     if (zoom <= 1) {
         // nothing to periodize: 1:1 zoom
         return image_fft;
     }
 
-    int image_row_count = image.size.row;
-    int image_col_count = image.size.col;
-
-    int fft_row_count = image_row_count;
-    int fft_col_count = (image_col_count / 2) + 1;
-
-    int zoomed_row_count = image_row_count * zoom;
-    int zoomed_col_count = image_col_count * zoom;
-    int fft_zoomed_row_count = zoomed_row_count;
-    int fft_zoomed_col_count = zoomed_col_count / 2 + 1;
-
-    Size zoomed_fft_size(fft_zoomed_row_count, fft_zoomed_col_count);
-    auto zoomed_fft = fftw::CreateComplex(zoomed_fft_size);
-
-    auto image_fft_span = utils::MakeSmartPtrArraySpan(image_fft, image.size);
-    auto zoomed_fft_span =
-          utils::MakeSmartPtrArraySpan(zoomed_fft, zoomed_fft_size);
-    for (int row = 0; row < fft_row_count; ++row) {
-        int bottom_row = (fft_zoomed_row_count - fft_row_count + row) *
-                         fft_zoomed_col_count;
-        for (int col = 0; col < fft_col_count; ++col) {
-            int fft_idx = row * fft_col_count + col;
-            int top_left_idx = row * fft_zoomed_col_count + col;
-            int bottom_left_idx = bottom_row + col;
-            int top_right_idx =
-                  row * fft_zoomed_col_count + 2 * fft_col_count - col - 2;
-            int bottom_right_idx = bottom_row + 2 * fft_col_count - col - 2;
-
-            int top_bottom_left_idx =
-                  top_left_idx +
-                  2 * (fft_row_count - row - 1) * fft_zoomed_col_count;
-            int top_bottom_right_idx =
-                  top_right_idx +
-                  (2 * (fft_row_count - row) - 1) * fft_zoomed_col_count + 1;
-
-            int bottom_top_left_idx =
-                  (fft_zoomed_row_count - fft_row_count - 1 - row) *
-                        fft_zoomed_col_count +
-                  col;
-            int bottom_top_right_idx =
-                  bottom_top_left_idx + 2 * (fft_col_count - col) - 1;
-
-            double real_val = image_fft_span[fft_idx][0];
-            double im_val = image_fft_span[fft_idx][1];
-
-            // copy top left corner
-            zoomed_fft_span[top_left_idx][0] = real_val;
-            zoomed_fft_span[top_left_idx][1] = im_val;
-
-            // copy bottom left corner
-            zoomed_fft_span[bottom_left_idx][0] = real_val;
-            zoomed_fft_span[bottom_left_idx][1] = im_val;
-
-            if (zoom != 2) {
-                // copy to the top bottom left corner
-                if (row == fft_row_count - 1) {
-                    zoomed_fft_span[top_bottom_left_idx][0] = real_val;
-                    zoomed_fft_span[top_bottom_left_idx][1] = im_val;
-                } else {
-                    double tmp_real_val =
-                          image_fft_span[(row + 1) * fft_col_count + col][0];
-                    double tmp_im_val =
-                          image_fft_span[(row + 1) * fft_col_count + col][1];
-                    zoomed_fft_span[top_bottom_left_idx][0] = tmp_real_val;
-                    zoomed_fft_span[top_bottom_left_idx][1] = tmp_im_val;
-                }
-
-                // copy to the top bottom right corner
-                if (top_bottom_right_idx <
-                    fft_zoomed_col_count * (2 * fft_row_count - 1)) {
-                    zoomed_fft_span[top_bottom_right_idx][0] = real_val;
-                    zoomed_fft_span[top_bottom_right_idx][1] = im_val;
-                }
-
-                // copy to the bottom top right corner
-                zoomed_fft_span[bottom_top_right_idx][0] = real_val;
-                zoomed_fft_span[bottom_top_right_idx][1] = im_val;
-
-                // copy to the bottom top left corner
-                zoomed_fft_span[bottom_top_left_idx][0] = real_val;
-                zoomed_fft_span[bottom_top_left_idx][1] = im_val;
-            }
-
-            if (col == fft_col_count - 1) {
-                // duplicate extreme right pixel of each source spectrum row
-                zoomed_fft_span[top_right_idx][0] = real_val;
-                zoomed_fft_span[top_right_idx][1] = im_val;
-
-                zoomed_fft_span[bottom_right_idx][0] = real_val;
-                zoomed_fft_span[bottom_right_idx][1] = im_val;
-            } else {
-                double right_real_val = image_fft_span[fft_idx + 1][0];
-                double right_im_val = image_fft_span[fft_idx + 1][1];
-                // copy top right corner
-                zoomed_fft_span[top_right_idx][0] = right_real_val;
-                zoomed_fft_span[top_right_idx][1] = right_im_val;
-
-                // copy bottom right corner
-                zoomed_fft_span[bottom_right_idx][0] = right_real_val;
-                zoomed_fft_span[bottom_right_idx][1] = right_im_val;
-            }
+    Size zoomed_fft_size(image.size.row * zoom,
+                         (image.size.col * zoom) / 2 + 1);
+    auto zoomed_fft = fftw::AllocateComplex<T>(zoomed_fft_size);
+    PeriodizeSpectrum<T>(zoom, image.size, image_fft.get(), zoomed_fft.get());
+
+    return zoomed_fft;
+}
+
+template <typename T>
+void PeriodizationZoomStrategy::PeriodizeSpectrum(
+      int zoom, const Size& image_size, const fftw::BasicComplex<T>* image_fft,
+      fftw::BasicComplex<T>* zoomed_fft) const {
+    using Complex = fftw::BasicComplex<T>;
+
+    int fft_col_count = (image_size.col / 2) + 1;
+
+    int fft_zoomed_row_count = image_size.row * zoom;
+    int fft_zoomed_col_count = (image_size.col * zoom) / 2 + 1;
+
+    // each zoomed row is either a copy of a source row followed by its
+    //   mirrored segment, or zero. Rows are written one after the other so
+    //   that the destination is streamed once and zeros are only written
+    //   where no spectrum copy lands.
+    for (int zoomed_row = 0; zoomed_row < fft_zoomed_row_count;
+         ++zoomed_row) {
+        Complex* dst = zoomed_fft + zoomed_row * fft_zoomed_col_count;
+        int first_mirrored_col = 0;
+        int row = PeriodizedRowSource(zoom, image_size, zoomed_row,
+                                      first_mirrored_col);
+        if (row >= 0) {
+            PeriodizeRow<T>(fft_col_count, image_fft + row * fft_col_count,
+                            first_mirrored_col, fft_zoomed_col_count, dst);
+        } else {
+            std::memset(dst, 0, fft_zoomed_col_count * sizeof(Complex));
         }
     }
+}
 
-    return zoomed_fft;
+int PeriodizationZoomStrategy::PeriodizedRowSource(
+      int zoom, const Size& image_size, int zoomed_row,
+      int& first_mirrored_col) const {
+    int fft_row_count = image_size.row;
+    int fft_zoomed_row_count = image_size.row * zoom;
+    // first row of the bottom copy of the spectrum
+    int bottom_begin = fft_zoomed_row_count - fft_row_count;
+
+    // the top and bottom copies mirror X[row, C-1..1] (the last source
+    //   column is duplicated), the inner copies mirror X[row, C-1..0]
+    first_mirrored_col = 1;
+    if (zoomed_row < fft_row_count) {
+        // top copy
+        return zoomed_row;
+    }
+    if (zoomed_row >= bottom_begin) {
+        // bottom copy
+        return zoomed_row - bottom_begin;
+    }
+    first_mirrored_col = 0;
+    if (zoom != 2 && zoomed_row <= 2 * fft_row_count - 2) {
+        // row flipped copy under the top copy
+        return 2 * fft_row_count - 1 - zoomed_row;
+    }
+    if (zoom != 2 && zoomed_row >= bottom_begin - fft_row_count) {
+        // row flipped copy above the bottom copy
+        return bottom_begin - 1 - zoomed_row;
+    }
+    return -1;
 }
 
+template <typename T>
+void PeriodizationZoomStrategy::PeriodizeRow(
+      int fft_col_count, const fftw::BasicComplex<T>* src,
+      int first_mirrored_col, int col_count,
+      fftw::BasicComplex<T>* dst) const {
+    using Complex = fftw::BasicComplex<T>;
+    int copied_count = std::min(fft_col_count, col_count);
+    std::memcpy(dst, src, copied_count * sizeof(Complex));
+
+    Complex* mirror = dst + copied_count;
+    int mirrored_count = std::min(fft_col_count - first_mirrored_col,
+                                  col_count - copied_count);
+    const Complex* mirror_src = src + fft_col_count - 1;
+    for (int i = 0; i < mirrored_count; ++i) {
+        mirror[i][0] = mirror_src[-i][0];
+        mirror[i][1] = mirror_src[-i][1];
+    }
+
+    int written_count = copied_count + mirrored_count;
+    if (written_count < col_count) {
+        std::memset(dst + written_count, 0,
+                    (col_count - written_count) * sizeof(Complex));
+    }
+}
+
+template Image PeriodizationZoomStrategy::Zoom<double>(
+      int zoom, const Image& padded_image, const Filter& filter) const;
+template FloatImage PeriodizationZoomStrategy::Zoom<float>(
+      int zoom, const FloatImage& padded_image, const Filter& filter) const;
+
+template std::vector<Image> PeriodizationZoomStrategy::ZoomBatch<double>(
+      int zoom, const std::vector<Image>& padded_images,
+      const Filter& filter) const;
+template std::vector<FloatImage> PeriodizationZoomStrategy::ZoomBatch<float>(
+      int zoom, const std::vector<FloatImage>& padded_images,
+      const Filter& filter) const;
+
+template Image PeriodizationZoomStrategy::ZoomSampled<double>(
+      int zoom, const Image& padded_image, const Filter& filter,
+      const SamplingGrid& grid) const;
+template FloatImage PeriodizationZoomStrategy::ZoomSampled<float>(
+      int zoom, const FloatImage& padded_image, const Filter& filter,
+      const SamplingGrid& grid) const;
+
+template Image PeriodizationZoomStrategy::ZoomSpectrum<double>(
+      int zoom, const Size& image_size, fftw::ComplexUPtr image_fft,
+      const Filter& filter) const;
+template FloatImage PeriodizationZoomStrategy::ZoomSpectrum<float>(
+      int zoom, const Size& image_size, fftw::BasicComplexUPtr<float> image_fft,
+      const Filter& filter) const;
+
+template Image PeriodizationZoomStrategy::ZoomSpectrumSampled<double>(
+      int zoom, const Size& image_size, fftw::ComplexUPtr image_fft,
+      const Filter& filter, const SamplingGrid& grid) const;
+template FloatImage PeriodizationZoomStrategy::ZoomSpectrumSampled<float>(
+      int zoom, const Size& image_size, fftw::BasicComplexUPtr<float> image_fft,
+      const Filter& filter, const SamplingGrid& grid) const;
+
+template fftw::ComplexUPtr PeriodizationZoomStrategy::PeriodizeFFT<double>(
+      int zoom, const Image& image, fftw::ComplexUPtr image_fft) const;
+template fftw::BasicComplexUPtr<float> PeriodizationZoomStrategy::PeriodizeFFT<float>(
+      int zoom, const FloatImage& image,
+      fftw::BasicComplexUPtr<float> image_fft) const;
+
 }  // namespace zoom
 }  // namespace sirius
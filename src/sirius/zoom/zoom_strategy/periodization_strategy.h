@@ -22,6 +22,8 @@
 #ifndef SIRIUS_ZOOM_ZOOM_STRATEGY_PERIODIZATION_STRATEGY_H_
 #define SIRIUS_ZOOM_ZOOM_STRATEGY_PERIODIZATION_STRATEGY_H_
 
+#include <vector>
+
 #include "sirius/fftw/types.h"
 #include "sirius/filter.h"
 #include "sirius/image.h"
@@ -34,11 +36,133 @@ namespace zoom {
  */
 class PeriodizationZoomStrategy {
   public:
-    Image Zoom(int zoom, const Image& padded_image, const Filter& filter) const;
+    template <typename T>
+    BasicImage<T> Zoom(int zoom, const BasicImage<T>& padded_image,
+                       const Filter& filter) const;
+
+    /**
+     * \brief Zoom an image from its FFT
+     * \param zoom zoom factor
+     * \param image_size size of the image
+     * \param image_fft FFT of the image
+     * \param filter filter to apply on the zoomed FFT
+     * \return zoomed image, normalized by the image cell count
+     */
+    template <typename T>
+    BasicImage<T> ZoomSpectrum(int zoom, const Size& image_size,
+                               fftw::BasicComplexUPtr<T> image_fft,
+                               const Filter& filter) const;
+
+    /**
+     * \brief Zoom a batch of images of the same size
+     *
+     * FFTs and IFFTs of the batch are computed with single plans and the
+     * filter spectrum is fetched once.
+     *
+     * \param zoom zoom factor
+     * \param padded_images images of the same size
+     * \param filter filter to apply on the zoomed FFTs
+     * \return zoomed images
+     */
+    template <typename T>
+    std::vector<BasicImage<T>> ZoomBatch(
+          int zoom, const std::vector<BasicImage<T>>& padded_images,
+          const Filter& filter) const;
+
+    /**
+     * \brief Zoom an image and only compute a grid of samples of the zoomed
+     *        image
+     *
+     * The rows of the periodized spectrum are generated one at a time in a
+     * compact window which holds its non-zero coefficients, then evaluated
+     * on the sampled rows and cols (see SampleSpectrum): the zoomed image is
+     * never computed. The filter is always applied on the spectrum.
+     *
+     * \param zoom zoom factor
+     * \param padded_image image to zoom
+     * \param filter filter to apply on the zoomed image
+     * \param grid samples of the zoomed image to compute
+     * \return samples of the zoomed image, normalized as in Zoom
+     */
+    template <typename T>
+    BasicImage<T> ZoomSampled(int zoom, const BasicImage<T>& padded_image,
+                              const Filter& filter,
+                              const SamplingGrid& grid) const;
+
+    /**
+     * \brief ZoomSampled from the image FFT
+     */
+    template <typename T>
+    BasicImage<T> ZoomSpectrumSampled(int zoom, const Size& image_size,
+                                      fftw::BasicComplexUPtr<T> image_fft,
+                                      const Filter& filter,
+                                      const SamplingGrid& grid) const;
+
+    /**
+     * \brief Whether Zoom and ZoomBatch convolve the zoomed image instead of
+     *        multiplying its FFT by the filter spectrum
+     *
+     * The IFFT is the same on both paths.
+     *
+     * \param zoom zoom factor
+     * \param zoomed_size size of the zoomed image
+     * \param filter filter to apply on the zoomed image
+     * \return true if the filter spectrum is not used
+     */
+    bool UseDirectFilter(int zoom, const Size& zoomed_size,
+                         const Filter& filter) const;
+
+    /**
+     * \brief Periodize the image FFT on the zoomed FFT grid
+     * \param zoom zoom factor
+     * \param image source image
+     * \param image_fft FFT of the source image
+     * \return zoomed FFT
+     */
+    template <typename T>
+    fftw::BasicComplexUPtr<T> PeriodizeFFT(
+          int zoom, const BasicImage<T>& image,
+          fftw::BasicComplexUPtr<T> image_fft) const;
 
   private:
-    fftw::ComplexUPtr PeriodizeFFT(int zoom, const Image& image,
-                                   fftw::ComplexUPtr image_fft) const;
+    /**
+     * \brief Locate the source row of a row of the periodized spectrum
+     * \param zoom zoom factor
+     * \param image_size size of the source image
+     * \param zoomed_row row of the zoomed FFT
+     * \param first_mirrored_col first column of the source row which is
+     *        mirrored after its copy
+     * \return row of the image FFT, -1 if the zoomed row is zero
+     */
+    int PeriodizedRowSource(int zoom, const Size& image_size, int zoomed_row,
+                            int& first_mirrored_col) const;
+
+    /**
+     * \brief Write a row of the periodized spectrum
+     * \param fft_col_count column count of the image FFT
+     * \param src source row of the image FFT
+     * \param first_mirrored_col cf. PeriodizedRowSource
+     * \param col_count number of coefficients to write
+     * \param dst zoomed row, every coefficient up to col_count is written
+     */
+    template <typename T>
+    void PeriodizeRow(int fft_col_count, const fftw::BasicComplex<T>* src,
+                      int first_mirrored_col, int col_count,
+                      fftw::BasicComplex<T>* dst) const;
+
+    /**
+     * \brief Copy the image FFT periodically on the zoomed FFT grid
+     * \param zoom zoom factor
+     * \param image_size size of the source image
+     * \param image_fft FFT of the source image
+     * \param zoomed_fft zoomed FFT, every coefficient is written
+     *
+     * zoom must be greater than 1
+     */
+    template <typename T>
+    void PeriodizeSpectrum(int zoom, const Size& image_size,
+                           const fftw::BasicComplex<T>* image_fft,
+                           fftw::BasicComplex<T>* zoomed_fft) const;
 };
 
 }  // namespace zoom
@@ -0,0 +1,282 @@
+/**
+ * Copyright (C) 2018 CS - Systeme d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sirius/zoom/zoom_strategy/spectrum_sampling.h"
+
+#include <cmath>
+
+#include <complex>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "sirius/fftw/fftw.h"
+#include "sirius/fftw/wrapper.h"
+
+#include "sirius/utils/complex_multiply.h"
+#include "sirius/utils/log.h"
+#include "sirius/utils/lru_cache.h"
+
+namespace sirius {
+namespace zoom {
+
+namespace {
+
+constexpr std::size_t kChirpCacheSize = 10;
+
+/**
+ * \brief Smallest length not lower than size with 2, 3, 5 and 7 as only
+ *        prime factors
+ */
+int ComputeSmoothLength(int size) {
+    for (int length = size;; ++length) {
+        int remainder = length;
+        for (int factor : {2, 3, 5, 7}) {
+            while (remainder % factor == 0) {
+                remainder /= factor;
+            }
+        }
+        if (remainder == 1) {
+            return length;
+        }
+    }
+}
+
+/**
+ * \brief exp(2i.pi.numerator / denominator)
+ *
+ * numerator is reduced modulo denominator before the conversion to double
+ */
+inline std::complex<double> UnitRoot(long long numerator,
+                                     long long denominator) {
+    double angle = 2 * M_PI * static_cast<double>(numerator % denominator) /
+                   static_cast<double>(denominator);
+    return {std::cos(angle), std::sin(angle)};
+}
+
+/**
+ * \brief exp(i.pi.step.n^2 / length)
+ */
+inline std::complex<double> Chirp(int step, int length, long long n) {
+    return UnitRoot(step * n * n, 2LL * length);
+}
+
+/**
+ * \brief Chirp of a chirp-z transform and its inverse DFT, which only
+ *        depend on the transform sizes
+ */
+template <typename T>
+struct ChirpZKernel {
+    int fft_length = 0;
+    // inverse DFT of the chirp on n in ]-input_count, output_count[
+    fftw::BasicComplexUPtr<T> chirp_fft;
+};
+
+template <typename T>
+using ChirpZKernelSPtr = std::shared_ptr<const ChirpZKernel<T>>;
+
+// input_count, output_count, length, step
+using ChirpZKey = std::tuple<int, int, int, int>;
+
+template <typename T>
+ChirpZKernelSPtr<T> CreateChirpZKernel(int input_count, int output_count,
+                                       int length, int step) {
+    LOG("zero_padding_zoom", trace, "compute chirp {}x{} ({}, {})",
+        input_count, output_count, length, step);
+    auto kernel = std::make_shared<ChirpZKernel<T>>();
+    kernel->fft_length = ComputeSmoothLength(input_count + output_count - 1);
+
+    Size chirp_size(kernel->fft_length, 1);
+    kernel->chirp_fft = fftw::CreateComplex<T>(chirp_size);
+    auto* chirp_fft = kernel->chirp_fft.get();
+    for (int n = -(input_count - 1); n < output_count; ++n) {
+        auto value = Chirp(step, length, n);
+        int index = (n + kernel->fft_length) % kernel->fft_length;
+        chirp_fft[index][0] = static_cast<T>(value.real());
+        chirp_fft[index][1] = static_cast<T>(value.imag());
+    }
+    auto chirp_plan = fftw::Fftw::Instance().GetColumnsInversePlan<T>(
+          chirp_size, chirp_fft);
+    fftw::Traits<T>::ExecuteC2C(chirp_plan.get(), chirp_fft, chirp_fft);
+    return kernel;
+}
+
+/**
+ * \brief Get the chirp-z kernel of a transform
+ *
+ * Kernels are cached by transform sizes.
+ */
+template <typename T>
+ChirpZKernelSPtr<T> GetChirpZKernel(int input_count, int output_count,
+                                    int length, int step) {
+#ifdef SIRIUS_ENABLE_CACHE_OPTIMIZATION
+    static utils::LRUCache<ChirpZKey, ChirpZKernelSPtr<T>, kChirpCacheSize>
+          kernel_cache;
+    return kernel_cache.GetOrInsert(
+          ChirpZKey(input_count, output_count, length, step), [=]() {
+              return CreateChirpZKernel<T>(input_count, output_count, length,
+                                           step);
+          });
+#else
+    return CreateChirpZKernel<T>(input_count, output_count, length, step);
+#endif  // SIRIUS_ENABLE_CACHE_OPTIMIZATION
+}
+
+/**
+ * \brief Evaluate the inverse DFT of each column of a spectrum on a regular
+ *        grid of an oversampled signal (chirp-z transform)
+ *
+ * out(t, b) = sum_k in(k, b) exp(2i.pi (first_frequency + k) m_t / length)
+ * with m_t = begin + t * step. k.m_t is expanded as a convolution with a
+ * chirp (Bluestein algorithm) computed by FFTs of a 2-3-5-7 smooth length
+ * of at least input_count + output_count - 1. Only inverse column plans are
+ * used: forward transforms are conjugated inverse transforms.
+ *
+ * \param in input_count x col_count spectrum
+ * \param input_count number of frequencies
+ * \param col_count number of columns
+ * \param first_frequency frequency of the first input row
+ * \param length length of the oversampled signal
+ * \param begin first evaluated sample
+ * \param step sampling step
+ * \param output_count number of evaluated samples
+ * \return output_count x col_count samples
+ */
+template <typename T>
+fftw::BasicComplexUPtr<T> ChirpZColumns(const fftw::BasicComplex<T>* in,
+                                        int input_count, int col_count,
+                                        int first_frequency, int length,
+                                        int begin, int step,
+                                        int output_count) {
+    using Complex = std::complex<double>;
+    auto& fftw_instance = fftw::Fftw::Instance();
+
+    // 1) inverse DFT of the chirp (conjugated DFT of the conjugated chirp)
+    auto kernel = GetChirpZKernel<T>(input_count, output_count, length, step);
+    int fft_length = kernel->fft_length;
+
+    // 2) modulated input and its conjugated DFT
+    Size work_size(fft_length, col_count);
+    auto work = fftw::CreateComplex<T>(work_size);
+    for (int k = 0; k < input_count; ++k) {
+        Complex modulation = UnitRoot(static_cast<long long>(k) * begin,
+                                      length) *
+                             Chirp(step, length, k);
+        for (int b = 0; b < col_count; ++b) {
+            const auto& cell = in[k * col_count + b];
+            Complex value = Complex(cell[0], cell[1]) * modulation;
+            work.get()[k * col_count + b][0] = static_cast<T>(value.real());
+            work.get()[k * col_count + b][1] = static_cast<T>(-value.imag());
+        }
+    }
+    auto work_plan =
+          fftw_instance.GetColumnsInversePlan<T>(work_size, work.get());
+    fftw::Traits<T>::ExecuteC2C(work_plan.get(), work.get(), work.get());
+
+    // 3) convolution: inverse DFT of the product of the DFTs. The product is
+    //    not conjugated back, the conjugation is undone in 4) with
+    //    IDFT(conj(p))[t] = conj(IDFT(p)[-t])
+    std::vector<T> chirp_row(2 * col_count);
+    for (int l = 0; l < fft_length; ++l) {
+        const auto& chirp_cell = kernel->chirp_fft.get()[l];
+        for (int b = 0; b < col_count; ++b) {
+            chirp_row[2 * b] = chirp_cell[0];
+            chirp_row[2 * b + 1] = chirp_cell[1];
+        }
+        utils::MultiplyComplex(reinterpret_cast<T*>(work.get() + l * col_count),
+                               chirp_row.data(), col_count);
+    }
+    fftw::Traits<T>::ExecuteC2C(work_plan.get(), work.get(), work.get());
+
+    // 4) demodulation
+    auto out = fftw::CreateComplex<T>({output_count, col_count});
+    for (int t = 0; t < output_count; ++t) {
+        long long sample = begin + static_cast<long long>(t) * step;
+        Complex demodulation = Chirp(step, length, t) *
+                               UnitRoot(first_frequency * sample, length) /
+                               static_cast<double>(fft_length);
+        int work_row = (fft_length - t) % fft_length;
+        for (int b = 0; b < col_count; ++b) {
+            const auto& cell = work.get()[work_row * col_count + b];
+            Complex value = Complex(cell[0], -cell[1]) * demodulation;
+            out.get()[t * col_count + b][0] = static_cast<T>(value.real());
+            out.get()[t * col_count + b][1] = static_cast<T>(value.imag());
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+template <typename T>
+BasicImage<T> SampleSpectrum(const fftw::BasicComplex<T>* spectrum,
+                             const Size& spectrum_size, int first_frequency,
+                             const Size& zoomed_size, const SamplingGrid& grid,
+                             int normalization) {
+    int col_count = spectrum_size.col;
+
+    // 1) columns IFFT on the sampled rows
+    LOG("spectrum_sampling", trace, "evaluate spectrum on {} sampled rows",
+        grid.size.row);
+    auto columns = ChirpZColumns<T>(spectrum, spectrum_size.row, col_count,
+                                    first_frequency, zoomed_size.row,
+                                    grid.row_begin, grid.step, grid.size.row);
+
+    // 2) rows c2r IFFT on the sampled cols: hermitian symmetry doubles every
+    //    coefficient except the DC and Nyquist ones
+    LOG("spectrum_sampling", trace, "evaluate spectrum on {} sampled cols",
+        grid.size.col);
+    auto rows = fftw::CreateComplex<T>({col_count, grid.size.row});
+    for (int col = 0; col < col_count; ++col) {
+        T weight = (col == 0 || 2 * col == zoomed_size.col) ? 1 : 2;
+        for (int row = 0; row < grid.size.row; ++row) {
+            const auto& cell = columns.get()[row * col_count + col];
+            rows.get()[col * grid.size.row + row][0] = weight * cell[0];
+            rows.get()[col * grid.size.row + row][1] = weight * cell[1];
+        }
+    }
+    auto samples_fft = ChirpZColumns<T>(rows.get(), col_count, grid.size.row,
+                                        0, zoomed_size.col, grid.col_begin,
+                                        grid.step, grid.size.col);
+
+    // 3) Normalize samples
+    BasicImage<T> samples(grid.size);
+    for (int row = 0; row < grid.size.row; ++row) {
+        for (int col = 0; col < grid.size.col; ++col) {
+            samples.Set(row, col,
+                        samples_fft.get()[col * grid.size.row + row][0] /
+                              normalization);
+        }
+    }
+    return samples;
+}
+
+template Image SampleSpectrum<double>(
+      const fftw::BasicComplex<double>* spectrum, const Size& spectrum_size,
+      int first_frequency, const Size& zoomed_size, const SamplingGrid& grid,
+      int normalization);
+template FloatImage SampleSpectrum<float>(
+      const fftw::BasicComplex<float>* spectrum, const Size& spectrum_size,
+      int first_frequency, const Size& zoomed_size, const SamplingGrid& grid,
+      int normalization);
+
+}  // namespace zoom
+}  // namespace sirius
@@ -0,0 +1,60 @@
+/**
+ * Copyright (C) 2018 CS - Systeme d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIRIUS_ZOOM_ZOOM_STRATEGY_SPECTRUM_SAMPLING_H_
+#define SIRIUS_ZOOM_ZOOM_STRATEGY_SPECTRUM_SAMPLING_H_
+
+#include "sirius/image.h"
+#include "sirius/types.h"
+
+#include "sirius/fftw/types.h"
+
+namespace sirius {
+namespace zoom {
+
+/**
+ * \brief Evaluate the real IFFT of a zoomed spectrum on a grid of samples
+ *
+ * The zoomed spectrum is only given by a compact window: the rows of the
+ * consecutive frequencies first_frequency, first_frequency + 1, ... and the
+ * first columns of the zoomed FFT (r2c layout), every other coefficient being
+ * 0. The window is evaluated on the sampled rows, then on the sampled cols,
+ * with chirp-z transforms, so that the cost depends on the window and grid
+ * sizes instead of the zoomed size.
+ *
+ * \param spectrum compact spectrum, spectrum_size.row x spectrum_size.col
+ * \param spectrum_size size of the compact spectrum
+ * \param first_frequency frequency of the first row of the compact spectrum
+ * \param zoomed_size size of the zoomed image
+ * \param grid samples of the zoomed image to compute
+ * \param normalization factor dividing the samples
+ * \return samples of the zoomed image
+ */
+template <typename T>
+BasicImage<T> SampleSpectrum(const fftw::BasicComplex<T>* spectrum,
+                             const Size& spectrum_size, int first_frequency,
+                             const Size& zoomed_size, const SamplingGrid& grid,
+                             int normalization);
+
+}  // namespace zoom
+}  // namespace sirius
+
+#endif  // SIRIUS_ZOOM_ZOOM_STRATEGY_SPECTRUM_SAMPLING_H_
@@ -21,6 +21,9 @@
 
 #include "sirius/zoom/zoom_strategy/zero_padding_strategy.h"
 
+#include <cmath>
+#include <cstring>
+
 #include <algorithm>
 
 #include "sirius/fftw/exception.h"
@@ -31,53 +34,241 @@
 
 #include "sirius/exception.h"
 
-#include "sirius/utils/gsl.h"
 #include "sirius/utils/log.h"
 
+#include "sirius/zoom/zoom_strategy/spectrum_sampling.h"
+
 namespace sirius {
 namespace zoom {
 
-Image ZeroPaddingZoomStrategy::Zoom(int zoom, const Image& padded_image,
-                                    const Filter& filter) const {
+namespace {
+
+// rows computed by each c2r batch of the pruned IFFT. Multiple of 16 so that
+// every batch output keeps the alignment of the image buffer
+constexpr int kRowBatchSize = 16;
+
+}  // namespace
+
+bool ZeroPaddingZoomStrategy::UseDirectFilter(int zoom,
+                                              const Size& zoomed_size,
+                                              const Filter& filter) const {
+    // unfiltered columns of the zero padded FFT are pruned from the IFFT
+    return filter.UseDirectConvolution(zoomed_size, zoom);
+}
+
+template <typename T>
+BasicImage<T> ZeroPaddingZoomStrategy::Zoom(
+      int zoom, const BasicImage<T>& padded_image, const Filter& filter) const {
     // 1) FFT image
     LOG("zero_padding_zoom", trace, "compute image FFT {}x{}",
         padded_image.size.row, padded_image.size.col);
     auto image_fft = fftw::FFT(padded_image);
 
-    // 2) zoom FFT
-    LOG("zero_padding_zoom", trace, "zero pad FFT");
-    auto zoomed_fft = ZeroPadFFT(zoom, padded_image, std::move(image_fft));
+    return ZoomSpectrum(zoom, padded_image.size, std::move(image_fft), filter);
+}
 
-    Size zoomed_size{padded_image.size.row * zoom,
-                     padded_image.size.col * zoom};
+template <typename T>
+BasicImage<T> ZeroPaddingZoomStrategy::ZoomSpectrum(
+      int zoom, const Size& image_size, fftw::BasicComplexUPtr<T> image_fft,
+      const Filter& filter) const {
+    Size zoomed_size{image_size.row * zoom, image_size.col * zoom};
+    bool is_direct_filter = UseDirectFilter(zoom, zoomed_size, filter);
+    bool is_spectral_filter = filter.IsLoaded() && !is_direct_filter;
 
-    if (filter.IsLoaded()) {
-        // 3) Filter zoomed FFT
-        LOG("zero_padding_zoom", trace, "apply filter");
-        zoomed_fft = filter.Process(zoomed_size, std::move(zoomed_fft));
-    }
+    BasicImage<T> zoomed_image;
+    if (zoom > 1 && !is_spectral_filter) {
+        // 2-4) IFFT of the zero padded FFT, only non-zero coefficients are
+        // transformed
+        LOG("zero_padding_zoom", trace, "compute pruned zero padded IFFT");
+        zoomed_image = PrunedZeroPadIFFT<T>(zoom, image_size, image_fft.get());
+    } else {
+        // 2) zoom FFT
+        LOG("zero_padding_zoom", trace, "zero pad FFT");
+        fftw::BasicComplexUPtr<T> zoomed_fft;
+        if (zoom > 1) {
+            zoomed_fft = fftw::CreateComplex<T>(
+                  {zoomed_size.row, zoomed_size.col / 2 + 1});
+            ZeroPadSpectrum<T>(zoom, image_size, image_fft.get(),
+                               zoomed_fft.get());
+        } else {
+            zoomed_fft = std::move(image_fft);
+        }
 
-    // 4) IFFT zoomed FFT
-    LOG("zero_padding_zoom", trace, "compute image IFFT");
-    auto zoomed_image = fftw::IFFT(zoomed_size, std::move(zoomed_fft));
+        if (is_spectral_filter) {
+            // 3) Filter zoomed FFT
+            LOG("zero_padding_zoom", trace, "apply filter");
+            zoomed_fft = filter.Process(zoomed_size, std::move(zoomed_fft));
+        }
+
+        // 4) IFFT zoomed FFT
+        LOG("zero_padding_zoom", trace, "compute image IFFT");
+        zoomed_image = fftw::IFFT(zoomed_size, std::move(zoomed_fft));
+    }
 
     // 5) Normalize zoomed image
     LOG("zero_padding_zoom", trace, "normalize image");
-    int pixel_count = padded_image.CellCount();
+    int pixel_count = image_size.CellCount();
     std::for_each(zoomed_image.data.begin(), zoomed_image.data.end(),
-                  [pixel_count](double& pixel) { pixel /= pixel_count; });
+                  [pixel_count](T& pixel) { pixel /= pixel_count; });
+
+    if (is_direct_filter) {
+        // 6) Filter zoomed image
+        LOG("zero_padding_zoom", trace, "convolve image with filter");
+        filter.Convolve(zoomed_image);
+    }
     return zoomed_image;
 }
 
-fftw::ComplexUPtr ZeroPaddingZoomStrategy::ZeroPadFFT(
-      int zoom, const Image& image, fftw::ComplexUPtr image_fft) const {
+template <typename T>
+std::vector<BasicImage<T>> ZeroPaddingZoomStrategy::ZoomBatch(
+      int zoom, const std::vector<BasicImage<T>>& padded_images,
+      const Filter& filter) const {
+    const Size& image_size = padded_images.front().size;
+    int batch_count = padded_images.size();
+    int fft_count = image_size.row * (image_size.col / 2 + 1);
+
+    // 1) FFT images
+    LOG("zero_padding_zoom", trace, "compute {} image FFTs {}x{}",
+        batch_count, image_size.row, image_size.col);
+    auto batch_fft = fftw::BatchFFT(padded_images);
+
+    Size zoomed_size{image_size.row * zoom, image_size.col * zoom};
+    bool is_direct_filter = UseDirectFilter(zoom, zoomed_size, filter);
+    bool is_spectral_filter = filter.IsLoaded() && !is_direct_filter;
+
+    std::vector<BasicImage<T>> zoomed_images;
+    if (zoom > 1 && !is_spectral_filter) {
+        // 2-4) IFFT of the zero padded FFTs, only non-zero coefficients are
+        // transformed (row IFFTs are already batched)
+        LOG("zero_padding_zoom", trace, "compute pruned zero padded IFFTs");
+        zoomed_images.reserve(batch_count);
+        for (int i = 0; i < batch_count; ++i) {
+            zoomed_images.push_back(PrunedZeroPadIFFT<T>(
+                  zoom, image_size, batch_fft.get() + i * fft_count));
+        }
+    } else {
+        // 2) zoom FFTs
+        fftw::BasicComplexUPtr<T> zoomed_batch_fft;
+        if (zoom > 1) {
+            LOG("zero_padding_zoom", trace, "zero pad FFTs");
+            int zoomed_fft_count = zoomed_size.row * (zoomed_size.col / 2 + 1);
+            zoomed_batch_fft = fftw::CreateComplex<T>(
+                  {zoomed_size.row * batch_count, zoomed_size.col / 2 + 1});
+            for (int i = 0; i < batch_count; ++i) {
+                ZeroPadSpectrum<T>(
+                      zoom, image_size, batch_fft.get() + i * fft_count,
+                      zoomed_batch_fft.get() + i * zoomed_fft_count);
+            }
+        } else {
+            zoomed_batch_fft = std::move(batch_fft);
+        }
+
+        if (is_spectral_filter) {
+            // 3) Filter zoomed FFTs
+            LOG("zero_padding_zoom", trace, "apply filter");
+            filter.ProcessBatch<T>(zoomed_size, batch_count,
+                                   zoomed_batch_fft.get());
+        }
+
+        // 4) IFFT zoomed FFTs
+        LOG("zero_padding_zoom", trace, "compute image IFFTs");
+        zoomed_images = fftw::BatchIFFT(zoomed_size, batch_count,
+                                        std::move(zoomed_batch_fft));
+    }
+
+    // 5) Normalize zoomed images
+    LOG("zero_padding_zoom", trace, "normalize images");
+    int pixel_count = image_size.CellCount();
+    for (auto& zoomed_image : zoomed_images) {
+        std::for_each(zoomed_image.data.begin(), zoomed_image.data.end(),
+                      [pixel_count](T& pixel) { pixel /= pixel_count; });
+    }
+
+    if (is_direct_filter) {
+        // 6) Filter zoomed images
+        LOG("zero_padding_zoom", trace, "convolve images with filter");
+        for (auto& zoomed_image : zoomed_images) {
+            filter.Convolve(zoomed_image);
+        }
+    }
+    return zoomed_images;
+}
+
+template <typename T>
+BasicImage<T> ZeroPaddingZoomStrategy::ZoomSampled(
+      int zoom, const BasicImage<T>& padded_image, const Filter& filter,
+      const SamplingGrid& grid) const {
+    // 1) FFT image
+    LOG("zero_padding_zoom", trace, "compute image FFT {}x{}",
+        padded_image.size.row, padded_image.size.col);
+    auto image_fft = fftw::FFT(padded_image);
+
+    return ZoomSpectrumSampled(zoom, padded_image.size, std::move(image_fft),
+                               filter, grid);
+}
+
+template <typename T>
+BasicImage<T> ZeroPaddingZoomStrategy::ZoomSpectrumSampled(
+      int zoom, const Size& image_size, fftw::BasicComplexUPtr<T> image_fft,
+      const Filter& filter, const SamplingGrid& grid) const {
+    using Complex = fftw::BasicComplex<T>;
+    Size zoomed_size{image_size.row * zoom, image_size.col * zoom};
+    int half_row_count = image_size.row / 2;
+    int fft_col_count = (image_size.col / 2) + 1;
+
+    // 2) sort FFT rows by frequency, from -half_row_count, and locate them
+    //    on the zoomed FFT grid
+    std::vector<int> zoomed_rows(image_size.row);
+    auto spectrum = fftw::CreateComplex<T>({image_size.row, fft_col_count});
+    for (int row = 0; row < image_size.row; ++row) {
+        int frequency = row - half_row_count;
+        int fft_row = (frequency < 0) ? image_size.row + frequency : frequency;
+        zoomed_rows[row] =
+              (frequency < 0) ? zoomed_size.row + frequency : frequency;
+        std::memcpy(spectrum.get() + row * fft_col_count,
+                    image_fft.get() + fft_row * fft_col_count,
+                    fft_col_count * sizeof(Complex));
+    }
+
+    if (filter.IsLoaded()) {
+        // 3) Filter zoomed FFT coefficients
+        LOG("zero_padding_zoom", trace, "apply filter");
+        filter.ProcessRows<T>(zoomed_size, zoomed_rows, fft_col_count,
+                              spectrum.get());
+    }
+
+    // 4-6) IFFT on the sampled rows and cols, normalized
+    return SampleSpectrum<T>(spectrum.get(), {image_size.row, fft_col_count},
+                             -half_row_count, zoomed_size, grid,
+                             image_size.CellCount());
+}
+
+template <typename T>
+fftw::BasicComplexUPtr<T> ZeroPaddingZoomStrategy::ZeroPadFFT(
+      int zoom, const BasicImage<T>& image,
+      fftw::BasicComplexUPtr<T> image_fft) const {
     if (zoom <= 1) {
         // nothing to pad: 1:1 zoom
         return image_fft;
     }
 
-    int image_row_count = image.size.row;
-    int image_col_count = image.size.col;
+    Size zoomed_fft_size(image.size.row * zoom,
+                         (image.size.col * zoom) / 2 + 1);
+    // zero padding zoom
+    // 1) fill result with 0 (initialized in fftw::CreateComplex)
+    // 2) copy image_fft on the zoomed FFT grid
+    auto zoomed_fft = fftw::CreateComplex<T>(zoomed_fft_size);
+    ZeroPadSpectrum<T>(zoom, image.size, image_fft.get(), zoomed_fft.get());
+
+    return zoomed_fft;
+}
+
+template <typename T>
+void ZeroPaddingZoomStrategy::ZeroPadSpectrum(
+      int zoom, const Size& image_size, const fftw::BasicComplex<T>* image_fft,
+      fftw::BasicComplex<T>* zoomed_fft) const {
+    int image_row_count = image_size.row;
+    int image_col_count = image_size.col;
     int half_row_count = std::ceil(image_row_count / 2.0);
 
     int fft_row_count = image_row_count;
@@ -85,49 +276,116 @@ fftw::ComplexUPtr ZeroPaddingZoomStrategy::ZeroPadFFT(
 
     int zoomed_row_count = image_row_count * zoom;
     int zoomed_col_count = image_col_count * zoom;
-    int fft_zoomed_row_count = zoomed_row_count;
     int fft_zoomed_col_count = zoomed_col_count / 2 + 1;
 
-    Size zoomed_fft_size(fft_zoomed_row_count, fft_zoomed_col_count);
-    auto zoomed_fft = fftw::CreateComplex(zoomed_fft_size);
-
-    // zero padding zoom
-    // 1) fill result with 0 (initialized in fftw::CreateComplex)
-    // 2) split image_fft in two blocks: (0, half_row_count, 0, fft_col_count)
-    //   and (half_row_count, fft_row_count, 0, fft_col_count)
+    // split image_fft in two blocks: (0, half_row_count, 0, fft_col_count)
+    // and (half_row_count, fft_row_count, 0, fft_col_count)
     //   - copy first block in top-left corner of zoomed_fft
     //   - copy second block in bottom left corner of zoomed_fft
+    for (int row = 0; row < fft_row_count; ++row) {
+        int zoomed_row = (row < half_row_count)
+                               ? row
+                               : zoomed_row_count - (fft_row_count - row);
+        std::memcpy(zoomed_fft + zoomed_row * fft_zoomed_col_count,
+                    image_fft + row * fft_col_count,
+                    fft_col_count * sizeof(fftw::BasicComplex<T>));
+    }
+}
 
-    int pixel_index = 0;
-    int zoomed_row = 0;
-    int zoomed_col = 0;
-    int zoomed_pixel_index = 0;
+template <typename T>
+BasicImage<T> ZeroPaddingZoomStrategy::PrunedZeroPadIFFT(
+      int zoom, const Size& image_size,
+      const fftw::BasicComplex<T>* image_fft) const {
+    using Complex = fftw::BasicComplex<T>;
+    auto& fftw_instance = fftw::Fftw::Instance();
 
-    auto image_fft_span = utils::MakeSmartPtrArraySpan(image_fft, image.size);
-    auto zoomed_fft_span =
-          utils::MakeSmartPtrArraySpan(zoomed_fft, zoomed_fft_size);
-    for (int row = 0; row < fft_row_count; ++row) {
-        for (int col = 0; col < fft_col_count; ++col) {
-            pixel_index = row * fft_col_count + col;
+    int image_row_count = image_size.row;
+    int half_row_count = std::ceil(image_row_count / 2.0);
+    int bottom_row_count = image_row_count - half_row_count;
+    int fft_col_count = (image_size.col / 2) + 1;
 
-            if (row < half_row_count) {
-                zoomed_row = row;
-            } else {
-                zoomed_row = zoomed_row_count - (fft_row_count - row);
-            }
-            zoomed_col = col;
-            zoomed_pixel_index = zoomed_row * fft_zoomed_col_count + zoomed_col;
-
-            // copy complex number from image_fft to zoomed_fft
-            zoomed_fft_span[zoomed_pixel_index][0] =
-                  image_fft_span[pixel_index][0];
-            zoomed_fft_span[zoomed_pixel_index][1] =
-                  image_fft_span[pixel_index][1];
+    Size zoomed_size(image_row_count * zoom, image_size.col * zoom);
+    int fft_zoomed_col_count = zoomed_size.col / 2 + 1;
+
+    // 1) columns IFFT. Only the fft_col_count first columns of the zoomed FFT
+    //    hold coefficients: top and bottom blocks of image_fft, 0 in between
+    Size columns_size(zoomed_size.row, fft_col_count);
+    auto columns = fftw::CreateComplex<T>(columns_size);
+    std::memcpy(columns.get(), image_fft,
+                half_row_count * fft_col_count * sizeof(Complex));
+    std::memcpy(
+          columns.get() + (zoomed_size.row - bottom_row_count) * fft_col_count,
+          image_fft + half_row_count * fft_col_count,
+          bottom_row_count * fft_col_count * sizeof(Complex));
+
+    auto columns_plan =
+          fftw_instance.GetColumnsInversePlan<T>(columns_size, columns.get());
+    fftw::Traits<T>::ExecuteC2C(columns_plan.get(), columns.get(),
+                                columns.get());
+
+    // 2) rows c2r IFFT by batches of rows. Coefficients beyond fft_col_count
+    //    are 0: they are set once and preserved by the plans
+    int batch_row_count = std::min(kRowBatchSize, zoomed_size.row);
+    auto rows = fftw::CreateComplex<T>({batch_row_count, fft_zoomed_col_count});
+
+    // every cell is written by the row IFFTs
+    BasicImage<T> zoomed_image(
+          zoomed_size, typename BasicImage<T>::Buffer(zoomed_size.CellCount()));
+    for (int row = 0; row < zoomed_size.row; row += batch_row_count) {
+        int row_count = std::min(batch_row_count, zoomed_size.row - row);
+        for (int i = 0; i < row_count; ++i) {
+            std::memcpy(rows.get() + i * fft_zoomed_col_count,
+                        columns.get() + (row + i) * fft_col_count,
+                        fft_col_count * sizeof(Complex));
         }
+
+        T* zoomed_rows = zoomed_image.data.data() + row * zoomed_size.col;
+        auto rows_plan = fftw_instance.GetRowsComplexToRealPlan<T>(
+              {row_count, zoomed_size.col}, rows.get(), zoomed_rows);
+        fftw::Traits<T>::ExecuteC2R(rows_plan.get(), rows.get(), zoomed_rows);
     }
 
-    return zoomed_fft;
+    return zoomed_image;
 }
 
+template Image ZeroPaddingZoomStrategy::Zoom<double>(
+      int zoom, const Image& padded_image, const Filter& filter) const;
+template FloatImage ZeroPaddingZoomStrategy::Zoom<float>(
+      int zoom, const FloatImage& padded_image, const Filter& filter) const;
+
+template std::vector<Image> ZeroPaddingZoomStrategy::ZoomBatch<double>(
+      int zoom, const std::vector<Image>& padded_images,
+      const Filter& filter) const;
+template std::vector<FloatImage> ZeroPaddingZoomStrategy::ZoomBatch<float>(
+      int zoom, const std::vector<FloatImage>& padded_images,
+      const Filter& filter) const;
+
+template Image ZeroPaddingZoomStrategy::ZoomSampled<double>(
+      int zoom, const Image& padded_image, const Filter& filter,
+      const SamplingGrid& grid) const;
+template FloatImage ZeroPaddingZoomStrategy::ZoomSampled<float>(
+      int zoom, const FloatImage& padded_image, const Filter& filter,
+      const SamplingGrid& grid) const;
+
+template Image ZeroPaddingZoomStrategy::ZoomSpectrum<double>(
+      int zoom, const Size& image_size, fftw::ComplexUPtr image_fft,
+      const Filter& filter) const;
+template FloatImage ZeroPaddingZoomStrategy::ZoomSpectrum<float>(
+      int zoom, const Size& image_size, fftw::BasicComplexUPtr<float> image_fft,
+      const Filter& filter) const;
+
+template Image ZeroPaddingZoomStrategy::ZoomSpectrumSampled<double>(
+      int zoom, const Size& image_size, fftw::ComplexUPtr image_fft,
+      const Filter& filter, const SamplingGrid& grid) const;
+template FloatImage ZeroPaddingZoomStrategy::ZoomSpectrumSampled<float>(
+      int zoom, const Size& image_size, fftw::BasicComplexUPtr<float> image_fft,
+      const Filter& filter, const SamplingGrid& grid) const;
+
+template fftw::ComplexUPtr ZeroPaddingZoomStrategy::ZeroPadFFT<double>(
+      int zoom, const Image& image, fftw::ComplexUPtr image_fft) const;
+template fftw::BasicComplexUPtr<float> ZeroPaddingZoomStrategy::ZeroPadFFT<float>(
+      int zoom, const FloatImage& image,
+      fftw::BasicComplexUPtr<float> image_fft) const;
+
 }  // namespace zoom
 }  // namespace sirius
@@ -22,6 +22,8 @@
 #ifndef SIRIUS_ZOOM_ZOOM_STRATEGY_ZERO_PADDING_STRATEGY_H_
 #define SIRIUS_ZOOM_ZOOM_STRATEGY_ZERO_PADDING_STRATEGY_H_
 
+#include <vector>
+
 #include "sirius/filter.h"
 #include "sirius/image.h"
 
@@ -35,11 +37,123 @@ namespace zoom {
  */
 class ZeroPaddingZoomStrategy {
   public:
-    Image Zoom(int zoom, const Image& padded_image, const Filter& filter) const;
+    template <typename T>
+    BasicImage<T> Zoom(int zoom, const BasicImage<T>& padded_image,
+                       const Filter& filter) const;
+
+    /**
+     * \brief Zoom an image from its FFT
+     * \param zoom zoom factor
+     * \param image_size size of the image
+     * \param image_fft FFT of the image
+     * \param filter filter to apply on the zoomed FFT
+     * \return zoomed image, normalized by the image cell count
+     */
+    template <typename T>
+    BasicImage<T> ZoomSpectrum(int zoom, const Size& image_size,
+                               fftw::BasicComplexUPtr<T> image_fft,
+                               const Filter& filter) const;
+
+    /**
+     * \brief Zoom a batch of images of the same size
+     *
+     * FFTs and IFFTs of the batch are computed with single plans and the
+     * filter spectrum is fetched once.
+     *
+     * \param zoom zoom factor
+     * \param padded_images images of the same size
+     * \param filter filter to apply on the zoomed FFTs
+     * \return zoomed images
+     */
+    template <typename T>
+    std::vector<BasicImage<T>> ZoomBatch(
+          int zoom, const std::vector<BasicImage<T>>& padded_images,
+          const Filter& filter) const;
+
+    /**
+     * \brief Zoom an image and only compute a grid of samples of the zoomed
+     *        image
+     *
+     * The zero padded spectrum is evaluated at the sampled rows, then at the
+     * sampled cols, with chirp-z transforms (Bluestein algorithm): the cost
+     * depends on the image size and on the sample count, not on the zoomed
+     * image size. The filter is always applied on the spectrum.
+     *
+     * \param zoom zoom factor
+     * \param padded_image image to zoom
+     * \param filter filter to apply on the zoomed FFT
+     * \param grid samples of the zoomed image to compute
+     * \return samples of the zoomed image, normalized as in Zoom
+     */
+    template <typename T>
+    BasicImage<T> ZoomSampled(int zoom, const BasicImage<T>& padded_image,
+                              const Filter& filter,
+                              const SamplingGrid& grid) const;
+
+    /**
+     * \brief ZoomSampled from the image FFT
+     */
+    template <typename T>
+    BasicImage<T> ZoomSpectrumSampled(int zoom, const Size& image_size,
+                                      fftw::BasicComplexUPtr<T> image_fft,
+                                      const Filter& filter,
+                                      const SamplingGrid& grid) const;
+
+    /**
+     * \brief Whether Zoom and ZoomBatch convolve the zoomed image instead of
+     *        multiplying its FFT by the filter spectrum
+     *
+     * The direct convolution also saves the pruned IFFT columns.
+     *
+     * \param zoom zoom factor
+     * \param zoomed_size size of the zoomed image
+     * \param filter filter to apply on the zoomed image
+     * \return true if the filter spectrum is not used
+     */
+    bool UseDirectFilter(int zoom, const Size& zoomed_size,
+                         const Filter& filter) const;
+
+    /**
+     * \brief Zero pad the image FFT on the zoomed FFT grid
+     * \param zoom zoom factor
+     * \param image source image
+     * \param image_fft FFT of the source image
+     * \return zoomed FFT
+     */
+    template <typename T>
+    fftw::BasicComplexUPtr<T> ZeroPadFFT(
+          int zoom, const BasicImage<T>& image,
+          fftw::BasicComplexUPtr<T> image_fft) const;
 
   private:
-    fftw::ComplexUPtr ZeroPadFFT(int zoom, const Image& image,
-                                 fftw::ComplexUPtr image_fft) const;
+    /**
+     * \brief Copy the image FFT on the zero padded FFT grid
+     * \param zoom zoom factor
+     * \param image_size size of the source image
+     * \param image_fft FFT of the source image
+     * \param zoomed_fft zoomed FFT, initialized to 0
+     */
+    template <typename T>
+    void ZeroPadSpectrum(int zoom, const Size& image_size,
+                         const fftw::BasicComplex<T>* image_fft,
+                         fftw::BasicComplex<T>* zoomed_fft) const;
+
+    /**
+     * \brief Compute the IFFT of the zero padded FFT without building it
+     *
+     * Row-column decomposition of the c2r transform: the column IFFTs are only
+     * computed on the columns holding the image FFT, then the row c2r IFFTs
+     * are computed by batches of rows.
+     *
+     * \param zoom zoom factor
+     * \param image_size size of the image
+     * \param image_fft image FFT
+     * \return zoomed image (not normalized)
+     */
+    template <typename T>
+    BasicImage<T> PrunedZeroPadIFFT(
+          int zoom, const Size& image_size,
+          const fftw::BasicComplex<T>* image_fft) const;
 };
 
 }  // namespace zoom
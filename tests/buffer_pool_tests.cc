@@ -0,0 +1,138 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch/catch.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "sirius/utils/buffer_pool.h"
+
+TEST_CASE("buffer pool - size class", "[sirius]") {
+    using sirius::utils::BufferPool;
+
+    REQUIRE(BufferPool::SizeClass(1) == BufferPool::kMinPooledSize);
+    REQUIRE(BufferPool::SizeClass(BufferPool::kMinPooledSize) ==
+            BufferPool::kMinPooledSize);
+
+    for (std::size_t size : {70000u, 524288u, 524289u, 1000000u, 3000001u}) {
+        auto size_class = BufferPool::SizeClass(size);
+        REQUIRE(size_class >= size);
+        REQUIRE(size_class <= size + size / 8);
+        REQUIRE(BufferPool::SizeClass(size_class) == size_class);
+    }
+}
+
+TEST_CASE("buffer pool - alignment", "[sirius]") {
+    auto& pool = sirius::utils::BufferPool::Instance();
+
+    for (std::size_t size : {1u, 100u, 1000000u}) {
+        void* buffer = pool.Allocate(size);
+        REQUIRE(buffer != nullptr);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(buffer) %
+                      sirius::utils::kBufferAlignment ==
+                0);
+        pool.Release(buffer);
+    }
+    pool.Release(nullptr);
+}
+
+#ifdef SIRIUS_ENABLE_CACHE_OPTIMIZATION
+
+TEST_CASE("buffer pool - reuse", "[sirius]") {
+    auto& pool = sirius::utils::BufferPool::Instance();
+    constexpr std::size_t kSize = 1024 * 1024;
+
+    void* buffer = pool.Allocate(kSize);
+    REQUIRE(buffer != nullptr);
+    pool.Release(buffer);
+
+    // same size class from the same thread: served by the local free list
+    auto stats = pool.GetStats();
+    void* reused_buffer = pool.Allocate(kSize - 1);
+    REQUIRE(reused_buffer == buffer);
+    REQUIRE(pool.GetStats().hit_count == stats.hit_count + 1);
+    REQUIRE(pool.GetStats().miss_count == stats.miss_count);
+
+    // buffers cached by an exited thread are moved to the global free lists
+    void* released_buffer = nullptr;
+    std::thread thread([&pool, &released_buffer]() {
+        released_buffer = pool.Allocate(3 * kSize);
+        pool.Release(released_buffer);
+    });
+    thread.join();
+    REQUIRE(pool.GetStats().global_cached_bytes >= 3 * kSize);
+    REQUIRE(pool.Allocate(3 * kSize) == released_buffer);
+
+    pool.Release(released_buffer);
+    pool.Release(reused_buffer);
+    pool.Clear();
+    REQUIRE(pool.GetStats().global_cached_bytes == 0);
+}
+
+TEST_CASE("buffer pool - cache budget and trim", "[sirius]") {
+    using sirius::utils::BufferPool;
+    auto& pool = BufferPool::Instance();
+    pool.Trim();
+    constexpr std::size_t kSize = 100 * 1024 * 1024;
+    constexpr int kThreadCount = 8;
+
+    // threads keep their released buffer in their free list until all of
+    // them have released it
+    std::promise<void> exit_promise;
+    auto exit_future = exit_promise.get_future().share();
+    std::atomic<int> released_count{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; ++i) {
+        threads.emplace_back([&pool, &released_count, exit_future]() {
+            pool.Release(pool.Allocate(kSize));
+            ++released_count;
+            exit_future.wait();
+        });
+    }
+    while (released_count < kThreadCount) {
+        std::this_thread::yield();
+    }
+    auto stats = pool.GetStats();
+    REQUIRE(stats.cached_bytes > 0);
+    REQUIRE(stats.cached_bytes <= BufferPool::kMaxCachedSize);
+
+    exit_promise.set_value();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    stats = pool.GetStats();
+    REQUIRE(stats.cached_bytes <= BufferPool::kMaxCachedSize);
+    REQUIRE(stats.global_cached_bytes == stats.cached_bytes);
+
+    // buffers cached by the calling thread are freed too
+    pool.Release(pool.Allocate(kSize));
+    stats = pool.GetStats();
+    REQUIRE(stats.cached_bytes > stats.global_cached_bytes);
+    pool.Trim();
+    REQUIRE(pool.GetStats().cached_bytes == 0);
+}
+
+#endif  // SIRIUS_ENABLE_CACHE_OPTIMIZATION
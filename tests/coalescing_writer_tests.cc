@@ -0,0 +1,218 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch/catch.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <cpl_vsi.h>
+
+#include "sirius/image.h"
+
+#include "sirius/gdal/coalescing_writer.h"
+#include "sirius/gdal/input_stream.h"
+#include "sirius/gdal/output_zoomed_stream.h"
+#include "sirius/gdal/wrapper.h"
+
+namespace {
+
+const std::string kInputPath = "/vsimem/coalescing_writer_tests_input.tif";
+const std::string kOutputPath = "/vsimem/coalescing_writer_tests_output.tif";
+
+constexpr int kBandCount = 3;
+const sirius::Size kInputSize(20, 48);
+const sirius::Size kBlockSize(10, 12);
+
+double PixelValue(int band, int row, int col) {
+    return (band + 1) * 1000 + row * 100 + col;
+}
+
+// block rows may overlap, as on the bottom border of a stream grid
+std::vector<sirius::gdal::StreamBlockDescriptor> CreateBlockGrid(
+      const std::vector<int>& block_rows) {
+    std::vector<sirius::gdal::StreamBlockDescriptor> blocks;
+    for (int row : block_rows) {
+        for (int col = 0; col < kInputSize.col; col += kBlockSize.col) {
+            sirius::gdal::StreamBlockDescriptor block;
+            block.read_row_idx = row;
+            block.read_col_idx = col;
+            block.read_size = {kInputSize.row - row, kBlockSize.col};
+            if (block.read_size.row > kBlockSize.row) {
+                block.read_size.row = kBlockSize.row;
+            }
+            block.row_idx = row;
+            block.col_idx = col;
+            blocks.push_back(block);
+        }
+    }
+    return blocks;
+}
+
+// zoomed block (x2) filled with its values in the output image, margins
+// removed
+sirius::gdal::StreamBlock CreateZoomedBlock(
+      const sirius::gdal::StreamBlockDescriptor& descriptor,
+      const sirius::Size& margin_size) {
+    const auto& padding = descriptor.padding;
+    sirius::Size zoomed_size(
+          (descriptor.read_size.row + padding.top + padding.bottom -
+           2 * margin_size.row) *
+                2,
+          (descriptor.read_size.col + padding.left + padding.right -
+           2 * margin_size.col) *
+                2);
+    std::vector<sirius::Image> bands;
+    for (int band = 0; band < kBandCount; ++band) {
+        sirius::Image image(zoomed_size);
+        for (int row = 0; row < zoomed_size.row; ++row) {
+            for (int col = 0; col < zoomed_size.col; ++col) {
+                image.Set(row, col,
+                          PixelValue(band, descriptor.row_idx * 2 + row,
+                                     descriptor.col_idx * 2 + col));
+            }
+        }
+        bands.push_back(std::move(image));
+    }
+    return sirius::gdal::StreamBlock(std::move(bands), descriptor.row_idx,
+                                     descriptor.col_idx, {});
+}
+
+void WriteBlocks(
+      const std::vector<sirius::gdal::StreamBlockDescriptor>& blocks,
+      std::size_t max_buffered_bytes, bool is_reversed,
+      const sirius::Size& margin_size = {}) {
+    sirius::gdal::OutputZoomedStream output_stream(kInputPath, kOutputPath,
+                                                   {2, 1});
+    sirius::gdal::CoalescingWriter writer(output_stream, blocks,
+                                          max_buffered_bytes);
+    auto write_order = blocks;
+    if (is_reversed) {
+        std::reverse(write_order.begin(), write_order.end());
+    }
+
+    std::error_code ec;
+    for (const auto& descriptor : write_order) {
+        writer.Write(CreateZoomedBlock(descriptor, margin_size), ec);
+        REQUIRE(!ec);
+    }
+    writer.Close(ec);
+    REQUIRE(!ec);
+}
+
+void CheckOutput(const sirius::Size& input_size) {
+    auto output_bands = sirius::gdal::LoadImageBands<double>(kOutputPath);
+    REQUIRE(output_bands.size() == kBandCount);
+    for (int band = 0; band < kBandCount; ++band) {
+        const auto& output_band = output_bands[band];
+        REQUIRE(output_band.size ==
+                sirius::Size(input_size.row * 2, input_size.col * 2));
+        for (int row = 0; row < output_band.size.row; ++row) {
+            for (int col = 0; col < output_band.size.col; ++col) {
+                REQUIRE(output_band.Get(row, col) ==
+                        PixelValue(band, row, col));
+            }
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE("coalescing writer - memory budget", "[sirius]") {
+    std::vector<sirius::Image> input_bands;
+    for (int band = 0; band < kBandCount; ++band) {
+        input_bands.emplace_back(kInputSize);
+    }
+    sirius::gdal::SaveImageBands(input_bands, kInputPath);
+
+    // regular grid and grid with overlapping strips
+    auto block_grids = {CreateBlockGrid({0, 10}), CreateBlockGrid({0, 8, 14})};
+    // full strips, strips split in chunks which do not match the block
+    // columns, no budget
+    auto budgets = {sirius::gdal::CoalescingWriter::kDefaultMaxBufferedBytes,
+                    std::size_t{10000}, std::size_t{3000}, std::size_t{0}};
+    for (const auto& blocks : block_grids) {
+        for (std::size_t max_buffered_bytes : budgets) {
+            for (bool is_reversed : {false, true}) {
+                WriteBlocks(blocks, max_buffered_bytes, is_reversed);
+                CheckOutput(kInputSize);
+            }
+        }
+    }
+
+    ::VSIUnlink(kInputPath.c_str());
+    ::VSIUnlink(kOutputPath.c_str());
+}
+
+TEST_CASE("coalescing writer - input stream grid", "[sirius]") {
+    // border blocks of the grid overlap the previous blocks in both
+    // directions
+    const sirius::Size input_size(70, 93);
+    const sirius::Size block_size(30, 30);
+    const sirius::Size margin_size(5, 5);
+    std::vector<sirius::Image> input_bands;
+    for (int band = 0; band < kBandCount; ++band) {
+        input_bands.emplace_back(input_size);
+    }
+    sirius::gdal::SaveImageBands(input_bands, kInputPath);
+
+    sirius::gdal::InputStream input_stream(kInputPath, block_size, margin_size,
+                                           sirius::PaddingType::kMirrorPadding);
+    const auto& blocks = input_stream.blocks();
+    for (std::size_t max_buffered_bytes :
+         {sirius::gdal::CoalescingWriter::kDefaultMaxBufferedBytes,
+          std::size_t{20000}, std::size_t{0}}) {
+        for (bool is_reversed : {false, true}) {
+            WriteBlocks(blocks, max_buffered_bytes, is_reversed, margin_size);
+            CheckOutput(input_size);
+        }
+    }
+
+    ::VSIUnlink(kInputPath.c_str());
+    ::VSIUnlink(kOutputPath.c_str());
+}
+
+TEST_CASE("coalescing writer - incomplete strips", "[sirius]") {
+    std::vector<sirius::Image> input_bands;
+    for (int band = 0; band < kBandCount; ++band) {
+        input_bands.emplace_back(kInputSize);
+    }
+    sirius::gdal::SaveImageBands(input_bands, kInputPath);
+
+    auto blocks = CreateBlockGrid({0, 10});
+    {
+        sirius::gdal::OutputZoomedStream output_stream(kInputPath,
+                                                       kOutputPath, {2, 1});
+        sirius::gdal::CoalescingWriter writer(output_stream, blocks);
+        std::error_code ec;
+        // last block is missing
+        for (std::size_t i = 0; i + 1 < blocks.size(); ++i) {
+            writer.Write(CreateZoomedBlock(blocks[i], {}), ec);
+            REQUIRE(!ec);
+        }
+        writer.Close(ec);
+        REQUIRE(ec);
+    }
+
+    ::VSIUnlink(kInputPath.c_str());
+    ::VSIUnlink(kOutputPath.c_str());
+}
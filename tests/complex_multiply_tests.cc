@@ -0,0 +1,130 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch/catch.hpp>
+
+#include <cmath>
+
+#include <chrono>
+#include <complex>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "sirius/utils/complex_multiply.h"
+#include "sirius/utils/log.h"
+
+namespace {
+
+const sirius::utils::SimdLevel kSimdLevels[] = {
+      sirius::utils::SimdLevel::kScalar, sirius::utils::SimdLevel::kSse2,
+      sirius::utils::SimdLevel::kAvx2, sirius::utils::SimdLevel::kAvx512};
+
+template <typename T>
+std::vector<T> CreateRandomComplexArray(std::size_t count) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<T> distribution(-10, 10);
+    std::vector<T> values(2 * count);
+    for (auto& value : values) {
+        value = distribution(generator);
+    }
+    return values;
+}
+
+template <typename T>
+void CheckMultiplyComplex(double epsilon) {
+    // odd counts exercise the scalar tail of the SIMD kernels
+    for (std::size_t count : {1u, 3u, 8u, 17u, 1001u}) {
+        auto lhs = CreateRandomComplexArray<T>(count);
+        // shift rhs by one complex so that arrays are not equally aligned
+        auto rhs = CreateRandomComplexArray<T>(count + 1);
+        rhs.erase(rhs.begin(), rhs.begin() + 2);
+
+        for (auto level : kSimdLevels) {
+            auto result = lhs;
+            sirius::utils::MultiplyComplex(level, result.data(), rhs.data(),
+                                           count);
+            for (std::size_t i = 0; i < count; ++i) {
+                std::complex<double> a(lhs[2 * i], lhs[2 * i + 1]);
+                std::complex<double> b(rhs[2 * i], rhs[2 * i + 1]);
+                auto expected = a * b;
+                // error is relative to the operand magnitudes (cancellation)
+                double margin = epsilon * std::abs(a) * std::abs(b);
+                REQUIRE(result[2 * i] ==
+                        Approx(expected.real()).margin(margin));
+                REQUIRE(result[2 * i + 1] ==
+                        Approx(expected.imag()).margin(margin));
+            }
+        }
+    }
+}
+
+template <typename T>
+void BenchmarkMultiplyComplex(const char* type_name) {
+    constexpr std::size_t kCount = 1024 * 1024;
+    constexpr int kIterationCount = 50;
+    auto rhs = CreateRandomComplexArray<T>(kCount);
+    for (std::size_t i = 0; i < kCount; ++i) {
+        // unit complex values: lhs magnitude is stable over the iterations
+        T norm = std::hypot(rhs[2 * i], rhs[2 * i + 1]);
+        rhs[2 * i] /= norm;
+        rhs[2 * i + 1] /= norm;
+    }
+
+    for (auto level : kSimdLevels) {
+        if (level > sirius::utils::GetSimdLevel()) {
+            continue;
+        }
+        auto lhs = CreateRandomComplexArray<T>(kCount);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kIterationCount; ++i) {
+            sirius::utils::MultiplyComplex(level, lhs.data(), rhs.data(),
+                                           kCount);
+        }
+        std::chrono::duration<double, std::micro> elapsed =
+              std::chrono::steady_clock::now() - start;
+        std::cout << "complex multiply " << type_name << " "
+                  << sirius::utils::SimdLevelName(level) << ": "
+                  << elapsed.count() / kIterationCount << " us / " << kCount
+                  << " complex" << std::endl;
+    }
+}
+
+}  // namespace
+
+TEST_CASE("complex multiply - double", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+    LOG("tests", info, "simd level: {}",
+        sirius::utils::SimdLevelName(sirius::utils::GetSimdLevel()));
+
+    CheckMultiplyComplex<double>(1e-12);
+}
+
+TEST_CASE("complex multiply - float", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+
+    CheckMultiplyComplex<float>(1e-5);
+}
+
+TEST_CASE("complex multiply - benchmark", "[.benchmark]") {
+    BenchmarkMultiplyComplex<double>("double");
+    BenchmarkMultiplyComplex<float>("float");
+}
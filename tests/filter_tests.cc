@@ -21,12 +21,19 @@
 
 #include <catch/catch.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
 #include "sirius/exception.h"
 #include "sirius/filter.h"
 #include "sirius/types.h"
 
 #include "sirius/fftw/wrapper.h"
 
+#include "sirius/gdal/wrapper.h"
+
 #include "sirius/utils/log.h"
 
 #include "utils.h"
@@ -99,3 +106,229 @@ TEST_CASE("filter - sinc2 filter", "[sirius]") {
         REQUIRE_NOTHROW(filter.Process(size, std::move(complex_array)));
     }
 }
+
+TEST_CASE("filter - prepared spectra", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+    const std::string filter_path = "/vsimem/filter_tests_filter.tif";
+    sirius::Image filter_image({5, 5});
+    for (int i = 0; i < filter_image.size.CellCount(); ++i) {
+        filter_image.data[i] = 1. + (i % 3);
+    }
+    sirius::gdal::SaveImage(filter_image, filter_path);
+
+    sirius::Size prepared_size{24, 20};
+    sirius::Size unprepared_size{16, 12};
+    auto reference_filter = sirius::Filter::Create(filter_path, {2, 1});
+    auto filter = sirius::Filter::Create(filter_path, {2, 1});
+    filter.PrepareSpectra<double>({prepared_size, {2, 2}});
+
+    auto check_process = [&reference_filter,
+                          &filter](const sirius::Size& size) {
+        int fft_count = size.row * (size.col / 2 + 1);
+        auto image_fft = sirius::fftw::CreateComplex(size);
+        auto reference_fft = sirius::fftw::CreateComplex(size);
+        for (int i = 0; i < fft_count; ++i) {
+            image_fft.get()[i][0] = reference_fft.get()[i][0] = i % 7;
+            image_fft.get()[i][1] = reference_fft.get()[i][1] = i % 5;
+        }
+        image_fft = filter.Process(size, std::move(image_fft));
+        reference_fft =
+              reference_filter.Process(size, std::move(reference_fft));
+        std::size_t fft_bytes =
+              fft_count * sizeof(sirius::fftw::BasicComplex<double>);
+        return std::memcmp(image_fft.get(), reference_fft.get(), fft_bytes) ==
+               0;
+    };
+
+    // prepared and on-demand spectra are identical to the cached ones
+    REQUIRE(check_process(prepared_size));
+
+    // concurrent requests of an unprepared size share one spectrum
+    std::vector<int> results(4, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        threads.emplace_back([&check_process, &results, &unprepared_size, i]() {
+            results[i] = check_process(unprepared_size);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int result : results) {
+        REQUIRE(result == 1);
+    }
+
+    // too small sizes are not prepared and still rejected
+    auto small_fft = sirius::fftw::CreateComplex({2, 2});
+    REQUIRE_THROWS_AS(filter.Process({2, 2}, std::move(small_fft)),
+                      sirius::SiriusException);
+}
+
+TEST_CASE("filter - spectrum rows", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+    const std::string filter_path = "/vsimem/filter_tests_rows.tif";
+    sirius::Image filter_image({5, 5});
+    for (int i = 0; i < filter_image.size.CellCount(); ++i) {
+        filter_image.data[i] = 1. + (i % 3);
+    }
+    sirius::gdal::SaveImage(filter_image, filter_path);
+    auto filter = sirius::Filter::Create(filter_path, {2, 1});
+    REQUIRE(!filter.IsSeparable());
+
+    // compact spectrum of the first and last rows and the first columns
+    sirius::Size size{24, 20};
+    int fft_col_count = size.col / 2 + 1;
+    std::vector<int> rows = {21, 22, 23, 0, 1, 2};
+    int col_count = 5;
+    int fft_count = size.row * fft_col_count;
+    auto full_fft = sirius::fftw::CreateComplex(size);
+    for (int i = 0; i < fft_count; ++i) {
+        full_fft.get()[i][0] = i % 7;
+        full_fft.get()[i][1] = i % 5 - 2.;
+    }
+    auto compact_fft = sirius::fftw::CreateComplex(
+          {static_cast<int>(rows.size()), 2 * (col_count - 1)});
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        std::memcpy(compact_fft.get() + i * col_count,
+                    full_fft.get() + rows[i] * fft_col_count,
+                    col_count * sizeof(sirius::fftw::BasicComplex<double>));
+    }
+
+    full_fft = filter.Process(size, std::move(full_fft));
+    // twice to use the cached spectrum rows
+    for (int pass = 0; pass < 2; ++pass) {
+        auto filtered_fft = sirius::fftw::CreateComplex(
+              {static_cast<int>(rows.size()), 2 * (col_count - 1)});
+        std::memcpy(filtered_fft.get(), compact_fft.get(),
+                    rows.size() * col_count *
+                          sizeof(sirius::fftw::BasicComplex<double>));
+        filter.ProcessRows<double>(size, rows, col_count, filtered_fft.get());
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            for (int col = 0; col < col_count; ++col) {
+                const auto& cell = filtered_fft.get()[i * col_count + col];
+                const auto& reference =
+                      full_fft.get()[rows[i] * fft_col_count + col];
+                REQUIRE(cell[0] == Approx(reference[0]).margin(1e-9));
+                REQUIRE(cell[1] == Approx(reference[1]).margin(1e-9));
+            }
+        }
+    }
+}
+
+TEST_CASE("filter - separable filter", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+    const std::string filter_path = "/vsimem/filter_tests_separable.tif";
+    std::vector<double> column_values = {1., 3., 4., 2., 1.};
+    std::vector<double> row_values = {0.5, 1., 2., 1., 0.5, 0.25, 0.1};
+    sirius::Image filter_image({5, 7});
+    for (int row = 0; row < filter_image.size.row; ++row) {
+        for (int col = 0; col < filter_image.size.col; ++col) {
+            filter_image.data[row * filter_image.size.col + col] =
+                  column_values[row] * row_values[col];
+        }
+    }
+    sirius::gdal::SaveImage(filter_image, filter_path);
+
+    auto separable_filter = sirius::Filter::Create(filter_path, {2, 1});
+    REQUIRE(separable_filter.IsSeparable());
+    auto full_filter = sirius::Filter::Create(
+          filter_path, {2, 1}, sirius::PaddingType::kMirrorPadding, false, -1);
+    REQUIRE(!full_filter.IsSeparable());
+
+    // both filters give the same spectrum product, up to the float32
+    // rounding of the filter image
+    sirius::Size size{24, 30};
+    int fft_count = size.row * (size.col / 2 + 1);
+    auto separable_fft = sirius::fftw::CreateComplex(size);
+    auto full_fft = sirius::fftw::CreateComplex(size);
+    for (int i = 0; i < fft_count; ++i) {
+        separable_fft.get()[i][0] = full_fft.get()[i][0] = i % 7;
+        separable_fft.get()[i][1] = full_fft.get()[i][1] = i % 5 - 2.;
+    }
+    separable_fft = separable_filter.Process(size, std::move(separable_fft));
+    full_fft = full_filter.Process(size, std::move(full_fft));
+    for (int i = 0; i < fft_count; ++i) {
+        REQUIRE(separable_fft.get()[i][0] ==
+                Approx(full_fft.get()[i][0]).margin(1e-6));
+        REQUIRE(separable_fft.get()[i][1] ==
+                Approx(full_fft.get()[i][1]).margin(1e-6));
+    }
+
+    // not separable filter
+    filter_image.data[3] += 1.;
+    sirius::gdal::SaveImage(filter_image, filter_path);
+    REQUIRE(!sirius::Filter::Create(filter_path, {2, 1}).IsSeparable());
+}
+
+TEST_CASE("filter - direct convolution", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+    const std::string filter_path = "/vsimem/filter_tests_direct.tif";
+    sirius::Size size{20, 24};
+    sirius::Image image(size);
+    for (int i = 0; i < size.CellCount(); ++i) {
+        image.data[i] = (i * 37) % 11 - 5.;
+    }
+
+    // odd, even and separable filters
+    std::vector<sirius::Image> filter_images;
+    filter_images.emplace_back(sirius::Size{5, 5});
+    filter_images.emplace_back(sirius::Size{4, 6});
+    filter_images.emplace_back(sirius::Size{5, 7});
+    for (int i = 0; i < 25; ++i) {
+        filter_images[0].data[i] = 1. + (i % 3);
+    }
+    for (int i = 0; i < 24; ++i) {
+        filter_images[1].data[i] = 1. + (i % 5);
+    }
+    for (int row = 0; row < 5; ++row) {
+        for (int col = 0; col < 7; ++col) {
+            filter_images[2].data[row * 7 + col] = (row + 1) * (7 - col);
+        }
+    }
+
+    for (const auto& filter_image : filter_images) {
+        sirius::gdal::SaveImage(filter_image, filter_path);
+        auto spectral_filter = sirius::Filter::Create(
+              filter_path, {1, 1}, sirius::PaddingType::kMirrorPadding, false,
+              -1, sirius::FilterEngine::kSpectral);
+        auto direct_filter = sirius::Filter::Create(
+              filter_path, {1, 1}, sirius::PaddingType::kMirrorPadding, false,
+              sirius::Filter::kSeparableTolerance,
+              sirius::FilterEngine::kDirect);
+        REQUIRE(!spectral_filter.UseDirectConvolution(size));
+        REQUIRE(direct_filter.UseDirectConvolution(size));
+
+        // circular convolution is the spectral product
+        auto image_fft = sirius::fftw::FFT(image);
+        image_fft = spectral_filter.Process(size, std::move(image_fft));
+        auto spectral_image = sirius::fftw::IFFT(size, std::move(image_fft));
+        auto direct_image = image;
+        direct_filter.Convolve(direct_image);
+        for (int i = 0; i < size.CellCount(); ++i) {
+            REQUIRE(direct_image.data[i] ==
+                    Approx(spectral_image.data[i] / size.CellCount())
+                          .margin(1e-6));
+        }
+    }
+
+    // auto engine: direct convolution only pays off when it saves IFFT work
+    sirius::Image separable_filter_image({3, 3});
+    std::fill(separable_filter_image.data.begin(),
+              separable_filter_image.data.end(), 1.);
+    sirius::gdal::SaveImage(separable_filter_image, filter_path);
+    auto auto_filter = sirius::Filter::Create(
+          filter_path, {1, 1}, sirius::PaddingType::kMirrorPadding, false,
+          sirius::Filter::kSeparableTolerance, sirius::FilterEngine::kAuto);
+    REQUIRE(auto_filter.IsSeparable());
+    // zero padding zoom by 2: half of the column IFFTs are pruned
+    REQUIRE(auto_filter.UseDirectConvolution({512, 512}, 2));
+    REQUIRE(!auto_filter.UseDirectConvolution({8, 8}, 2));
+    // same IFFT on both paths
+    REQUIRE(!auto_filter.UseDirectConvolution({512, 512}));
+
+    sirius::gdal::SaveImage(filter_images[0], filter_path);
+    auto large_auto_filter = sirius::Filter::Create(
+          filter_path, {1, 1}, sirius::PaddingType::kMirrorPadding, false,
+          sirius::Filter::kSeparableTolerance, sirius::FilterEngine::kAuto);
+    REQUIRE(!large_auto_filter.UseDirectConvolution({512, 512}, 2));
+}
@@ -19,8 +19,11 @@
  * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <catch/catch.hpp>
 
@@ -29,11 +32,19 @@
 
 #include "sirius/frequency_zoom_factory.h"
 
+#include "sirius/fftw/fftw.h"
+#include "sirius/fftw/wrapper.h"
+
 #include "sirius/gdal/exception.h"
 #include "sirius/gdal/wrapper.h"
 
 #include "sirius/utils/log.h"
 
+#include "sirius/zoom/image_decomposition/periodic_smooth_policy.h"
+#include "sirius/zoom/zoom_strategy/periodization_strategy.h"
+#include "sirius/zoom/zoom_strategy/zero_padding_strategy.h"
+
+#include "periodization_reference.h"
 #include "utils.h"
 
 TEST_CASE("frequency zoom - factory", "[sirius]") {
@@ -525,3 +536,415 @@ TEST_CASE("frequency zoom - example", "[sirius]") {
     sirius::Image zoomed_image_2_1 = freq_zoom->Compute(
           zoom_ratio_2_1, image, sinc_filter.padding(), sinc_filter);
 }
+
+TEST_CASE("frequency zoom - single precision", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+
+    sirius::ZoomRatio zoom_ratio(2, 1);
+
+    auto image = sirius::tests::CreateDummyImage({20, 20});
+    sirius::FloatImage float_image(image.size);
+    std::copy(image.data.begin(), image.data.end(), float_image.data.begin());
+
+    auto policies = {sirius::ImageDecompositionPolicies::kRegular,
+                     sirius::ImageDecompositionPolicies::kPeriodicSmooth};
+    auto strategies = {sirius::FrequencyZoomStrategies::kZeroPadding,
+                       sirius::FrequencyZoomStrategies::kPeriodization};
+    for (auto policy : policies) {
+        for (auto strategy : strategies) {
+            auto freq_zoom =
+                  sirius::FrequencyZoomFactory::Create(policy, strategy);
+
+            auto output = freq_zoom->Compute(zoom_ratio, image, {});
+            sirius::FloatImage float_output;
+            REQUIRE_NOTHROW(float_output = freq_zoom->Compute(
+                                  zoom_ratio, float_image, {}));
+            REQUIRE(float_output.size == output.size);
+
+            for (int i = 0; i < output.CellCount(); ++i) {
+                REQUIRE(float_output.data[i] ==
+                        Approx(output.data[i]).epsilon(1e-3).margin(1e-2));
+            }
+        }
+    }
+}
+
+TEST_CASE("frequency zoom - pruned zero padding IFFT", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+
+    sirius::zoom::ZeroPaddingZoomStrategy strategy;
+    sirius::Filter no_filter;
+
+    for (auto size : {sirius::Size(10, 12), sirius::Size(14, 8)}) {
+        auto image = sirius::tests::CreateDummyImage(size);
+        for (int zoom : {2, 3, 4}) {
+            // reference: IFFT of the materialized zero padded FFT
+            auto image_fft = sirius::fftw::FFT(image);
+            sirius::Size zoomed_size = size * zoom;
+            int fft_col_count = size.col / 2 + 1;
+            int zoomed_fft_col_count = zoomed_size.col / 2 + 1;
+            int half_row_count = (size.row + 1) / 2;
+            auto zoomed_fft = sirius::fftw::CreateComplex(
+                  {zoomed_size.row, zoomed_fft_col_count});
+            for (int row = 0; row < size.row; ++row) {
+                int zoomed_row = row < half_row_count
+                                       ? row
+                                       : zoomed_size.row - (size.row - row);
+                for (int col = 0; col < fft_col_count; ++col) {
+                    auto& dst =
+                          zoomed_fft[zoomed_row * zoomed_fft_col_count + col];
+                    const auto& src = image_fft[row * fft_col_count + col];
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                }
+            }
+            auto expected =
+                  sirius::fftw::IFFT(zoomed_size, std::move(zoomed_fft));
+
+            auto output = strategy.Zoom(zoom, image, no_filter);
+            REQUIRE(output.size == zoomed_size);
+            for (int i = 0; i < output.CellCount(); ++i) {
+                REQUIRE(output.data[i] ==
+                        Approx(expected.data[i] / image.CellCount())
+                              .margin(1e-9));
+            }
+        }
+    }
+}
+
+TEST_CASE("frequency zoom - batch", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+
+    auto dummy_image = sirius::tests::CreateDummyImage({20, 18});
+    std::vector<sirius::Image> images;
+    for (int i = 1; i <= 3; ++i) {
+        sirius::Image image(dummy_image.size);
+        std::transform(dummy_image.data.begin(), dummy_image.data.end(),
+                       image.data.begin(),
+                       [i](double pixel) { return i * pixel + i; });
+        images.push_back(std::move(image));
+    }
+    // different size: zoomed without batching
+    std::vector<sirius::Image> mixed_images = images;
+    mixed_images.push_back(sirius::tests::CreateDummyImage({12, 16}));
+
+    auto policies = {sirius::ImageDecompositionPolicies::kRegular,
+                     sirius::ImageDecompositionPolicies::kPeriodicSmooth};
+    auto strategies = {sirius::FrequencyZoomStrategies::kZeroPadding,
+                       sirius::FrequencyZoomStrategies::kPeriodization};
+    for (auto policy : policies) {
+        for (auto strategy : strategies) {
+            auto freq_zoom =
+                  sirius::FrequencyZoomFactory::Create(policy, strategy);
+            for (int zoom : {1, 2, 3}) {
+                sirius::ZoomRatio zoom_ratio(zoom, 1);
+                for (const auto& inputs : {images, mixed_images}) {
+                    std::vector<sirius::Image> outputs;
+                    REQUIRE_NOTHROW(outputs = freq_zoom->Compute(
+                                          zoom_ratio, inputs, {}));
+                    REQUIRE(outputs.size() == inputs.size());
+
+                    for (std::size_t i = 0; i < inputs.size(); ++i) {
+                        auto expected =
+                              freq_zoom->Compute(zoom_ratio, inputs[i], {});
+                        REQUIRE(outputs[i].size == expected.size);
+                        for (int j = 0; j < expected.CellCount(); ++j) {
+                            REQUIRE(outputs[i].data[j] ==
+                                    Approx(expected.data[j]).margin(1e-9));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("frequency zoom - direct filter", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+    const std::string filter_path = "/vsimem/frequency_zoom_tests_filter.tif";
+    sirius::Image filter_image({5, 5});
+    for (int i = 0; i < filter_image.CellCount(); ++i) {
+        filter_image.data[i] = (1. + (i % 3)) / 50.;
+    }
+    sirius::gdal::SaveImage(filter_image, filter_path);
+
+    sirius::ZoomRatio zoom_ratio(2, 1);
+    auto spectral_filter = sirius::Filter::Create(
+          filter_path, zoom_ratio, sirius::PaddingType::kMirrorPadding, false,
+          sirius::Filter::kSeparableTolerance,
+          sirius::FilterEngine::kSpectral);
+    auto direct_filter = sirius::Filter::Create(
+          filter_path, zoom_ratio, sirius::PaddingType::kMirrorPadding, false,
+          sirius::Filter::kSeparableTolerance, sirius::FilterEngine::kDirect);
+
+    std::vector<sirius::Image> images = {
+          sirius::tests::CreateDummyImage({20, 18}),
+          sirius::tests::CreateDummyImage({20, 18})};
+    auto policies = {sirius::ImageDecompositionPolicies::kRegular,
+                     sirius::ImageDecompositionPolicies::kPeriodicSmooth};
+    auto strategies = {sirius::FrequencyZoomStrategies::kZeroPadding,
+                       sirius::FrequencyZoomStrategies::kPeriodization};
+    for (auto policy : policies) {
+        for (auto strategy : strategies) {
+            auto freq_zoom =
+                  sirius::FrequencyZoomFactory::Create(policy, strategy);
+            auto expected = freq_zoom->Compute(zoom_ratio, images[0],
+                                               spectral_filter.padding(),
+                                               spectral_filter);
+            auto output = freq_zoom->Compute(zoom_ratio, images[0],
+                                             direct_filter.padding(),
+                                             direct_filter);
+            auto batch_outputs = freq_zoom->Compute(
+                  zoom_ratio, images, direct_filter.padding(), direct_filter);
+            REQUIRE(output.size == expected.size);
+            for (int j = 0; j < expected.CellCount(); ++j) {
+                REQUIRE(output.data[j] ==
+                        Approx(expected.data[j]).margin(1e-6));
+                REQUIRE(batch_outputs[1].data[j] ==
+                        Approx(expected.data[j]).margin(1e-6));
+            }
+        }
+    }
+}
+
+TEST_CASE("frequency zoom - sampled real zoom", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+    const std::string filter_path = "/vsimem/frequency_zoom_tests_filter.tif";
+    sirius::Image filter_image({5, 5});
+    for (int i = 0; i < filter_image.CellCount(); ++i) {
+        filter_image.data[i] = (1. + (i % 3)) / 50.;
+    }
+    sirius::gdal::SaveImage(filter_image, filter_path);
+
+    auto image = sirius::tests::CreateDummyImage({20, 17});
+    std::vector<sirius::Image> images = {image, image};
+    auto policies = {sirius::ImageDecompositionPolicies::kRegular,
+                     sirius::ImageDecompositionPolicies::kPeriodicSmooth};
+    auto strategies = {sirius::FrequencyZoomStrategies::kZeroPadding,
+                       sirius::FrequencyZoomStrategies::kPeriodization};
+    auto engines = {sirius::FilterEngine::kSpectral,
+                    sirius::FilterEngine::kDirect};
+    auto zoom_ratios = {sirius::ZoomRatio(3, 2), sirius::ZoomRatio(7, 5),
+                        sirius::ZoomRatio(1, 2), sirius::ZoomRatio(2, 3)};
+    for (const auto& zoom_ratio : zoom_ratios) {
+        // reference: full integer zoom, then decimation
+        sirius::ZoomRatio integer_ratio(zoom_ratio.input_resolution(), 1);
+        int step = zoom_ratio.output_resolution();
+        std::vector<sirius::Filter> filters;
+        filters.emplace_back();
+        for (auto engine : engines) {
+            filters.push_back(sirius::Filter::Create(
+                  filter_path, zoom_ratio, sirius::PaddingType::kMirrorPadding,
+                  false, sirius::Filter::kSeparableTolerance, engine));
+        }
+        for (auto policy : policies) {
+            for (auto strategy : strategies) {
+                auto freq_zoom =
+                      sirius::FrequencyZoomFactory::Create(policy, strategy);
+                for (const auto& filter : filters) {
+                    auto zoomed = freq_zoom->Compute(
+                          integer_ratio, image, filter.padding(), filter);
+                    auto output = freq_zoom->Compute(zoom_ratio, image,
+                                                     filter.padding(), filter);
+                    auto batch_outputs = freq_zoom->Compute(
+                          zoom_ratio, images, filter.padding(), filter);
+                    REQUIRE(output.size.row ==
+                            (zoomed.size.row + step - 1) / step);
+                    REQUIRE(output.size.col ==
+                            (zoomed.size.col + step - 1) / step);
+                    for (int row = 0; row < output.size.row; ++row) {
+                        for (int col = 0; col < output.size.col; ++col) {
+                            double expected =
+                                  zoomed.Get(row * step, col * step);
+                            REQUIRE(output.Get(row, col) ==
+                                    Approx(expected).margin(1e-6));
+                            REQUIRE(batch_outputs[1].Get(row, col) ==
+                                    Approx(expected).margin(1e-6));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("frequency zoom - periodic plus smooth decomposition", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+    auto image = sirius::tests::CreateDummyImage({24, 18});
+    const auto& size = image.size;
+    int zoom = 2;
+
+    // reference: smooth part from the 2D FFT of the intensity changes image
+    sirius::Image border_intensity_changes(size);
+    for (int j = 0; j < size.col; ++j) {
+        double change = image.Get(size.row - 1, j) - image.Get(0, j);
+        border_intensity_changes.data[j] += change;
+        border_intensity_changes.data[(size.row - 1) * size.col + j] -= change;
+    }
+    for (int i = 0; i < size.row; ++i) {
+        double change = image.Get(i, size.col - 1) - image.Get(i, 0);
+        border_intensity_changes.data[i * size.col] += change;
+        border_intensity_changes.data[(i + 1) * size.col - 1] -= change;
+    }
+    sirius::Size fft_size(size.row, size.col / 2 + 1);
+    auto smooth_part_fft = sirius::fftw::FFT(border_intensity_changes);
+    for (int i = 0; i < fft_size.row; ++i) {
+        for (int j = 0; j < fft_size.col; ++j) {
+            double denominator = 2 * std::cos(2 * M_PI * j / size.col) +
+                                 2 * std::cos(2 * M_PI * i / size.row) - 4;
+            auto& cell = smooth_part_fft.get()[i * fft_size.col + j];
+            cell[0] = (i == 0 && j == 0) ? 0 : cell[0] / denominator;
+            cell[1] = (i == 0 && j == 0) ? 0 : cell[1] / denominator;
+        }
+    }
+    auto smooth_part = sirius::fftw::IFFT(size, std::move(smooth_part_fft));
+    sirius::Image periodic_part(size);
+    for (int i = 0; i < size.CellCount(); ++i) {
+        smooth_part.data[i] /= size.CellCount();
+        periodic_part.data[i] = image.data[i] - smooth_part.data[i];
+    }
+
+    sirius::zoom::ZeroPaddingZoomStrategy zero_padding;
+    sirius::zoom::ImageDecompositionPeriodicSmoothPolicy<
+          sirius::zoom::ZeroPaddingZoomStrategy>
+          periodic_smooth;
+    auto zoomed_periodic_part = zero_padding.Zoom(zoom, periodic_part, {});
+    auto interpolated_smooth_part =
+          periodic_smooth.Interpolate2D(zoom, smooth_part);
+
+    auto freq_zoom = sirius::FrequencyZoomFactory::Create(
+          sirius::ImageDecompositionPolicies::kPeriodicSmooth,
+          sirius::FrequencyZoomStrategies::kZeroPadding);
+    auto output = freq_zoom->Compute({zoom, 1}, image, {});
+    REQUIRE(output.size == size * zoom);
+    for (int i = 0; i < output.CellCount(); ++i) {
+        REQUIRE(output.data[i] ==
+                Approx(zoomed_periodic_part.data[i] +
+                       interpolated_smooth_part.data[i])
+                      .margin(1e-9));
+    }
+}
+
+TEST_CASE("frequency zoom - smooth part interpolation", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+    auto image = sirius::tests::CreateDummyImage({6, 8});
+    sirius::zoom::ImageDecompositionPeriodicSmoothPolicy<
+          sirius::zoom::ZeroPaddingZoomStrategy>
+          periodic_smooth;
+
+    for (int zoom = 1; zoom <= 4; ++zoom) {
+        auto interpolated_image = periodic_smooth.Interpolate2D(zoom, image);
+        REQUIRE(interpolated_image.size == image.size * zoom);
+        for (int i = 0; i < interpolated_image.size.row; ++i) {
+            for (int j = 0; j < interpolated_image.size.col; ++j) {
+                // bilinear interpolation, last row and col are duplicated
+                double fx = (i % zoom) / static_cast<double>(zoom);
+                double fy = (j % zoom) / static_cast<double>(zoom);
+                int top = i / zoom;
+                int left = j / zoom;
+                int bottom = std::min(top + 1, image.size.row - 1);
+                int right = std::min(left + 1, image.size.col - 1);
+                double expected = (1 - fx) * (1 - fy) * image.Get(top, left) +
+                                  fx * (1 - fy) * image.Get(bottom, left) +
+                                  (1 - fx) * fy * image.Get(top, right) +
+                                  fx * fy * image.Get(bottom, right);
+                REQUIRE(interpolated_image.Get(i, j) ==
+                        Approx(expected).margin(1e-12));
+            }
+        }
+    }
+}
+
+TEST_CASE("frequency zoom - periodization kernel", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+    sirius::zoom::PeriodizationZoomStrategy periodization;
+    std::vector<sirius::Size> sizes = {{2, 2}, {6, 8}, {10, 4}};
+    for (const auto& size : sizes) {
+        auto image = sirius::tests::CreateDummyImage(size);
+        for (int zoom = 2; zoom <= 8; ++zoom) {
+            auto image_fft = sirius::fftw::FFT(image);
+            auto expected_fft =
+                  sirius::tests::ScatterPeriodizeFFT<double>(
+                        zoom, size, image_fft.get());
+            auto zoomed_fft =
+                  periodization.PeriodizeFFT(zoom, image, std::move(image_fft));
+
+            int zoomed_fft_count =
+                  size.row * zoom * ((size.col * zoom) / 2 + 1);
+            for (int i = 0; i < zoomed_fft_count; ++i) {
+                REQUIRE(zoomed_fft.get()[i][0] == expected_fft.get()[i][0]);
+                REQUIRE(zoomed_fft.get()[i][1] == expected_fft.get()[i][1]);
+            }
+        }
+    }
+}
+
+TEST_CASE("frequency zoom - plan registry bound", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+    auto& fftw_instance = sirius::fftw::Fftw::Instance();
+    fftw_instance.ReleasePlans();
+    REQUIRE(fftw_instance.registered_plan_count() == 0);
+
+    // each size registers a r2c and a c2r plan
+    int size_count = sirius::fftw::Fftw::kMaxRegisteredPlans;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int k = 0; k < size_count; ++k) {
+            sirius::Size size(4, 2 + 2 * k);
+            auto image = sirius::tests::CreateDummyImage(size);
+            auto output = sirius::fftw::IFFT(size, sirius::fftw::FFT(image));
+            for (int i = 0; i < image.CellCount(); ++i) {
+                REQUIRE(output.data[i] / image.CellCount() ==
+                        Approx(image.data[i]).margin(1e-9));
+            }
+            REQUIRE(fftw_instance.registered_plan_count() <=
+                    sirius::fftw::Fftw::kMaxRegisteredPlans);
+        }
+    }
+
+    fftw_instance.ReleasePlans();
+    REQUIRE(fftw_instance.registered_plan_count() == 0);
+}
+
+TEST_CASE("frequency zoom - filter spectrum sizes", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+    const std::string filter_path = "/vsimem/frequency_zoom_tests_filter.tif";
+    sirius::Image filter_image({3, 3});
+    std::fill(filter_image.data.begin(), filter_image.data.end(), 1.);
+    sirius::gdal::SaveImage(filter_image, filter_path);
+
+    sirius::ZoomRatio zoom_ratio(2, 1);
+    auto auto_filter = sirius::Filter::Create(
+          filter_path, zoom_ratio, sirius::PaddingType::kMirrorPadding, false,
+          sirius::Filter::kSeparableTolerance, sirius::FilterEngine::kAuto);
+    std::vector<sirius::Size> zoomed_sizes = {{512, 512}, {8, 8}};
+
+    auto zero_padding = sirius::FrequencyZoomFactory::Create(
+          sirius::ImageDecompositionPolicies::kRegular,
+          sirius::FrequencyZoomStrategies::kZeroPadding);
+    auto periodization = sirius::FrequencyZoomFactory::Create(
+          sirius::ImageDecompositionPolicies::kPeriodicSmooth,
+          sirius::FrequencyZoomStrategies::kPeriodization);
+
+    // zero padding zoom: large sizes are convolved to prune the IFFT
+    auto sizes = zero_padding->FilterSpectrumSizes(zoom_ratio, zoomed_sizes,
+                                                   auto_filter);
+    REQUIRE(sizes.size() == 1);
+    REQUIRE(sizes[0] == sirius::Size(8, 8));
+    for (const auto& size : zoomed_sizes) {
+        bool has_spectrum =
+              std::find(sizes.begin(), sizes.end(), size) != sizes.end();
+        REQUIRE(has_spectrum != auto_filter.UseDirectConvolution(size, 2));
+    }
+
+    // periodization zoom: same IFFT on both paths
+    sizes = periodization->FilterSpectrumSizes(zoom_ratio, zoomed_sizes,
+                                               auto_filter);
+    REQUIRE(sizes == zoomed_sizes);
+
+    // real zooms only use the spectrum rows
+    REQUIRE(periodization
+                  ->FilterSpectrumSizes({3, 2}, zoomed_sizes, auto_filter)
+                  .empty());
+    REQUIRE(zero_padding->FilterSpectrumSizes(zoom_ratio, zoomed_sizes, {})
+                  .empty());
+}
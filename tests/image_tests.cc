@@ -19,6 +19,10 @@
  * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <cstdint>
+
+#include <algorithm>
+
 #include <catch/catch.hpp>
 
 #include "sirius/image.h"
@@ -279,6 +283,66 @@ TEST_CASE("Image - Mirror pad image", "[image]") {
     }
 }
 
+TEST_CASE("Image - pad image to even size", "[image]") {
+    LOG_SET_LEVEL(trace);
+
+    for (auto type : {sirius::PaddingType::kZeroPadding,
+                      sirius::PaddingType::kMirrorPadding,
+                      sirius::PaddingType::kNone}) {
+        for (auto input_size :
+             {sirius::Size(5, 5), sirius::Size(4, 7), sirius::Size(6, 6)}) {
+            auto input = sirius::tests::CreateDummyImage(input_size);
+            for (auto padding : {sirius::Padding(0, 0, 0, 0, type),
+                                 sirius::Padding(2, 1, 3, 2, type),
+                                 sirius::Padding(3, 3, 2, 2, type)}) {
+                auto padded = input.CreatePaddedImage(padding);
+                auto output = input.CreatePaddedEvenImage(padding);
+
+                REQUIRE(output.size.row % 2 == 0);
+                REQUIRE(output.size.col % 2 == 0);
+                REQUIRE(output.size.row - padded.size.row ==
+                        padded.size.row % 2);
+                REQUIRE(output.size.col - padded.size.col ==
+                        padded.size.col % 2);
+                for (int row = 0; row < output.size.row; ++row) {
+                    for (int col = 0; col < output.size.col; ++col) {
+                        // extra row and col duplicate the last ones
+                        REQUIRE(output.Get(row, col) ==
+                                padded.Get(std::min(row, padded.size.row - 1),
+                                           std::min(col,
+                                                    padded.size.col - 1)));
+                    }
+                }
+
+                padded.CreateEvenImage();
+                REQUIRE(padded.size == output.size);
+                REQUIRE(padded.data == output.data);
+            }
+        }
+    }
+}
+
+TEST_CASE("Image - aligned buffer", "[image]") {
+    LOG_SET_LEVEL(trace);
+
+    for (int row : {1, 7, 64}) {
+        for (int col : {1, 9, 64}) {
+            sirius::Image image({row, col});
+            REQUIRE(reinterpret_cast<std::uintptr_t>(image.data.data()) %
+                          sirius::utils::kBufferAlignment ==
+                    0);
+            REQUIRE(std::all_of(image.data.begin(), image.data.end(),
+                                [](double value) { return value == 0; }));
+
+            sirius::FloatImage float_image({row, col});
+            REQUIRE(reinterpret_cast<std::uintptr_t>(
+                          float_image.data.data()) %
+                          sirius::utils::kBufferAlignment ==
+                    0);
+        }
+    }
+}
+
 TEST_CASE("Image - load empty path", "[sirius]") {
     LOG_SET_LEVEL(trace);
 
@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch/catch.hpp>
+
+#include <string>
+#include <vector>
+
+#include <cpl_vsi.h>
+
+#include "sirius/filter.h"
+#include "sirius/frequency_zoom_factory.h"
+#include "sirius/image.h"
+#include "sirius/image_streamer.h"
+
+#include "sirius/gdal/wrapper.h"
+
+namespace {
+
+const std::string kInputPath = "/vsimem/multiband_stream_tests_input.tif";
+const std::string kOutputPath = "/vsimem/multiband_stream_tests_output.tif";
+const std::string kBandInputPath =
+      "/vsimem/multiband_stream_tests_band_input.tif";
+const std::string kBandOutputPath =
+      "/vsimem/multiband_stream_tests_band_output.tif";
+
+std::vector<sirius::Image> CreateBands(const sirius::Size& size,
+                                       int band_count) {
+    std::vector<sirius::Image> bands;
+    for (int band = 0; band < band_count; ++band) {
+        sirius::Image image(size);
+        for (int i = 0; i < size.CellCount(); ++i) {
+            image.data[i] = (i * (band + 1)) % 97;
+        }
+        bands.push_back(std::move(image));
+    }
+    return bands;
+}
+
+void Stream(const std::string& input_path, const std::string& output_path,
+            unsigned int worker_count) {
+    auto frequency_zoom = sirius::FrequencyZoomFactory::Create(
+          sirius::ImageDecompositionPolicies::kRegular,
+          sirius::FrequencyZoomStrategies::kZeroPadding);
+    sirius::Filter no_filter;
+    sirius::ImageStreamer streamer(input_path, output_path, {16, 16}, {2, 1},
+                                   no_filter.Metadata(), worker_count);
+    streamer.Stream<double>(*frequency_zoom, no_filter);
+}
+
+}  // namespace
+
+TEST_CASE("image streamer - multi-band image", "[sirius]") {
+    auto bands = CreateBands({40, 36}, 3);
+    sirius::gdal::SaveImageBands(bands, kInputPath);
+
+    for (unsigned int worker_count : {1u, 3u}) {
+        Stream(kInputPath, kOutputPath, worker_count);
+        auto zoomed_bands =
+              sirius::gdal::LoadImageBands<double>(kOutputPath);
+        REQUIRE(zoomed_bands.size() == bands.size());
+
+        // each band is zoomed as if it were a single-band image
+        for (std::size_t band = 0; band < bands.size(); ++band) {
+            sirius::gdal::SaveImage(bands[band], kBandInputPath);
+            Stream(kBandInputPath, kBandOutputPath, worker_count);
+            auto zoomed_band = sirius::gdal::LoadImage(kBandOutputPath);
+            REQUIRE(zoomed_bands[band].size == zoomed_band.size);
+            REQUIRE(zoomed_bands[band].data == zoomed_band.data);
+        }
+    }
+
+    ::VSIUnlink(kInputPath.c_str());
+    ::VSIUnlink(kOutputPath.c_str());
+    ::VSIUnlink(kBandInputPath.c_str());
+    ::VSIUnlink(kBandOutputPath.c_str());
+}
@@ -0,0 +1,157 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIRIUS_TESTS_PERIODIZATION_REFERENCE_H_
+#define SIRIUS_TESTS_PERIODIZATION_REFERENCE_H_
+
+#include "sirius/types.h"
+
+#include "sirius/fftw/types.h"
+#include "sirius/fftw/wrapper.h"
+
+namespace sirius {
+namespace tests {
+
+/**
+ * \brief Scatter periodization of the spectrum, kept as a reference for
+ *        zoom::PeriodizeSpectrum (unit tests and benchmarks)
+ *
+ * Each source coefficient is written to all its destinations in the zeroed
+ * zoomed FFT.
+ *
+ * \param zoom zoom factor
+ * \param image_size size of the image
+ * \param image_fft image spectrum
+ * \return periodized spectrum
+ */
+template <typename T>
+sirius::fftw::BasicComplexUPtr<T> ScatterPeriodizeFFT(
+      int zoom, const sirius::Size& image_size,
+      const sirius::fftw::BasicComplex<T>* image_fft) {
+    auto zoomed_fft_uptr = sirius::fftw::CreateComplex<T>(
+          {image_size.row * zoom, (image_size.col * zoom) / 2 + 1});
+    auto* zoomed_fft = zoomed_fft_uptr.get();
+
+    int image_row_count = image_size.row;
+    int image_col_count = image_size.col;
+
+    int fft_row_count = image_row_count;
+    int fft_col_count = (image_col_count / 2) + 1;
+
+    int zoomed_row_count = image_row_count * zoom;
+    int zoomed_col_count = image_col_count * zoom;
+    int fft_zoomed_row_count = zoomed_row_count;
+    int fft_zoomed_col_count = zoomed_col_count / 2 + 1;
+
+    for (int row = 0; row < fft_row_count; ++row) {
+        int bottom_row = (fft_zoomed_row_count - fft_row_count + row) *
+                         fft_zoomed_col_count;
+        for (int col = 0; col < fft_col_count; ++col) {
+            int fft_idx = row * fft_col_count + col;
+            int top_left_idx = row * fft_zoomed_col_count + col;
+            int bottom_left_idx = bottom_row + col;
+            int top_right_idx =
+                  row * fft_zoomed_col_count + 2 * fft_col_count - col - 2;
+            int bottom_right_idx = bottom_row + 2 * fft_col_count - col - 2;
+
+            int top_bottom_left_idx =
+                  top_left_idx +
+                  2 * (fft_row_count - row - 1) * fft_zoomed_col_count;
+            int top_bottom_right_idx =
+                  top_right_idx +
+                  (2 * (fft_row_count - row) - 1) * fft_zoomed_col_count + 1;
+
+            int bottom_top_left_idx =
+                  (fft_zoomed_row_count - fft_row_count - 1 - row) *
+                        fft_zoomed_col_count +
+                  col;
+            int bottom_top_right_idx =
+                  bottom_top_left_idx + 2 * (fft_col_count - col) - 1;
+
+            T real_val = image_fft[fft_idx][0];
+            T im_val = image_fft[fft_idx][1];
+
+            // copy top left corner
+            zoomed_fft[top_left_idx][0] = real_val;
+            zoomed_fft[top_left_idx][1] = im_val;
+
+            // copy bottom left corner
+            zoomed_fft[bottom_left_idx][0] = real_val;
+            zoomed_fft[bottom_left_idx][1] = im_val;
+
+            if (zoom != 2) {
+                // copy to the top bottom left corner
+                if (row == fft_row_count - 1) {
+                    zoomed_fft[top_bottom_left_idx][0] = real_val;
+                    zoomed_fft[top_bottom_left_idx][1] = im_val;
+                } else {
+                    T tmp_real_val =
+                          image_fft[(row + 1) * fft_col_count + col][0];
+                    T tmp_im_val =
+                          image_fft[(row + 1) * fft_col_count + col][1];
+                    zoomed_fft[top_bottom_left_idx][0] = tmp_real_val;
+                    zoomed_fft[top_bottom_left_idx][1] = tmp_im_val;
+                }
+
+                // copy to the top bottom right corner
+                if (top_bottom_right_idx <
+                    fft_zoomed_col_count * (2 * fft_row_count - 1)) {
+                    zoomed_fft[top_bottom_right_idx][0] = real_val;
+                    zoomed_fft[top_bottom_right_idx][1] = im_val;
+                }
+
+                // copy to the bottom top right corner
+                zoomed_fft[bottom_top_right_idx][0] = real_val;
+                zoomed_fft[bottom_top_right_idx][1] = im_val;
+
+                // copy to the bottom top left corner
+                zoomed_fft[bottom_top_left_idx][0] = real_val;
+                zoomed_fft[bottom_top_left_idx][1] = im_val;
+            }
+
+            if (col == fft_col_count - 1) {
+                // duplicate extreme right pixel of each source spectrum row
+                zoomed_fft[top_right_idx][0] = real_val;
+                zoomed_fft[top_right_idx][1] = im_val;
+
+                zoomed_fft[bottom_right_idx][0] = real_val;
+                zoomed_fft[bottom_right_idx][1] = im_val;
+            } else {
+                T right_real_val = image_fft[fft_idx + 1][0];
+                T right_im_val = image_fft[fft_idx + 1][1];
+                // copy top right corner
+                zoomed_fft[top_right_idx][0] = right_real_val;
+                zoomed_fft[top_right_idx][1] = right_im_val;
+
+                // copy bottom right corner
+                zoomed_fft[bottom_right_idx][0] = right_real_val;
+                zoomed_fft[bottom_right_idx][1] = right_im_val;
+            }
+        }
+    }
+
+    return zoomed_fft_uptr;
+}
+
+}  // namespace tests
+}  // namespace sirius
+
+#endif  // SIRIUS_TESTS_PERIODIZATION_REFERENCE_H_
@@ -0,0 +1,140 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch/catch.hpp>
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include <cpl_vsi.h>
+
+#include "sirius/image.h"
+
+#include "sirius/gdal/input_stream.h"
+#include "sirius/gdal/tile_cache.h"
+#include "sirius/gdal/wrapper.h"
+
+#include "sirius/utils/log.h"
+
+namespace {
+
+const std::string kImagePath = "/vsimem/tile_cache_tests.tif";
+
+void CreateImage(const sirius::Size& size) {
+    sirius::Image image(size);
+    for (int i = 0; i < size.CellCount(); ++i) {
+        image.data[i] = i % 251;
+    }
+    sirius::gdal::SaveImage(image, kImagePath);
+}
+
+}  // namespace
+
+TEST_CASE("tile cache - read blocks through the cache", "[sirius]") {
+    CreateImage({150, 70});
+    sirius::gdal::InputStream input_stream(kImagePath, {16, 16}, {6, 6},
+                                           sirius::PaddingType::kNone);
+    const auto& blocks = input_stream.blocks();
+    auto dataset = input_stream.OpenDataset();
+
+    SECTION("unbounded cache") {
+        sirius::gdal::TileCache tile_cache(input_stream.Size(),
+                                           input_stream.native_block_size(),
+                                           blocks);
+        for (const auto& block : blocks) {
+            std::error_code direct_ec;
+            auto direct_block = input_stream.Read<double>(
+                  block, dataset.get(), nullptr, direct_ec);
+            std::error_code cache_ec;
+            auto cached_block = input_stream.Read<double>(
+                  block, dataset.get(), &tile_cache, cache_ec);
+            REQUIRE(!direct_ec);
+            REQUIRE(!cache_ec);
+            REQUIRE(cached_block.size() == direct_block.size());
+            REQUIRE(cached_block.bands.front().data ==
+                    direct_block.bands.front().data);
+        }
+
+        // each tile is decoded once
+        auto tile_size = tile_cache.tile_size();
+        auto stats = tile_cache.GetStats();
+        int tile_count = ((150 + tile_size.row - 1) / tile_size.row) *
+                         ((70 + tile_size.col - 1) / tile_size.col);
+        REQUIRE(stats.miss_count == static_cast<std::size_t>(tile_count));
+        REQUIRE(stats.hit_count > 0);
+        REQUIRE(stats.saved_bytes > 0);
+        REQUIRE(stats.evicted_count == 0);
+    }
+
+    SECTION("memory budget smaller than a tile") {
+        sirius::gdal::FloatTileCache tile_cache(
+              input_stream.Size(), input_stream.native_block_size(), blocks,
+              1);
+        for (const auto& block : blocks) {
+            std::error_code direct_ec;
+            auto direct_block = input_stream.Read<float>(
+                  block, dataset.get(), nullptr, direct_ec);
+            std::error_code cache_ec;
+            auto cached_block = input_stream.Read<float>(
+                  block, dataset.get(), &tile_cache, cache_ec);
+            REQUIRE(!direct_ec);
+            REQUIRE(!cache_ec);
+            REQUIRE(cached_block.bands.front().data ==
+                    direct_block.bands.front().data);
+        }
+        REQUIRE(tile_cache.GetStats().evicted_count > 0);
+    }
+
+    SECTION("concurrent reads") {
+        sirius::gdal::TileCache tile_cache(input_stream.Size(),
+                                           input_stream.native_block_size(),
+                                           blocks);
+        auto read_blocks = [&input_stream, &blocks,
+                            &tile_cache](std::size_t first_block_idx) {
+            auto worker_dataset = input_stream.OpenDataset();
+            std::vector<sirius::Image> images;
+            for (std::size_t i = first_block_idx; i < blocks.size(); i += 2) {
+                std::error_code ec;
+                auto block = input_stream.Read<double>(
+                      blocks[i], worker_dataset.get(), &tile_cache, ec);
+                images.push_back(std::move(block.bands.front()));
+            }
+            return images;
+        };
+        auto even_task = std::async(std::launch::async, read_blocks, 0);
+        auto odd_task = std::async(std::launch::async, read_blocks, 1);
+        auto even_images = even_task.get();
+        auto odd_images = odd_task.get();
+
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            std::error_code ec;
+            auto direct_block =
+                  input_stream.Read<double>(blocks[i], dataset.get(), nullptr,
+                                            ec);
+            const auto& cached_image =
+                  (i % 2 == 0) ? even_images[i / 2] : odd_images[i / 2];
+            REQUIRE(cached_image.data == direct_block.bands.front().data);
+        }
+    }
+
+    ::VSIUnlink(kImagePath.c_str());
+}
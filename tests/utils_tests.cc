@@ -19,6 +19,8 @@
  * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <cstdlib>
+#include <stdexcept>
 #include <vector>
 
 #include <catch/catch.hpp>
@@ -230,6 +232,29 @@ TEST_CASE("utils test - LRU cache", "[sirius]") {
 
     cache.Clear();
     REQUIRE(cache.Size() == 0);
+
+    int create_count = 0;
+    auto create_element = [&create_count]() {
+        ++create_count;
+        return DummyStruct{6};
+    };
+    REQUIRE(cache.GetOrInsert({6, 6}, create_element).value == 6);
+    REQUIRE(cache.GetOrInsert({6, 6}, create_element).value == 6);
+    REQUIRE(create_count == 1);
+    REQUIRE(cache.Size() == 1);
+
+    // failed creation does not leave its key in the LRU order
+    auto throw_element = []() -> DummyStruct {
+        throw std::runtime_error("creation failed");
+    };
+    REQUIRE_THROWS_AS(cache.GetOrInsert({7, 7}, throw_element),
+                      std::runtime_error);
+    REQUIRE(!cache.Contains({7, 7}));
+    cache.Insert({8, 8}, {8});
+    cache.Insert({9, 9}, {9});
+    cache.Insert({10, 10}, {10});
+    REQUIRE(cache.Size() == 3);
+    REQUIRE(!cache.Contains({6, 6}));
 }
 
 TEST_CASE("utils test - FFTFreq", "[sirius]") {
@@ -247,6 +272,106 @@ TEST_CASE("utils test - FFTFreq", "[sirius]") {
     REQUIRE(freq[3] == 0.375);
 }
 
+TEST_CASE("utils test - GenerateTileAlignedSize", "[sirius]") {
+    using sirius::Size;
+    using sirius::utils::GenerateTileAlignedSize;
+
+    SECTION("tiled image") {
+        Size max_size(4000, 4000);
+        REQUIRE(GenerateTileAlignedSize({256, 256}, {256, 256}, max_size) ==
+                Size(256, 256));
+        REQUIRE(GenerateTileAlignedSize({500, 300}, {256, 128}, max_size) ==
+                Size(512, 256));
+        REQUIRE(GenerateTileAlignedSize({100, 100}, {256, 256}, max_size) ==
+                Size(256, 256));
+    }
+
+    SECTION("size bounded by max size") {
+        REQUIRE(GenerateTileAlignedSize({1024, 1024}, {256, 256},
+                                        {600, 1000}) == Size(512, 768));
+    }
+
+    SECTION("untiled dimensions") {
+        // strips: one row high, as wide as the image
+        REQUIRE(GenerateTileAlignedSize({250, 250}, {1, 4000}, {3000, 3000}) ==
+                Size(250, 250));
+        // strips of 16 rows
+        REQUIRE(GenerateTileAlignedSize({250, 250}, {16, 4000},
+                                        {3000, 3000}) == Size(256, 250));
+    }
+}
+
+TEST_CASE("utils test - GenerateSmoothSize", "[sirius]") {
+    using sirius::Size;
+    using sirius::utils::GenerateSmoothSize;
+    using sirius::utils::IsSmoothSize;
+
+    REQUIRE(IsSmoothSize(1));
+    REQUIRE(IsSmoothSize(2 * 3 * 5 * 7 * 64));
+    REQUIRE(!IsSmoothSize(0));
+    REQUIRE(!IsSmoothSize(356));  // 4 * 89
+    REQUIRE(!IsSmoothSize(11));
+
+    Size max_size(4000, 4000);
+    Size padding_size(50, 50);
+    auto check_smooth = [&padding_size](const Size& size, int res_in) {
+        for (int length : {size.row, size.col}) {
+            REQUIRE(length > 0);
+            REQUIRE(IsSmoothSize(length + 2 * padding_size.row));
+            REQUIRE(IsSmoothSize((length + 2 * padding_size.row) * res_in));
+        }
+    };
+
+    SECTION("tiled image") {
+        // 256 + 2 * 50 = 4 * 89, no close tile multiple is smooth
+        auto size = GenerateSmoothSize({256, 256}, {256, 256}, max_size,
+                                       padding_size, 2);
+        check_smooth(size, 2);
+        REQUIRE(std::abs(size.row - 256) <= 16);
+
+        // e.g. 4 * 128 + 2 * 50 = 612 = 4 * 9 * 17
+        for (int tile_count = 1; tile_count < 20; ++tile_count) {
+            int length = tile_count * 128;
+            auto smooth_size = GenerateSmoothSize(
+                  {length, length}, {128, 128}, max_size, padding_size, 2);
+            check_smooth(smooth_size, 2);
+        }
+
+        // already smooth: 412 + 100 = 512
+        REQUIRE(GenerateSmoothSize({412, 412}, {412, 412}, max_size,
+                                   padding_size, 2) == Size(412, 412));
+    }
+
+    SECTION("tile multiple") {
+        // 4 * 50 + 2 * 50 = 300 is smooth
+        REQUIRE(GenerateSmoothSize({200, 200}, {50, 50}, max_size,
+                                   padding_size, 3) == Size(200, 200));
+        // 7 * 20 + 100 = 240 is smooth, 8 * 20 + 100 = 260 = 4 * 5 * 13 is
+        // not: closest tile multiple
+        auto size = GenerateSmoothSize({160, 160}, {20, 20}, max_size,
+                                       padding_size, 2);
+        check_smooth(size, 2);
+        REQUIRE(size.row % 20 == 0);
+    }
+
+    SECTION("step") {
+        // 255 + 2 * 50 = 5 * 71
+        auto size = GenerateSmoothSize({255, 255}, {1, 1}, max_size,
+                                       padding_size, 3, {3, 3});
+        check_smooth(size, 3);
+        REQUIRE(size.row % 3 == 0);
+        REQUIRE(size.col % 3 == 0);
+    }
+
+    SECTION("max size") {
+        // next smooth padded sizes are too large
+        auto size = GenerateSmoothSize({256, 256}, {256, 256}, {258, 258},
+                                       padding_size, 2);
+        check_smooth(size, 2);
+        REQUIRE(size.row <= 258);
+    }
+}
+
 TEST_CASE("utils test - Meshgrid", "[sirius]") {
     std::vector<int> xx, yy;
     sirius::utils::CreateMeshgrid(0, 3, 0, 3, xx, yy);
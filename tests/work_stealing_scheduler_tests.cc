@@ -0,0 +1,132 @@
+/**
+ * Copyright (C) 2018 CS - Systemes d'Information (CS-SI)
+ *
+ * This file is part of Sirius
+ *
+ *     https://github.com/CS-SI/SIRIUS
+ *
+ * Sirius is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Sirius is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Sirius.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "sirius/utils/log.h"
+#include "sirius/utils/work_stealing_scheduler.h"
+
+TEST_CASE("work stealing scheduler - process all tasks", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+
+    for (unsigned int worker_count : {1u, 2u, 4u, 7u}) {
+        sirius::utils::WorkStealingScheduler<int> scheduler(worker_count);
+        REQUIRE(scheduler.worker_count() == worker_count);
+
+        std::vector<int> tasks(100);
+        for (std::size_t i = 0; i < tasks.size(); ++i) {
+            tasks[i] = i;
+        }
+        std::vector<std::atomic<int>> processed(tasks.size());
+        for (auto& count : processed) {
+            count = 0;
+        }
+
+        // Catch assertions are not thread safe
+        std::atomic<bool> is_worker_index_valid{true};
+        scheduler.Run(tasks, [&processed, &is_worker_index_valid, worker_count](
+                                   unsigned int worker_index, int task) {
+            if (worker_index >= worker_count) {
+                is_worker_index_valid = false;
+            }
+            ++processed[task];
+            return true;
+        });
+
+        REQUIRE(is_worker_index_valid);
+        for (auto& count : processed) {
+            REQUIRE(count == 1);
+        }
+    }
+}
+
+TEST_CASE("work stealing scheduler - steal tasks", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+
+    sirius::utils::WorkStealingScheduler<int> scheduler(2);
+
+    // tasks are dealt round-robin: worker 0 owns {0, 2, 4}, worker 1 owns
+    // {1, 3, 5}. Worker 0 is stuck on task 0 until worker 1 has processed its
+    // own tasks and stolen tasks 4 and 2.
+    std::atomic<bool> is_task_0_started{false};
+    std::atomic<int> processed_by_worker_1{0};
+    auto wait = [](const std::atomic<bool>& flag) {
+        while (!flag) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+    std::atomic<bool> is_released{false};
+    scheduler.Run({0, 1, 2, 3, 4, 5}, [&](unsigned int worker_index, int task) {
+        if (task == 0) {
+            is_task_0_started = true;
+            wait(is_released);
+        } else if (worker_index == 1) {
+            wait(is_task_0_started);
+            if (++processed_by_worker_1 == 5) {
+                is_released = true;
+            }
+        }
+        return true;
+    });
+
+    REQUIRE(processed_by_worker_1 == 5);
+    REQUIRE(scheduler.steal_count() == 2);
+}
+
+TEST_CASE("work stealing scheduler - cancel tasks", "[sirius]") {
+    LOG_SET_LEVEL(trace);
+
+    sirius::utils::WorkStealingScheduler<int> scheduler(1);
+
+    std::vector<int> processed_tasks;
+    scheduler.Run({0, 1, 2, 3}, [&processed_tasks](unsigned int, int task) {
+        processed_tasks.push_back(task);
+        return task != 1;
+    });
+    REQUIRE(processed_tasks == std::vector<int>({0, 1}));
+
+    processed_tasks.clear();
+    REQUIRE_THROWS_AS(
+          scheduler.Run({0, 1, 2, 3},
+                        [&processed_tasks](unsigned int, int task) {
+                            processed_tasks.push_back(task);
+                            if (task == 2) {
+                                throw std::runtime_error("task error");
+                            }
+                            return true;
+                        }),
+          std::runtime_error);
+    REQUIRE(processed_tasks == std::vector<int>({0, 1, 2}));
+
+    // scheduler can be reused after a cancellation
+    processed_tasks.clear();
+    scheduler.Run({4, 5}, [&processed_tasks](unsigned int, int task) {
+        processed_tasks.push_back(task);
+        return true;
+    });
+    REQUIRE(processed_tasks == std::vector<int>({4, 5}));
+}